@@ -0,0 +1,79 @@
+
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+/* Benchmark utilities
+ * -------------------
+ * Helper functions for timing micro-benchmarks
+ */
+
+/* Internal libraries */
+#include "vehicle_model.h"
+#include "quat.h"
+#include "util.h"
+
+/* Built-in libraries */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_REPEAT 10000
+
+/* Report benchmark
+ * :param name: benchmark name
+ * :param count: number of iterations
+ * :param tick: start time (in seconds)
+ * :param tock: stop time (in seconds)
+ */
+#define BENCH_REPORT(name, count, tick, tock) printf(\
+    "%-24s %12.1f ns/op %14.0f op/s\n", name,\
+    1e9 * ((tock) - (tick)) / (count),\
+    (count) / ((tock) - (tick))\
+)
+
+/* Wall clock time
+ * :returns double: time (in seconds)
+ */
+static inline
+double
+bench_now(
+    void
+) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+/* Initialize vehicle model (low Earth orbit)
+ * :param size_t size: number of objects
+ * :param vehicle_model_s* vehicle_model: output vehicle model
+ */
+static inline
+void
+bench_vehicle_model(
+    size_t size,
+    struct vehicle_model_s* vehicle_model
+) {
+    memset(vehicle_model, 0, sizeof(struct vehicle_model_s));
+    vehicle_model->size = size;
+    vehicle_model->cfg.clk.delta_t = 1.0;
+    vehicle_model->st.sys.r_bar[0] = 7000.0e3;
+    vehicle_model->st.sys.v_bar[1] = 7.0e3;
+    quat_one(vehicle_model->st.sys.q);
+    for (size_t idx = 0; idx < size; idx++) {
+        double th = 2.0 * M_PI * idx / size;
+        vehicle_model->cfg.OBJ_LST(idx, bbox)[0] = 1.0;
+        vehicle_model->cfg.OBJ_LST(idx, bbox)[1] = 1.0;
+        vehicle_model->cfg.OBJ_LST(idx, bbox)[2] = 1.0;
+        vehicle_model->cfg.OBJ_LST(idx, r_bar)[0] = cos(th);
+        vehicle_model->cfg.OBJ_LST(idx, r_bar)[1] = sin(th);
+        vehicle_model->cfg.OBJ_LST(idx, q)[0] = cos(0.5 * th);
+        vehicle_model->cfg.OBJ_LST(idx, q)[3] = sin(0.5 * th);
+        vehicle_model->st.OBJ_LST(idx, m) = 1.0;
+        vehicle_model->st.OBJ_LST(idx, I_cm)[0] = 1.0 / 6.0;
+        vehicle_model->st.OBJ_LST(idx, I_cm)[1] = 1.0 / 6.0;
+        vehicle_model->st.OBJ_LST(idx, I_cm)[2] = 1.0 / 6.0;
+    }
+}
+
+#endif  // __BENCH_H__
@@ -0,0 +1,50 @@
+#define _POSIX_C_SOURCE 199309L
+#include <stdlib.h>
+#include "bench.h"
+#include "batch.h"
+#include "vehicle_model.h"
+#include "force_model.h"
+#include "gee.h"
+#include "geopot.h"
+#include "geomag.h"
+
+/* Batch propagation throughput
+ * ----------------------------
+ * Two-body only, and with the Earth-fixed models (`geopot`, `geomag`),
+ * whose Earth rotation is shared between vehicles at the same step time.
+ */
+
+#define BENCH_STEPS 100
+
+static void bench_batch(size_t N, size_t size, bool earth)
+{
+    struct force_model_s force_model = {
+        .size=earth ? 3 : 1,
+        .accum_fun=apply_force_model,
+        .fun_lst={gee_fast, geopot, geomag}
+    };
+    struct vehicle_model_s* vehicle_model = malloc(N * sizeof(struct vehicle_model_s));
+    struct batch_s* batch = malloc(N * sizeof(struct batch_s));
+    for (size_t i = 0; i < N; i++)
+        bench_vehicle_model(size, &vehicle_model[i]);
+    batch_init(N, vehicle_model, batch);
+    double tick = bench_now();
+    for (size_t n = 1; n <= BENCH_STEPS; n++)
+        solve_batch(N, n * 1.0, vehicle_model, batch, ODE_METHOD_NAME(rk4), &force_model);
+    double tock = bench_now();
+    char name[40];
+    snprintf(name, sizeof(name), "solve_batch[N=%zu%s]", N, earth ? ",earth" : "");
+    printf("%-24s %12.0f vehicle-steps/s\n", name, N * BENCH_STEPS / (tock - tick));
+    free(batch);
+    free(vehicle_model);
+}
+
+int main(int argc, char** argv)
+{
+    size_t size = (argc > 1) ? (size_t) atoi(argv[1]) : 1;
+    for (size_t N = 1; N <= 1000; N *= 10)
+        bench_batch(N, MIN(size, MAX_OBJ_COUNT), false);
+    for (size_t N = 1; N <= 1000; N *= 10)
+        bench_batch(N, MIN(size, MAX_OBJ_COUNT), true);
+    return EXIT_SUCCESS;
+}
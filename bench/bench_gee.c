@@ -0,0 +1,211 @@
+#define _POSIX_C_SOURCE 199309L
+#include <stdlib.h>
+#include "bench.h"
+#include "gee.h"
+#include "geopot.h"
+#include "stdatm.h"
+
+/* Environment model evaluation
+ * ----------------------------
+ * The loaded geopotential is timed per truncation degree (full order), to
+ * pick a degree for each mission, against the built-in `geopot_eval`.
+ * Without a coefficient file (first argument), a synthetic model of
+ * `G_NMAX` (Kaula's rule) is written to `BENCH_EGM`; the cost does not
+ * depend on the values.
+ * The geodetic conversion is timed per altitude band against the iterative
+ * routine it replaced, with the largest deviation between the two.
+ * The standard atmosphere table is timed against the model it is built
+ * from, with the largest errors over 0-1000km (10m apart).
+ */
+
+#define BENCH_COUNT (100 * BENCH_REPEAT)
+#define BENCH_SIZE 64
+#define BENCH_EGM "/tmp/bench_gee.gfc"
+
+static vec_t r_lst[BENCH_SIZE], f2d_lst[BENCH_SIZE];
+volatile double sink;
+
+/* Previous (Newton) geodetic conversion, for reference */
+__attribute__((noinline))
+static bool ref_gee_f2d(const vec_t r_bar, double* lat, double* lon, double* alt) {
+    double p__2 = r_bar[0] * r_bar[0] + r_bar[1] * r_bar[1],
+           p = sqrt(p__2),
+           z = r_bar[2],
+           z__2 = z * z,
+           e__2 = (2.0 - 1.0 / G_INVF) / G_INVF,
+           ae__2 = G_RMAX * e__2,
+           inv_k0 = pow(1 - 1.0 / G_INVF, 2.0),
+           k = 1.0 / inv_k0;
+    bool done = false;
+    for (size_t n = 0; n < 50; n++) {
+        double c = pow(p__2 + inv_k0 * z__2 * k * k, 1.5) / ae__2;
+        double delta_k = (c + inv_k0 * z__2 * k * k * k) / (c - p__2) - k;
+        k += delta_k;
+        done = fabs(delta_k) < ABSTOL + RELTOL * fabs(k);
+        if (done)
+            break;
+    }
+    if (lat != NULL) *lat = atan(k * z / p);
+    if (lon != NULL) *lon = atan2(r_bar[1], r_bar[0]);
+    if (alt != NULL) *alt = (1.0 / k - inv_k0) * sqrt(p__2 + z__2 * k * k) / e__2;
+    return done;
+}
+
+static bool bench_egm_file(const char* file_name)
+{
+    FILE* file = fopen(file_name, "w");
+    if (file == NULL)
+        return false;
+    srand(0);
+    for (size_t n = 2; n <= G_NMAX; n++)
+        for (size_t m = 0; m <= n; m++) {
+            double C = 1e-5 / (n * n) * (2.0 * rand() / RAND_MAX - 1.0),
+                   S = 1e-5 / (n * n) * (2.0 * rand() / RAND_MAX - 1.0);
+            fprintf(file, "%zu %zu %.12E %.12E\n", n, m, C, (m > 0) ? S : 0.0);
+        }
+    fclose(file);
+    return true;
+}
+
+/* Time a force evaluation over the input positions
+ * :param name: benchmark name
+ * :param count: number of evaluations
+ * :param fun: evaluation function (`geopot_eval` signature)
+ */
+static void bench_eval(
+    const char* name, size_t count,
+    bool (*fun)(double, const vec_t, vec_t)
+) {
+    vec_t F_bar;
+    double acc = 0.0, tick = bench_now();
+    for (size_t n = 0; n < count; n++) {
+        fun(1.0, r_lst[n % BENCH_SIZE], F_bar);
+        acc += F_bar[0];
+    }
+    double tock = bench_now();
+    sink = acc;
+    BENCH_REPORT(name, count, tick, tock);
+}
+
+/* Time the geodetic conversion over an altitude band
+ * :param alt_min: lowest altitude
+ * :param alt_max: highest altitude
+ */
+static void bench_f2d(double alt_min, double alt_max)
+{
+    char name[48];
+    double alt[BENCH_SIZE], foo, bar, delta = 0.0, acc = 0.0, tick, tock;
+    for (size_t k = 0; k < BENCH_SIZE; k++) {
+        double la = 2.0 * M_PI * k / BENCH_SIZE, ph = 1.5 * sin(3.0 * la),
+               r = G_RMAX + alt_min + (alt_max - alt_min) * k / (BENCH_SIZE - 1);
+        f2d_lst[k][0] = r * cos(ph) * cos(la);
+        f2d_lst[k][1] = r * cos(ph) * sin(la);
+        f2d_lst[k][2] = r * sin(ph);
+        ref_gee_f2d(f2d_lst[k], &foo, NULL, &bar);
+        gee_f2d(f2d_lst[k], &alt[0], NULL, &alt[1]);
+        delta = MAX(delta, MAX(G_RMAX * fabs(alt[0] - foo), fabs(alt[1] - bar)));
+    }
+    printf("f2d[%.0f-%.0fkm] max. deviation %.3e m\n", alt_min / 1e3, alt_max / 1e3, delta);
+    snprintf(name, sizeof(name), "ref_gee_f2d[%.0fkm]", alt_max / 1e3);
+    tick = bench_now();
+    for (size_t n = 0; n < BENCH_COUNT; n++) {
+        ref_gee_f2d(f2d_lst[n % BENCH_SIZE], NULL, NULL, &foo);
+        acc += foo;
+    }
+    tock = bench_now();
+    BENCH_REPORT(name, BENCH_COUNT, tick, tock);
+    snprintf(name, sizeof(name), "gee_f2d[%.0fkm]", alt_max / 1e3);
+    tick = bench_now();
+    for (size_t n = 0; n < BENCH_COUNT; n++) {
+        gee_f2d(f2d_lst[n % BENCH_SIZE], NULL, NULL, &foo);
+        acc += foo;
+    }
+    tock = bench_now();
+    BENCH_REPORT(name, BENCH_COUNT, tick, tock);
+    snprintf(name, sizeof(name), "gee_f2d_n[%.0fkm]", alt_max / 1e3);
+    tick = bench_now();
+    for (size_t n = 0; n < BENCH_COUNT; n += BENCH_SIZE) {
+        gee_f2d_n(BENCH_SIZE, (void*) f2d_lst, NULL, NULL, alt);
+        acc += alt[n % BENCH_SIZE];
+    }
+    tock = bench_now();
+    BENCH_REPORT(name, BENCH_COUNT, tick, tock);
+    sink = acc;
+}
+
+/* Time the standard atmosphere table */
+static void bench_stdatm(void)
+{
+    static double z_lst[BENCH_SIZE];
+    static struct atm_s atm_lst[BENCH_SIZE];
+    struct atm_s foo, bar;
+    double err[4] = {0.0}, acc = 0.0, tick, tock;
+    for (size_t k = 0; k <= 100000; k++) {
+        stdatm_model(10.0 * k, &foo);
+        stdatm_eval(10.0 * k, &bar);
+        err[0] = MAX(err[0], fabs(bar.th / foo.th - 1.0));
+        err[1] = MAX(err[1], fabs(bar.p / foo.p - 1.0));
+        err[2] = MAX(err[2], fabs(bar.rho / foo.rho - 1.0));
+        err[3] = MAX(err[3], 1e3 * fabs(bar.rho_z / bar.rho - foo.rho_z / foo.rho));
+    }
+    printf(
+        "stdatm max. error th %.1e p %.1e rho %.1e (rel.) rho_z / rho %.1e (1/km)\n",
+        err[0], err[1], err[2], err[3]
+    );
+    for (size_t k = 0; k < BENCH_SIZE; k++)
+        z_lst[k] = 1000e3 * (k + 0.5) / BENCH_SIZE;
+    tick = bench_now();
+    for (size_t n = 0; n < BENCH_COUNT; n++) {
+        stdatm_model(z_lst[n % BENCH_SIZE], &foo);
+        acc += foo.rho;
+    }
+    tock = bench_now();
+    BENCH_REPORT("stdatm_model", BENCH_COUNT, tick, tock);
+    tick = bench_now();
+    for (size_t n = 0; n < BENCH_COUNT; n++) {
+        stdatm_eval(z_lst[n % BENCH_SIZE], &foo);
+        acc += foo.rho;
+    }
+    tock = bench_now();
+    BENCH_REPORT("stdatm_eval", BENCH_COUNT, tick, tock);
+    tick = bench_now();
+    for (size_t n = 0; n < BENCH_COUNT; n += BENCH_SIZE) {
+        stdatm_eval_n(BENCH_SIZE, z_lst, atm_lst);
+        acc += atm_lst[n % BENCH_SIZE].rho;
+    }
+    tock = bench_now();
+    BENCH_REPORT("stdatm_eval_n", BENCH_COUNT, tick, tock);
+    sink = acc;
+}
+
+int main(int argc, char** argv)
+{
+    static const size_t deg_lst[] = {4, 8, 16, 30, 50, 70, 120, 180, 250, 360};
+    const char* file_name = (argc > 1) ? argv[1] : BENCH_EGM;
+    bench_f2d(0.0, 1e3);
+    bench_f2d(0.0, 1000e3);
+    bench_f2d(1000e3, 40000e3);
+    bench_f2d(0.0, 40000e3);
+    stdatm_init();
+    bench_stdatm();
+    for (size_t k = 0; k < BENCH_SIZE; k++) {
+        double la = 2.0 * M_PI * k / BENCH_SIZE, ph = 1.4 * sin(3.0 * la);
+        r_lst[k][0] = 7000.0e3 * cos(ph) * cos(la);
+        r_lst[k][1] = 7000.0e3 * cos(ph) * sin(la);
+        r_lst[k][2] = 7000.0e3 * sin(ph);
+    }
+    if ((argc < 2 && !bench_egm_file(file_name))
+        || !geopot_load(file_name, G_NMAX, G_NMAX)) {
+        fprintf(stderr, "geopot_load: `%s`\n", file_name);
+        return EXIT_FAILURE;
+    }
+    bench_eval("geopot_eval[4]", BENCH_COUNT, geopot_eval);
+    for (size_t i = 0; i < sizeof(deg_lst) / sizeof(deg_lst[0]); i++) {
+        char name[32];
+        size_t deg = deg_lst[i];
+        geopot_trunc(deg, deg);
+        snprintf(name, sizeof(name), "geopot_egm_eval[%zu]", deg);
+        bench_eval(name, MAX(BENCH_COUNT / ((deg + 1) * (deg + 2) / 2), 1000), geopot_egm_eval);
+    }
+    return EXIT_SUCCESS;
+}
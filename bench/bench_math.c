@@ -0,0 +1,166 @@
+#define _POSIX_C_SOURCE 199309L
+#include <stdlib.h>
+#include "bench.h"
+#include "vec.h"
+#include "quat.h"
+#include "mat.h"
+#include "simd.h"
+#include "log.h"
+
+/* Inline (SIMD) primitives vs. out-of-line scalar reference
+ * ---------------------------------------------------------
+ * The reference kernels are the scalar loops the library shipped before
+ * the primitives moved into the headers.
+ */
+
+#define BENCH_COUNT (100 * BENCH_REPEAT)
+#define BENCH_SIZE 64
+
+static vec_t u_lst[BENCH_SIZE], v_lst[BENCH_SIZE];
+static quat_t q_lst[BENCH_SIZE];
+static mat_t A_lst[BENCH_SIZE], S_lst[BENCH_SIZE], L_lst[BENCH_SIZE];
+volatile double sink;
+
+__attribute__((noinline))
+static void ref_vec_add(const vec_t u_bar, const vec_t v_bar, vec_t w_bar)
+{
+    LOG_STATS("vec_add", 3, 0, 0);
+    for (size_t i = 0; i < 3; i++)
+        w_bar[i] = u_bar[i] + v_bar[i];
+}
+
+__attribute__((noinline))
+static void ref_vec_cross(const vec_t u_bar, const vec_t v_bar, vec_t w_bar)
+{
+    LOG_STATS("vec_cross", 3, 6, 0);
+    for (size_t i = 0; i < 3; i++)
+        w_bar[i] = u_bar[(i+1)%3] * v_bar[(i+2)%3]
+                 - u_bar[(i+2)%3] * v_bar[(i+1)%3];
+}
+
+__attribute__((noinline))
+static void ref_quat_conj(const quat_t p, quat_t q)
+{
+    LOG_STATS("quat_conj", 3, 0, 0);
+    q[0] = p[0];
+    for (size_t i = 1; i < 4; i++)
+        q[i] = - p[i];
+}
+
+__attribute__((noinline))
+static void ref_quat_vmul(const vec_t v_bar, const quat_t p, quat_t q)
+{
+    LOG_STATS("quat_vmul", 9, 12, 0);
+    q[0] = - v_bar[0] * p[1] - v_bar[1] * p[2] - v_bar[2] * p[3];
+    q[1] = v_bar[0] * p[0] - v_bar[2] * p[2] + v_bar[1] * p[3];
+    q[2] = v_bar[1] * p[0] + v_bar[2] * p[1] - v_bar[0] * p[3];
+    q[3] = v_bar[2] * p[0] - v_bar[1] * p[1] + v_bar[0] * p[2];
+}
+
+__attribute__((noinline))
+static void ref_quat_mul(const quat_t p, const quat_t q, quat_t r)
+{
+    LOG_STATS("quat_mul", 12, 16, 0);
+    r[0] = p[0] * q[0] - p[1] * q[1] - p[2] * q[2] - p[3] * q[3];
+    r[1] = p[0] * q[1] + p[1] * q[0] + p[2] * q[3] - p[3] * q[2];
+    r[2] = p[0] * q[2] - p[1] * q[3] + p[2] * q[0] + p[3] * q[1];
+    r[3] = p[0] * q[3] + p[1] * q[2] - p[2] * q[1] + p[3] * q[0];
+}
+
+__attribute__((noinline))
+static void ref_vec_rot(const quat_t q, const vec_t u_bar, vec_t v_bar)
+{
+    LOG_STATS("vec_rot", 0, 0, 0);
+    quat_t foo, bar;
+    ref_quat_conj(q, foo);
+    ref_quat_vmul(u_bar, foo, bar);
+    ref_quat_mul(q, bar, foo);
+    vec_pos(&foo[1], v_bar);
+}
+
+__attribute__((noinline))
+static void ref_mat_mul(const mat_t A, const mat_t B, mat_t C)
+{
+    LOG_STATS("mat_mul", 27, 27, 0);
+    for (size_t i = 0; i < 3; i++)
+        for (size_t j = 0; j < 3; j++) {
+            C[i][j] = 0.0;
+            for (size_t k = 0; k < 3; k++)
+                C[i][j] += A[i][k] * B[k][j];
+        }
+}
+
+__attribute__((noinline))
+static void ref_mat_mulv(const mat_t A, const vec_t u_bar, vec_t v_bar)
+{
+    LOG_STATS("mat_mulv", 9, 9, 0);
+    for (size_t i = 0; i < 3; i++) {
+        v_bar[i] = 0.0;
+        for (size_t j = 0; j < 3; j++)
+            v_bar[i] += A[i][j] * u_bar[j];
+    }
+}
+
+/* Time a kernel over the input lists
+ * :param name: benchmark name
+ * :param expr: kernel call (using `k`, `w_bar`, `r`, `C`)
+ * The outputs are accumulated so the inlined kernels are not eliminated.
+ */
+#define BENCH_KERNEL(name, expr) do {\
+    vec_t w_bar = {0.0, 0.0, 0.0};\
+    quat_t r = {0.0, 0.0, 0.0, 0.0};\
+    mat_t C = {{0.0}};\
+    double acc = 0.0, tick = bench_now();\
+    for (size_t n = 0; n < BENCH_COUNT; n++) {\
+        size_t k = n % BENCH_SIZE;\
+        expr;\
+        acc += w_bar[0] + r[0] + C[0][0];\
+    }\
+    double tock = bench_now();\
+    sink = acc;\
+    BENCH_REPORT(name, BENCH_COUNT, tick, tock);\
+} while (0)
+
+int main(void)
+{
+    for (size_t k = 0; k < BENCH_SIZE; k++) {
+        vec_t foo = {1.0 + k, 2.0 - k, 0.5 * k};
+        for (size_t i = 0; i < 3; i++) {
+            u_lst[k][i] = 1.0 + 0.1 * k + i;
+            v_lst[k][i] = 2.0 - 0.2 * k + i;
+            for (size_t j = 0; j < 3; j++) {
+                A_lst[k][i][j] = 0.5 * k + i - j;
+                S_lst[k][i][j] = (i == j) ? 4.0 + 0.1 * k : 0.1 * (i + j);
+            }
+        }
+        mat_chol((void*) S_lst[k], L_lst[k]);
+        vec_unit(foo, foo);
+        vec_muls(foo, 0.01 * k, foo);
+        vec_exp(foo, q_lst[k]);
+    }
+    printf("simd: %s\n", SIMD_NAME);
+    BENCH_KERNEL("ref_vec_add", ref_vec_add(u_lst[k], v_lst[k], w_bar));
+    BENCH_KERNEL("vec_add", vec_add(u_lst[k], v_lst[k], w_bar));
+    BENCH_KERNEL("ref_vec_cross", ref_vec_cross(u_lst[k], v_lst[k], w_bar));
+    BENCH_KERNEL("vec_cross", vec_cross(u_lst[k], v_lst[k], w_bar));
+    BENCH_KERNEL("ref_quat_mul", ref_quat_mul(q_lst[k], q_lst[BENCH_SIZE - 1 - k], r));
+    BENCH_KERNEL("quat_mul", quat_mul(q_lst[k], q_lst[BENCH_SIZE - 1 - k], r));
+    BENCH_KERNEL("ref_vec_rot", ref_vec_rot(q_lst[k], u_lst[k], w_bar));
+    BENCH_KERNEL("vec_rot", vec_rot(q_lst[k], u_lst[k], w_bar));
+    BENCH_KERNEL("vec_irot", vec_irot(q_lst[k], u_lst[k], w_bar));
+    BENCH_KERNEL("vec_rot[3]", for (size_t i = 0; i < 3; i++)
+        vec_rot(q_lst[k], u_lst[(k+i)%BENCH_SIZE], v_lst[i]);
+        w_bar[0] = v_lst[2][0]);
+    BENCH_KERNEL("vec_rot_n[3]", vec_rot_n(q_lst[k], 3, (void*) u_lst[k % (BENCH_SIZE-2)], v_lst);
+        w_bar[0] = v_lst[2][0]);
+    BENCH_KERNEL("ref_mat_mulv", ref_mat_mulv((void*) A_lst[k], u_lst[k], w_bar));
+    BENCH_KERNEL("mat_mulv", mat_mulv((void*) A_lst[k], u_lst[k], w_bar));
+    BENCH_KERNEL("ref_mat_mul", ref_mat_mul((void*) A_lst[k], (void*) A_lst[k], C));
+    BENCH_KERNEL("mat_mul", mat_mul((void*) A_lst[k], (void*) A_lst[k], C));
+    BENCH_KERNEL("mat_inv+mulv", mat_inv((void*) S_lst[k], C);
+        mat_mulv((void*) C, u_lst[k], w_bar));
+    BENCH_KERNEL("mat_chol+solve", mat_chol((void*) S_lst[k], C);
+        mat_chol_solve((void*) C, u_lst[k], w_bar));
+    BENCH_KERNEL("mat_chol_solve", mat_chol_solve((void*) L_lst[k], u_lst[k], w_bar));
+    return EXIT_SUCCESS;
+}
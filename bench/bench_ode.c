@@ -0,0 +1,656 @@
+#define _POSIX_C_SOURCE 199309L
+#include <stdlib.h>
+#include "bench.h"
+#include "ode.h"
+#include "interp.h"
+#include "vehicle_model.h"
+#include "force_model.h"
+#include "gee.h"
+#include "geopot.h"
+#include "geomag.h"
+#include "stdatm.h"
+#include "fused.h"
+#include "config.h"
+
+/* Propagation context vs. variadic arguments
+ * ------------------------------------------
+ * Also times single force model evaluations through the generic
+ * `fun_lst` loop and the fused accumulators, and compares methods
+ * (work-precision) over one orbit of two-body plus `geopot` gravity.
+ * The stage combiner is timed against the chained `st_int` loop it
+ * replaced, on a spinning body, and the implicit methods with fixed-point
+ * against simplified Newton stage iteration. The state transition matrix
+ * (variational equations) is timed against 13 whole propagations.
+ * Drag (`stdatm`) is timed against the per-object face loop it replaced
+ * (object count as first argument).
+ */
+
+static struct vehicle_model_s vehicle_model;
+static struct st_s swap[3];
+static vec_t r_bar_ref;  // work-precision reference
+
+static void bench_meth(const char* name, ode_meth_t meth, bool ctx)
+{
+    struct force_model_s force_model = {
+        .size=1,
+        .accum_fun=apply_force_model,
+        .fun_lst={gee_fast}
+    };
+    struct cfg_s* cfg = &vehicle_model.cfg;
+    struct st_s *prev = &swap[0], *next = &swap[1], *curr = &swap[2];
+    struct ivp_s ivp = {
+        .size=vehicle_model.size, .cfg=cfg,
+        .prev=prev, .next=next, .curr=curr,
+        .in=&vehicle_model.in, .out=&vehicle_model.out, .em=&vehicle_model.em,
+        .force_model=&force_model
+    };
+    memcpy(next, &vehicle_model.st, sizeof(struct st_s));
+    double tick = bench_now();
+    for (size_t n = 0; n < BENCH_REPEAT; n++) {
+        SWAP(&prev, &next);
+        ivp.prev = prev;
+        ivp.next = next;
+        solve_st_dot(ivp.size, cfg, prev, next, ivp.in);
+        if (ctx)
+            solve_ivp_ctx(
+                prev->clk.t, &prev->sys,
+                next->clk.t, &next->sys,
+                meth, force_model.accum_fun, NULL,
+                &ivp
+            );
+        else
+            solve_ivp(
+                prev->clk.t, &prev->sys,
+                next->clk.t, &next->sys,
+                meth, force_model.accum_fun, NULL,
+                9, ivp.size, cfg, prev, next, curr,
+                ivp.in, ivp.out, ivp.em, &force_model
+            );
+    }
+    double tock = bench_now();
+    BENCH_REPORT(name, BENCH_REPEAT, tick, tock);
+}
+
+static void bench_adapt(const char* name, ode_meth_t meth, bool fsal)
+{
+    struct force_model_s force_model = {
+        .size=1,
+        .accum_fun=apply_force_model,
+        .step_fun=adjust_time_step,
+        .fun_lst={gee_fast}
+    };
+    struct cfg_s* cfg = &vehicle_model.cfg;
+    struct st_s *prev = &swap[0], *next = &swap[1], *curr = &swap[2];
+    struct ode_fsal_s cache = {.valid=false};
+    struct ode_stats_s stats = {0};
+    struct ivp_s ivp = {
+        .size=vehicle_model.size, .cfg=cfg,
+        .prev=prev, .next=next, .curr=curr,
+        .in=&vehicle_model.in, .out=&vehicle_model.out, .em=&vehicle_model.em,
+        .force_model=&force_model,
+        .fsal=fsal ? &cache : NULL, .stats=&stats
+    };
+    double delta_t = cfg->clk.delta_t;
+    memcpy(next, &vehicle_model.st, sizeof(struct st_s));
+    double tick = bench_now();
+    for (size_t n = 0; n < BENCH_REPEAT; n++) {
+        SWAP(&prev, &next);
+        ivp.prev = prev;
+        ivp.next = next;
+        do solve_st_dot(ivp.size, cfg, prev, next, ivp.in);
+        while (
+            !solve_ivp_ctx(
+                prev->clk.t, &prev->sys,
+                next->clk.t, &next->sys,
+                meth, force_model.accum_fun, force_model.step_fun,
+                &ivp
+            )
+        );
+    }
+    double tock = bench_now();
+    cfg->clk.delta_t = delta_t;
+    BENCH_REPORT(name, BENCH_REPEAT, tick, tock);
+    printf(
+        "%-24s %12.2f fevals/step %6.2f%% rejected\n", name,
+        (double) stats.n_fun / stats.n_accept,
+        100.0 * stats.n_reject / (stats.n_accept + stats.n_reject)
+    );
+}
+
+static double bench_step(
+    ode_meth_t meth, double delta_t,
+    struct ode_dense_s* dense, struct st_s* prev, struct st_s* next
+) {
+    struct force_model_s force_model = {
+        .size=1,
+        .accum_fun=apply_force_model,
+        .step_fun=adjust_time_step,
+        .fun_lst={gee_fast}
+    };
+    struct cfg_s cfg;
+    memcpy(&cfg, &vehicle_model.cfg, sizeof(struct cfg_s));
+    cfg.clk.delta_t = delta_t;
+    struct ivp_s ivp = {
+        .size=vehicle_model.size, .cfg=&cfg,
+        .prev=prev, .next=next, .curr=&swap[2],
+        .in=&vehicle_model.in, .out=&vehicle_model.out, .em=&vehicle_model.em,
+        .force_model=&force_model, .dense=dense
+    };
+    memcpy(prev, &vehicle_model.st, sizeof(struct st_s));
+    solve_st_dot(ivp.size, &cfg, prev, next, ivp.in);
+    solve_ivp_ctx(
+        prev->clk.t, &prev->sys, next->clk.t, &next->sys,
+        meth, force_model.accum_fun, force_model.step_fun, &ivp
+    );
+    return next->sys.r_bar[0];
+}
+
+static void bench_dense(const char* name, ode_meth_t meth, double delta_t)
+{
+    struct ode_dense_s dense = {.valid=false};
+    struct st_s prev, next, curr, ref;
+    char buf[64];
+    // reference: mid-step state from a (half-length) step
+    bench_step(meth, 0.5 * delta_t, NULL, &prev, &ref);
+    bench_step(meth, delta_t, &dense, &prev, &next);
+    curr.clk.t = prev.clk.t + 0.5 * delta_t;
+    double tick = bench_now();
+    for (size_t n = 0; n < BENCH_REPEAT; n++)
+        interp_st(vehicle_model.size, &prev, &next, &curr);
+    double tock = bench_now();
+    vec_sub(curr.sys.r_bar, ref.sys.r_bar, curr.sys.r_bar);
+    snprintf(buf, sizeof(buf), "interp_st[%s]", name);
+    BENCH_REPORT(buf, BENCH_REPEAT, tick, tock);
+    printf("%-24s %12.3e m (h = %.0f s)\n", buf, vec_norm(curr.sys.r_bar), delta_t);
+    tick = bench_now();
+    for (size_t n = 0; n < BENCH_REPEAT; n++)
+        ode_dense_eval(&dense, curr.clk.t, &curr.sys);
+    tock = bench_now();
+    vec_sub(curr.sys.r_bar, ref.sys.r_bar, curr.sys.r_bar);
+    snprintf(buf, sizeof(buf), "ode_dense_eval[%s]", name);
+    BENCH_REPORT(buf, BENCH_REPEAT, tick, tock);
+    printf("%-24s %12.3e m (h = %.0f s)\n", buf, vec_norm(curr.sys.r_bar), delta_t);
+}
+
+/* Chained stage combiner (reference)
+ * One `st_int` (and so one `quat_pow`) per nonzero coefficient.
+ */
+__attribute__((noinline))
+static void ref_apply_stage(
+    size_t N, const double A[static N],
+    double delta_x,
+    const st_t* y0,
+    st_t* restrict y1,
+    const st_t k[static N]
+) {
+    st_int(A[0] * delta_x, &k[0], y0, y1);
+    for (size_t i = 1; i < N; i++) {
+        if (fabs(A[i]) < ABSTOL)
+            continue;
+        st_t temp;
+        st_int(A[i] * delta_x, &k[i], y1, &temp);
+        st_pos(&temp, y1);
+    }
+}
+
+static void bench_weights(double th, double* b_bar)
+{
+    for (size_t i = 0; i < ODE_DENSE_SIZE; i++)
+        b_bar[i] = th * (i + 1) / 28.0;
+}
+
+static void bench_stage(double delta_t)
+{
+    struct ode_dense_s dense = {
+        .valid=true, .size=ODE_DENSE_SIZE,
+        .x0=0.0, .x1=delta_t,
+        .weight_fun=bench_weights
+    };
+    double b_bar[ODE_DENSE_SIZE];
+    st_t y, y_ref;
+    vec_t foo;
+    memcpy(&dense.y0, &vehicle_model.st.sys, sizeof(st_t));
+    for (size_t i = 0; i < ODE_DENSE_SIZE; i++) {
+        // spinning (about 0.4 rad/s) and nutating body
+        vec_t om_bar = {0.1, 0.2 + 0.01 * i, 0.3 - 0.02 * i};
+        vec_pos(dense.y0.v_bar, dense.k[i].r_bar);
+        vec_muls(om_bar, 0.5, foo);
+        vec_exp(foo, dense.k[i].q);
+        vec_zero(dense.k[i].v_bar);
+        vec_zero(dense.k[i].om_bar);
+    }
+    double tick = bench_now();
+    for (size_t n = 0; n < BENCH_REPEAT; n++) {
+        bench_weights((n % 64) / 64.0, b_bar);
+        ref_apply_stage(ODE_DENSE_SIZE, b_bar, delta_t, &dense.y0, &y_ref, dense.k);
+    }
+    double tock = bench_now();
+    BENCH_REPORT("stage[chain]", BENCH_REPEAT, tick, tock);
+    tick = bench_now();
+    for (size_t n = 0; n < BENCH_REPEAT; n++)
+        ode_dense_eval(&dense, delta_t * (n % 64) / 64.0, &y);
+    tock = bench_now();
+    BENCH_REPORT("stage[lie]", BENCH_REPEAT, tick, tock);
+}
+
+#define WORK_DURATION 5400.0  // about one low Earth orbit (multiple of each h)
+
+static bool fixed_time_step(
+    const st_t* y0 __attribute__((unused)),
+    const st_t* y1 __attribute__((unused)),
+    const st_t* y2 __attribute__((unused)),
+    int q __attribute__((unused)),
+    struct ivp_s* ivp __attribute__((unused))
+) {
+    return true;
+}
+
+static void bench_work(
+    const char* name, ode_meth_t meth, double delta_t,
+    vec_t r_bar
+) {
+    struct force_model_s force_model = {
+        .size=2,
+        .accum_fun=apply_force_model,
+        .fun_lst={gee_fast, geopot}
+    };
+    struct cfg_s cfg;
+    memcpy(&cfg, &vehicle_model.cfg, sizeof(struct cfg_s));
+    cfg.clk.delta_t = delta_t;
+    struct st_s *prev = &swap[0], *next = &swap[1], *curr = &swap[2];
+    struct ode_fsal_s fsal = {0};
+    struct ode_stats_s stats = {0};
+    struct ode_multi_s multi = {0};
+    struct ivp_s ivp = {
+        .size=vehicle_model.size, .cfg=&cfg,
+        .prev=prev, .next=next, .curr=curr,
+        .in=&vehicle_model.in, .out=&vehicle_model.out, .em=&vehicle_model.em,
+        .force_model=&force_model, .fsal=&fsal, .stats=&stats, .multi=&multi
+    };
+    memcpy(next, &vehicle_model.st, sizeof(struct st_s));
+    double tick = bench_now();
+    while (next->clk.t < WORK_DURATION - 0.5 * delta_t) {
+        SWAP(&prev, &next);
+        ivp.prev = prev;
+        ivp.next = next;
+        solve_st_dot(ivp.size, &cfg, prev, next, ivp.in);
+        solve_ivp_ctx(
+            prev->clk.t, &prev->sys, next->clk.t, &next->sys,
+            meth, force_model.accum_fun, fixed_time_step, &ivp
+        );
+    }
+    double tock = bench_now();
+    if (r_bar != NULL) {
+        vec_t temp;
+        vec_sub(next->sys.r_bar, r_bar, temp);
+        printf(
+            "%-12s h = %5.0f s %8llu fevals %10.1f us %12.3e m\n",
+            name, delta_t, (unsigned long long) stats.n_fun,
+            1e6 * (tock - tick), vec_norm(temp)
+        );
+    } else
+        vec_pos(next->sys.r_bar, r_bar_ref);
+}
+
+#define IMPLICIT_COUNT 1000
+
+static void bench_implicit(
+    const char* name, ode_meth_t meth, ode_jac_t jac, bool warm,
+    double delta_t
+) {
+    struct force_model_s force_model = {
+        .size=2,
+        .accum_fun=apply_force_model,
+        .fun_lst={gee_fast, geopot},
+        .jac_lst={gee_fast_jac, geopot_jac}
+    };
+    struct cfg_s cfg;
+    memcpy(&cfg, &vehicle_model.cfg, sizeof(struct cfg_s));
+    cfg.clk.delta_t = delta_t;
+    struct st_s *prev = &swap[0], *next = &swap[1], *curr = &swap[2];
+    struct ode_stats_s stats = {0};
+    struct ode_stage_s stage = {.valid=false};
+    struct ivp_s ivp = {
+        .size=vehicle_model.size, .cfg=&cfg,
+        .prev=prev, .next=next, .curr=curr,
+        .in=&vehicle_model.in, .out=&vehicle_model.out, .em=&vehicle_model.em,
+        .force_model=&force_model, .stats=&stats,
+        .stage=warm ? &stage : NULL, .jac=jac
+    };
+    memcpy(next, &vehicle_model.st, sizeof(struct st_s));
+    // spinning (about 0.4 rad/s) body
+    vec_t om_bar = {0.1, 0.2, 0.3};
+    vec_pos(om_bar, next->sys.om_bar);
+    double tick = bench_now();
+    for (size_t n = 0; n < IMPLICIT_COUNT; n++) {
+        SWAP(&prev, &next);
+        ivp.prev = prev;
+        ivp.next = next;
+        solve_st_dot(ivp.size, &cfg, prev, next, ivp.in);
+        solve_ivp_ctx(
+            prev->clk.t, &prev->sys, next->clk.t, &next->sys,
+            meth, force_model.accum_fun, fixed_time_step, &ivp
+        );
+    }
+    double tock = bench_now();
+    BENCH_REPORT(name, IMPLICIT_COUNT, tick, tock);
+    printf(
+        "%-24s %12.2f iter/step %6.2f fevals/step (h = %.0f s)\n", name,
+        (double) stats.n_iter / stats.n_accept,
+        (double) stats.n_fun / stats.n_accept, delta_t
+    );
+}
+
+#define STM_COUNT 100
+
+/* Time state transition matrix
+ * :param name: benchmark name
+ * :param meth: integration function
+ * :param fd: forward differences of 13 propagations (base and one per
+ *     tangent space column) instead of the variational equations
+ */
+static void bench_stm(const char* name, ode_meth_t meth, bool fd)
+{
+    struct force_model_s force_model = {
+        .size=2,
+        .accum_fun=apply_force_model,
+        .fun_lst={gee_fast, geopot},
+        .jac_lst={gee_fast_jac, geopot_jac}
+    };
+    struct cfg_s cfg;
+    memcpy(&cfg, &vehicle_model.cfg, sizeof(struct cfg_s));
+    cfg.clk.delta_t = 10.0;
+    struct st_s *prev = &swap[0], *next = &swap[1], *curr = &swap[2];
+    struct ode_stats_s stats = {0};
+    struct ode_stm_s stm = {.valid=!fd, .jac=jacobian_force_model};
+    struct ivp_s ivp = {
+        .size=vehicle_model.size, .cfg=&cfg,
+        .prev=prev, .next=next, .curr=curr,
+        .in=&vehicle_model.in, .out=&vehicle_model.out, .em=&vehicle_model.em,
+        .force_model=&force_model, .stats=&stats, .stm=&stm
+    };
+    st_t y;
+    for (size_t i = 0; i < ODE_JAC_SIZE; i++)
+        for (size_t j = 0; j < ODE_JAC_SIZE; j++)
+            stm.Phi[i][j] = (i == j) ? 1.0 : 0.0;
+    double tick = bench_now();
+    for (size_t j = 0; j < (fd ? 1 + ODE_JAC_SIZE : 1); j++) {
+        vec_t e_bar = {0.0, 0.0, 0.0};
+        quat_t p, q;
+        memcpy(next, &vehicle_model.st, sizeof(struct st_s));
+        e_bar[(j + 2) % 3] = 1e-6;
+        switch (j > 0 ? (j - 1) / 3 : 4) {  // column j - 1
+        case 0:
+            vec_add(next->sys.r_bar, e_bar, next->sys.r_bar);
+            break;
+        case 1:
+            vec_exp(e_bar, q);
+            quat_pos(next->sys.q, p);
+            quat_mul(p, q, next->sys.q);
+            break;
+        case 2:
+            vec_add(next->sys.v_bar, e_bar, next->sys.v_bar);
+            break;
+        case 3:
+            vec_add(next->sys.om_bar, e_bar, next->sys.om_bar);
+            break;
+        }
+        for (size_t n = 0; n < STM_COUNT; n++) {
+            SWAP(&prev, &next);
+            ivp.prev = prev;
+            ivp.next = next;
+            solve_st_dot(ivp.size, &cfg, prev, next, ivp.in);
+            solve_ivp_ctx(
+                prev->clk.t, &prev->sys, next->clk.t, &next->sys,
+                meth, force_model.accum_fun, fixed_time_step, &ivp
+            );
+        }
+        if (j == 0)
+            memcpy(&y, &next->sys, sizeof(st_t));
+        else  // position rows only, the others follow alike
+            for (size_t i = 0; i < 3; i++)
+                stm.Phi[i][j - 1] = (next->sys.r_bar[i] - y.r_bar[i]) / 1e-6;
+    }
+    double tock = bench_now();
+    BENCH_REPORT(name, STM_COUNT, tick, tock);
+    printf(
+        "%-24s %12.2f fevals/step %6.2f jacobians/step\n", name,
+        (double) stats.n_fun / STM_COUNT, (double) stats.n_jac / STM_COUNT
+    );
+}
+
+/* Previous (per-object) drag force, for reference */
+static bool ref_stdatm(
+    size_t size,
+    const struct cfg_s* cfg,
+    const struct st_s* st,
+    struct in_s* restrict in,
+    const struct out_s* out,
+    struct em_s* restrict em __attribute__((unused))
+) {
+    double v = vec_norm(st->sys.v_bar), A, F;
+    vec_t v_bar, foo, bar;
+    struct atm_s atm;
+    if (!stdatm_eval(gee_env(st, out, in, ENV_ALT)->alt, &atm))
+        return true;
+    vec_irot(st->sys.q, st->sys.v_bar, v_bar);
+    vec_zero(foo);
+    for (size_t idx = 0; idx < size; idx++) {
+        const double* bbox = cfg->OBJ_LST(idx, bbox);
+        vec_t temp;
+        mat_t R;
+        quat_irot_mat(cfg->OBJ_LST(idx, q), R);
+        for (size_t i = 0; i < 3; i++) {
+            A = bbox[(i+1)%3] * bbox[(i+2)%3];
+            F = atm.rho * v * vec_dot(v_bar, R[i]) * A;
+            vec_muls(R[i], - F, temp);
+            vec_add(foo, temp, foo);
+            vec_cross(cfg->OBJ_LST(idx, r_bar), temp, bar);
+            vec_add(in->sys.M_bar, bar, in->sys.M_bar);
+        }
+    }
+    vec_rot(st->sys.q, foo, bar);
+    vec_add(in->sys.F_bar, bar, in->sys.F_bar);
+    return true;
+}
+
+static void bench_out(const char* name)
+{
+    double tick = bench_now();
+    for (size_t n = 0; n < BENCH_REPEAT; n++)
+        solve_out(
+            vehicle_model.size, &vehicle_model.cfg,
+            &vehicle_model.st, &vehicle_model.out
+        );
+    double tock = bench_now();
+    BENCH_REPORT(name, BENCH_REPEAT, tick, tock);
+}
+
+/* Time the per-object kernels
+ * Meant for comparing the object list layouts (`__SOA__`), e.g. built
+ * with `make bench CFLAGS="... -O3" MACROS="__XLARGE__ __SOA__ ..."`.
+ */
+#define BENCH_OBJ(name, expr) do {\
+    double tick = bench_now();\
+    for (size_t n = 0; n < BENCH_REPEAT; n++)\
+        expr;\
+    double tock = bench_now();\
+    BENCH_REPORT(name, BENCH_REPEAT, tick, tock);\
+} while (0)
+
+static void bench_obj(void)
+{
+    size_t size = vehicle_model.size;
+    struct cfg_s* cfg = &vehicle_model.cfg;
+    struct in_s* in = &vehicle_model.in;
+    struct out_s* out = &vehicle_model.out;
+    struct em_s* em = &vehicle_model.em;
+    struct st_s *prev = &swap[0], *next = &swap[1], *curr = &swap[2];
+    memcpy(prev, &vehicle_model.st, sizeof(struct st_s));
+    memcpy(next, &vehicle_model.st, sizeof(struct st_s));
+    memcpy(curr, &vehicle_model.st, sizeof(struct st_s));
+    next->clk.t = prev->clk.t + 1.0;
+    curr->clk.t = prev->clk.t + 0.5;
+    BENCH_OBJ("interp_obj_lst", interp_obj_lst(size, prev, next, curr));
+    BENCH_OBJ("solve_st_dot", solve_st_dot(size, cfg, prev, next, in));
+    BENCH_OBJ("solve_in", solve_in(size, cfg, curr, in, out));
+    BENCH_OBJ("solve_em", solve_em(size, cfg, em));
+    BENCH_OBJ("solve_out[full]", (out->acc.size = 0, solve_out(size, cfg, curr, out)));
+    BENCH_OBJ("gee", gee(size, cfg, curr, in, out, em));
+}
+
+static void bench_accum(
+    const char* name, ode_fun_t accum_fun,
+    size_t size, const force_fun_t fun_lst[]
+) {
+    struct force_model_s force_model = {.size=size, .accum_fun=accum_fun};
+    memcpy(force_model.fun_lst, fun_lst, size * sizeof(force_fun_t));
+    struct st_s *prev = &swap[0], *next = &swap[1], *curr = &swap[2];
+    struct ivp_s ivp = {
+        .size=vehicle_model.size, .cfg=&vehicle_model.cfg,
+        .prev=prev, .next=next, .curr=curr,
+        .in=&vehicle_model.in, .out=&vehicle_model.out, .em=&vehicle_model.em,
+        .force_model=&force_model
+    };
+    st_t f;
+    memcpy(prev, &vehicle_model.st, sizeof(struct st_s));
+    memcpy(next, &vehicle_model.st, sizeof(struct st_s));
+    next->clk.t = prev->clk.t + 1.0;
+    double tick = bench_now();
+    for (size_t n = 0; n < BENCH_REPEAT; n++)
+        force_model.accum_fun(prev->clk.t + 0.5, &prev->sys, &f, &ivp);
+    double tock = bench_now();
+    BENCH_REPORT(name, BENCH_REPEAT, tick, tock);
+}
+
+/* Time force model Jacobian
+ * :param name: benchmark name
+ * :param size: force function count
+ * :param fun_lst: force functions
+ * :param jac_lst: force function partials, or `NULL` for forward differences
+ * The forward differences take 13 accumulator calls (base and one per
+ * tangent space column).
+ */
+static void bench_jacobian(
+    const char* name, size_t size,
+    const force_fun_t fun_lst[], const force_jac_t jac_lst[]
+) {
+    struct force_model_s force_model = {.size=size, .accum_fun=apply_force_model};
+    memcpy(force_model.fun_lst, fun_lst, size * sizeof(force_fun_t));
+    if (jac_lst != NULL)
+        memcpy(force_model.jac_lst, jac_lst, size * sizeof(force_jac_t));
+    struct st_s *prev = &swap[0], *next = &swap[1], *curr = &swap[2];
+    struct ivp_s ivp = {
+        .size=vehicle_model.size, .cfg=&vehicle_model.cfg,
+        .prev=prev, .next=next, .curr=curr,
+        .in=&vehicle_model.in, .out=&vehicle_model.out, .em=&vehicle_model.em,
+        .force_model=&force_model
+    };
+    double J[ODE_JAC_SIZE][ODE_JAC_SIZE];
+    st_t y, f, g;
+    memcpy(prev, &vehicle_model.st, sizeof(struct st_s));
+    memcpy(next, &vehicle_model.st, sizeof(struct st_s));
+    next->clk.t = prev->clk.t + 1.0;
+    double tick = bench_now();
+    for (size_t n = 0; n < BENCH_REPEAT; n++) {
+        if (jac_lst != NULL) {
+            jacobian_force_model(prev->clk.t + 0.5, &prev->sys, NULL, J, &ivp);
+            continue;
+        }
+        apply_force_model(prev->clk.t + 0.5, &prev->sys, &f, &ivp);
+        for (size_t j = 0; j < ODE_JAC_SIZE; j++) {
+            vec_t e_bar = {0.0, 0.0, 0.0};
+            quat_t q;
+            memcpy(&y, &prev->sys, sizeof(st_t));
+            e_bar[j % 3] = 1e-6;
+            switch (j / 3) {
+            case 0:
+                vec_add(y.r_bar, e_bar, y.r_bar);
+                break;
+            case 1:
+                vec_exp(e_bar, q);
+                quat_mul(prev->sys.q, q, y.q);
+                break;
+            case 2:
+                vec_add(y.v_bar, e_bar, y.v_bar);
+                break;
+            default:
+                vec_add(y.om_bar, e_bar, y.om_bar);
+                break;
+            }
+            apply_force_model(prev->clk.t + 0.5, &y, &g, &ivp);
+            for (size_t i = 0; i < 3; i++) {
+                J[6 + i][j] = (g.v_bar[i] - f.v_bar[i]) / 1e-6;
+                J[9 + i][j] = (g.om_bar[i] - f.om_bar[i]) / 1e-6;
+            }
+        }
+    }
+    double tock = bench_now();
+    BENCH_REPORT(name, BENCH_REPEAT, tick, tock);
+}
+
+int main(int argc, char** argv)
+{
+    size_t size = (argc > 1) ? (size_t) atoi(argv[1]) : 1;
+    interp_init();
+    bench_vehicle_model(MIN(size, MAX_OBJ_COUNT), &vehicle_model);
+    bench_out("solve_out");
+    solve_cfg(vehicle_model.size, &vehicle_model.cfg);
+    bench_out("solve_out[drv]");
+    bench_obj();
+    stdatm_init();
+    const force_fun_t gee_stdatm[] = {gee_fast, stdatm},
+                      geoall_em[] = {geoall, em};
+    bench_accum("accum[gee_fast]", apply_force_model, 1, gee_stdatm);
+    bench_accum("fused[gee_fast]", FORCE_MODEL_NAME(gee_fast), 1, gee_stdatm);
+    bench_accum("accum[gee_fast+stdatm]", apply_force_model, 2, gee_stdatm);
+    bench_accum("fused[gee_fast+stdatm]", FORCE_MODEL_NAME(gee_fast_stdatm), 2, gee_stdatm);
+    bench_accum("accum[geoall+em]", apply_force_model, 2, geoall_em);
+    bench_accum("fused[geoall+em]", FORCE_MODEL_NAME(geoall_em), 2, geoall_em);
+    const force_fun_t earth[] = {gee_fast, geopot, geomag, em, stdatm};
+    bench_accum("accum[gee+geopot+geomag+em+stdatm]", apply_force_model, 5, earth);
+    const force_fun_t drag[] = {stdatm, ref_stdatm};
+    bench_accum("accum[stdatm]", apply_force_model, 1, &drag[0]);
+    bench_accum("accum[ref_stdatm]", apply_force_model, 1, &drag[1]);
+    const force_fun_t gee_stdatm_geopot[] = {gee_fast, stdatm, geopot};
+    const force_jac_t gee_stdatm_geopot_jac[] = {gee_fast_jac, stdatm_jac, geopot_jac};
+    bench_jacobian("jacobian[gee_fast]", 1, gee_stdatm_geopot, gee_stdatm_geopot_jac);
+    bench_jacobian("jacobian_fd[gee_fast]", 1, gee_stdatm_geopot, NULL);
+    bench_jacobian("jacobian[gee_fast+stdatm+geopot]", 3, gee_stdatm_geopot, gee_stdatm_geopot_jac);
+    bench_jacobian("jacobian_fd[gee_fast+stdatm+geopot]", 3, gee_stdatm_geopot, NULL);
+    bench_meth("solve_ivp[rk4]", ODE_METHOD_NAME(rk4), false);
+    bench_meth("solve_ivp_ctx[rk4]", ODE_METHOD_NAME(rk4), true);
+    bench_adapt("adapt[dopri]", ODE_METHOD_NAME(dopri), false);
+    bench_adapt("adapt[dopri+fsal]", ODE_METHOD_NAME(dopri), true);
+    bench_dense("dopri", ODE_METHOD_NAME(dopri), 10.0);
+    bench_dense("dopri", ODE_METHOD_NAME(dopri), 60.0);
+    bench_dense("vgl6", ODE_METHOD_NAME(vgl6), 10.0);
+    bench_dense("vgl6", ODE_METHOD_NAME(vgl6), 60.0);
+    bench_stage(10.0);
+    bench_work("dop853", ODE_METHOD_NAME(dop853), 5.0, NULL);
+    const double h_lst[] = {15.0, 30.0, 60.0, 135.0, 270.0};
+    for (size_t i = 0; i < sizeof(h_lst) / sizeof(h_lst[0]); i++) {
+        bench_work("dopri", ODE_METHOD_NAME(dopri), h_lst[i], r_bar_ref);
+        bench_work("dop853", ODE_METHOD_NAME(dop853), h_lst[i], r_bar_ref);
+        bench_work("vgl6", ODE_METHOD_NAME(vgl6), h_lst[i], r_bar_ref);
+        bench_work("abm", ODE_METHOD_NAME(abm), h_lst[i], r_bar_ref);
+    }
+    const double h_imp[] = {2.0, 10.0, 30.0};
+    for (size_t i = 0; i < sizeof(h_imp) / sizeof(h_imp[0]); i++) {
+        bench_implicit("implicit[vgl4]", ODE_METHOD_NAME(vgl4), NULL, false, h_imp[i]);
+        bench_implicit("implicit[vgl4+warm]", ODE_METHOD_NAME(vgl4), NULL, true, h_imp[i]);
+        bench_implicit("newton[vgl4]", ODE_METHOD_NAME(vgl4), jacobian_force_model, false, h_imp[i]);
+        bench_implicit("newton[vgl4+warm]", ODE_METHOD_NAME(vgl4), jacobian_force_model, true, h_imp[i]);
+        bench_implicit("implicit[vgl6]", ODE_METHOD_NAME(vgl6), NULL, false, h_imp[i]);
+        bench_implicit("implicit[vgl6+warm]", ODE_METHOD_NAME(vgl6), NULL, true, h_imp[i]);
+        bench_implicit("newton[vgl6]", ODE_METHOD_NAME(vgl6), jacobian_force_model, false, h_imp[i]);
+        bench_implicit("newton[vgl6+warm]", ODE_METHOD_NAME(vgl6), jacobian_force_model, true, h_imp[i]);
+    }
+    bench_stm("stm[rk4]", ODE_METHOD_NAME(rk4), false);
+    bench_stm("stm_fd[rk4]", ODE_METHOD_NAME(rk4), true);
+    bench_stm("stm[vgl6]", ODE_METHOD_NAME(vgl6), false);
+    bench_stm("stm_fd[vgl6]", ODE_METHOD_NAME(vgl6), true);
+    bench_meth("solve_ivp[vgl6]", ODE_METHOD_NAME(vgl6), false);
+    bench_meth("solve_ivp_ctx[vgl6]", ODE_METHOD_NAME(vgl6), true);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,80 @@
+#define _POSIX_C_SOURCE 199309L
+#include <stdlib.h>
+#include <unistd.h>
+#include "bench.h"
+#include "batch.h"
+#include "pool.h"
+#include "vehicle_model.h"
+#include "force_model.h"
+#include "gee.h"
+#include "log.h"
+
+/* Worker pool throughput
+ * ----------------------
+ */
+
+#define BENCH_VEHICLES 10000
+#define BENCH_STEPS 10
+
+static struct force_model_s force_model = {
+    .size=1,
+    .accum_fun=apply_force_model,
+    .fun_lst={gee_fast}
+};
+
+static double bench_pool(
+    size_t size, size_t nthreads,
+    struct vehicle_model_s* vehicle_model,
+    struct batch_s* batch
+) {
+    struct pool_s pool;
+    for (size_t i = 0; i < BENCH_VEHICLES; i++) {
+        bench_vehicle_model(size, &vehicle_model[i]);
+        vehicle_model[i].st.sys.r_bar[0] += i;  // dispersion
+    }
+    batch_init(BENCH_VEHICLES, vehicle_model, batch);
+    if ((nthreads > 0) && !pool_init(&pool, nthreads))
+        return 0.0;
+    RESET_STATS();
+    double tick = bench_now();
+    for (size_t n = 1; n <= BENCH_STEPS; n++)
+        if (nthreads > 0)
+            pool_solve(&pool, BENCH_VEHICLES, n * 1.0, vehicle_model, batch, ODE_METHOD_NAME(rk4), &force_model);
+        else
+            solve_batch(BENCH_VEHICLES, n * 1.0, vehicle_model, batch, ODE_METHOD_NAME(rk4), &force_model);
+    double tock = bench_now();
+    if (nthreads > 0)
+        pool_free(&pool);
+    return BENCH_VEHICLES * BENCH_STEPS / (tock - tick);
+}
+
+int main(int argc, char** argv)
+{
+    size_t size = (argc > 1) ? (size_t) atoi(argv[1]) : 1;
+    size_t ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+    struct vehicle_model_s* serial = malloc(BENCH_VEHICLES * sizeof(struct vehicle_model_s));
+    struct vehicle_model_s* parallel = malloc(BENCH_VEHICLES * sizeof(struct vehicle_model_s));
+    struct batch_s* batch = malloc(BENCH_VEHICLES * sizeof(struct batch_s));
+    size = MIN(size, MAX_OBJ_COUNT);
+    double base = bench_pool(size, 0, serial, batch);
+    printf("%-24s %12.0f vehicle-steps/s\n", "solve_batch", base);
+#ifdef __DEBUG__
+    long stats[3] = {stats_total_add, stats_total_mul, stats_total_pow};
+#endif
+    // (oversubscribed on small hosts, to exercise the stealing)
+    for (size_t nthreads = 1; nthreads <= MAX(ncpus, 8); nthreads *= 2) {
+        char name[32];
+        double rate = bench_pool(size, nthreads, parallel, batch);
+        snprintf(name, sizeof(name), "pool_solve[%zu]", nthreads);
+        printf("%-24s %12.0f vehicle-steps/s %6.2fx %s\n", name, rate, rate / base,
+               memcmp(serial, parallel, BENCH_VEHICLES * sizeof(struct vehicle_model_s)) ? "MISMATCH" : "identical");
+#ifdef __DEBUG__
+        if (stats_total_add != stats[0] || stats_total_mul != stats[1] || stats_total_pow != stats[2])
+            printf("%-24s operation counts MISMATCH\n", name);
+#endif
+    }
+    free(batch);
+    free(parallel);
+    free(serial);
+    return EXIT_SUCCESS;
+}
@@ -20,6 +20,8 @@ __all__ = (
     "GMAT_NDIM",
     "ODE_EULER",
     "MAX_OBJ_COUNT",
+    "G_DEG",
+    "G_ORD",
     "vec_t", "p_vec_t",
     "mat_t", "p_mat_t",
     "quat_t", "p_quat_t",
@@ -32,6 +34,8 @@ __all__ = (
 POLY_DEG = 5
 ODE_EULER = False
 MAX_OBJ_COUNT = 16
+G_DEG = 4
+G_ORD = 4
 
 # data types
 vec_t = ctypes.c_double * 3
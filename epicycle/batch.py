@@ -0,0 +1,68 @@
+# built-in libraries
+import ctypes
+
+# external libraries
+# ...
+
+# internal libraries
+from . import libcore
+from .vehicle_model import (
+    st_t, p_st_t,
+    vehicle_model_t, p_vehicle_model_t,
+)
+from .force_model import force_model_t, p_force_model_t
+from .ode import (
+    ode_fsal_t, ode_stats_t, ode_dense_t, ode_multi_t, ode_stage_t, ode_stm_t,
+)
+
+# exports
+__all__ = (
+    "batch_t", "p_batch_t",
+    "batch_init", "solve_batch",
+)
+
+
+class batch_t(ctypes.Structure):
+    _fields_ = [
+        ("swap", st_t * 3),
+        ("prev", p_st_t),
+        ("next", p_st_t),
+        ("curr", p_st_t),
+        ("fsal", ode_fsal_t),
+        ("stats", ode_stats_t),
+        ("dense", ode_dense_t),
+        ("multi", ode_multi_t),
+        ("stage", ode_stage_t),
+        ("stm", ode_stm_t),
+    ]
+
+
+p_batch_t = ctypes.POINTER(batch_t)
+
+
+# void batch_init(size_t, struct vehicle_model_s*, struct batch_s*)
+libcore.batch_init.argtypes = [
+    ctypes.c_size_t, p_vehicle_model_t, p_batch_t]
+def batch_init(vehicle_model, batch):
+    libcore.batch_init(len(vehicle_model), vehicle_model, batch)
+
+
+# void solve_batch(size_t, double,
+#                  struct vehicle_model_s*, struct batch_s*,
+#                  ode_meth_t, struct force_model_s*)
+libcore.solve_batch.argtypes = [
+    ctypes.c_size_t, ctypes.c_double,
+    p_vehicle_model_t, p_batch_t,
+    ctypes.c_void_p, p_force_model_t]
+def solve_batch(
+    t: float,
+    vehicle_model,
+    batch,
+    meth,
+    force_model: force_model_t
+):
+    libcore.solve_batch(
+        len(vehicle_model), t,
+        vehicle_model, batch,
+        meth, ctypes.byref(force_model)
+    )
@@ -20,7 +20,7 @@ __all__ = (
     "force_model_t", "p_force_model_t",
     "interp_st", "interp_obj_lst",
     "solve_st_dot", "solve_st_delta",
-    "solve_ch", "solve_in", "solve_out", "solve_em",
+    "solve_ch", "solve_in", "solve_cfg", "match_cfg", "solve_out", "solve_em",
 )
 
 
@@ -29,7 +29,9 @@ class force_model_t(ctypes.Structure):
         ("size", ctypes.c_size_t),
         ("accum_fun", ctypes.c_void_p),
         ("step_fun", ctypes.c_void_p),
+        ("jac_fun", ctypes.c_void_p),
         ("fun_lst", ctypes.c_void_p * 16),
+        ("jac_lst", ctypes.c_void_p * 16),
     ]
 
 
@@ -137,6 +139,20 @@ def solve_in(size: int, cfg: cfg_t, st: st_t, in_: in_t, out: out_t):
     )
 
 
+# bool solve_cfg(size_t, struct cfg_s*)
+libcore.solve_cfg.argtypes = [ctypes.c_size_t, p_cfg_t]
+libcore.solve_cfg.restype = ctypes.c_bool
+def solve_cfg(size: int, cfg: cfg_t) -> bool:
+    return libcore.solve_cfg(size, ctypes.byref(cfg))
+
+
+# bool match_cfg(size_t, struct cfg_s*)
+libcore.match_cfg.argtypes = [ctypes.c_size_t, p_cfg_t]
+libcore.match_cfg.restype = ctypes.c_bool
+def match_cfg(size: int, cfg: cfg_t) -> bool:
+    return libcore.match_cfg(size, ctypes.byref(cfg))
+
+
 # void solve_out(size_t, struct cfg_s*, struct st_s*, struct out_s*)
 libcore.solve_out.argtypes = [
     ctypes.c_size_t,
@@ -2,11 +2,11 @@
 import ctypes
 
 # external libraries
-# ...
+import numpy
 
 # internal libraries
 from . import libgee
-from .vec import p_vec_t
+from .vec import p_vec_t, p_vec_n_t
 from .vehicle_model import (
     cfg_t, p_cfg_t,
     st_t, p_st_t,
@@ -18,6 +18,7 @@ from .vehicle_model import (
 # exports
 __all__ = (
     "G_RMAX", "G_RMIN", "G_INVF", "G_MU", "G_J2", "G_J3", 
+    "f2d", "f2d_n",
     "gee", "gee_fast", "eval_all", "geoall",
 )
 
@@ -30,6 +31,34 @@ G_J2 = 1.75553e+25
 G_J3 = -2.61913e29
 
 
+# bool gee_f2d(vec_t*, double*, double*, double*)
+libgee.gee_f2d.argtypes = [
+    p_vec_t,
+    ctypes.POINTER(ctypes.c_double),
+    ctypes.POINTER(ctypes.c_double),
+    ctypes.POINTER(ctypes.c_double),
+]
+libgee.gee_f2d.restype = ctypes.c_bool
+def f2d(r_bar):
+    lat, lon, alt = ctypes.c_double(), ctypes.c_double(), ctypes.c_double()
+    if not libgee.gee_f2d(
+        r_bar, ctypes.byref(lat), ctypes.byref(lon), ctypes.byref(alt)
+    ):
+        raise ZeroDivisionError
+    return lat.value, lon.value, alt.value
+
+
+# void gee_f2d_n(size_t, vec_t*, double*, double*, double*)
+p_double_n_t = numpy.ctypeslib.ndpointer(
+    dtype=numpy.float64, ndim=1, flags="C")
+libgee.gee_f2d_n.argtypes = [
+    ctypes.c_size_t, p_vec_n_t, p_double_n_t, p_double_n_t, p_double_n_t]
+def f2d_n(r_lst):
+    lat, lon, alt = (numpy.empty((len(r_lst),), dtype=numpy.float64) for _ in range(3))
+    libgee.gee_f2d_n(len(r_lst), r_lst, lat, lon, alt)
+    return lat, lon, alt
+
+
 # bool gee(size_t, struct cfg_s*, struct st_s*,
 #          struct in_s*, struct out_s*, struct em_s*)
 libgee.gee.argtypes = [
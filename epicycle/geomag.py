@@ -10,7 +10,7 @@ from .vec import p_vec_t
 from .vehicle_model import (
     p_cfg_t,
     st_t, p_st_t,
-    p_in_t,
+    in_t, p_in_t,
     out_t, p_out_t,
     em_t, p_em_t,
 )
@@ -42,7 +42,7 @@ def geomag(st: st_t, out: out_t, em: em_t):
         0,
         None,
         ctypes.byref(st),
-        None,
+        ctypes.byref(in_t()),
         ctypes.byref(out),
         ctypes.byref(em)
     ):
@@ -2,11 +2,11 @@
 import ctypes
 
 # external libraries
-# ...
+import numpy
 
 # internal libraries
 from . import libgee
-from .vec import p_vec_t
+from .vec import p_vec_t, p_mat_t
 from .vehicle_model import (
     p_cfg_t,
     st_t, p_st_t,
@@ -16,10 +16,10 @@ from .vehicle_model import (
 )
 
 # exports
-__all__ = ("eval", "geopot")
+__all__ = ("G_NMAX", "load", "trunc", "eval", "egm_eval", "grad", "egm_grad", "geopot", "egm")
 
 # constants
-# ...
+G_NMAX = 360
 
 
 # void geopot_eval(double, vec_t*, vec_t*)
@@ -32,6 +32,52 @@ def eval(m: float, r_bar):
     return F_bar
 
 
+# bool geopot_load(char*, size_t, size_t)
+libgee.geopot_load.argtypes = [ctypes.c_char_p, ctypes.c_size_t, ctypes.c_size_t]
+libgee.geopot_load.restype = ctypes.c_bool
+def load(file_name: str, deg: int, ord: int):
+    if not libgee.geopot_load(str(file_name).encode(), deg, ord):
+        raise OSError(file_name)
+
+
+# bool geopot_trunc(size_t, size_t)
+libgee.geopot_trunc.argtypes = [ctypes.c_size_t, ctypes.c_size_t]
+libgee.geopot_trunc.restype = ctypes.c_bool
+def trunc(deg: int, ord: int):
+    if not libgee.geopot_trunc(deg, ord):
+        raise ValueError((deg, ord))
+
+
+# bool geopot_egm_eval(double, vec_t*, vec_t*)
+libgee.geopot_egm_eval.argtypes = [ctypes.c_double, p_vec_t, p_vec_t]
+libgee.geopot_egm_eval.restype = ctypes.c_bool
+def egm_eval(m: float, r_bar):
+    F_bar = numpy.empty((3,), dtype=numpy.float64)
+    if not libgee.geopot_egm_eval(m, r_bar, F_bar):
+        raise ZeroDivisionError
+    return F_bar
+
+
+# bool geopot_grad(double, vec_t*, mat_t*)
+libgee.geopot_grad.argtypes = [ctypes.c_double, p_vec_t, p_mat_t]
+libgee.geopot_grad.restype = ctypes.c_bool
+def grad(m: float, r_bar):
+    G = numpy.empty((3, 3), dtype=numpy.float64)
+    if not libgee.geopot_grad(m, r_bar, G):
+        raise ZeroDivisionError
+    return G
+
+
+# bool geopot_egm_grad(double, vec_t*, mat_t*)
+libgee.geopot_egm_grad.argtypes = [ctypes.c_double, p_vec_t, p_mat_t]
+libgee.geopot_egm_grad.restype = ctypes.c_bool
+def egm_grad(m: float, r_bar):
+    G = numpy.empty((3, 3), dtype=numpy.float64)
+    if not libgee.geopot_egm_grad(m, r_bar, G):
+        raise ZeroDivisionError
+    return G
+
+
 # bool geopot(size_t, struct cfg_s*, struct st_s*,
 #             struct in_s*, struct out_s*, struct em_s*)
 libgee.geopot.argtypes = [
@@ -48,3 +94,20 @@ def geopot(st: st_t, in_: in_t, out: out_t):
     ):
         raise ZeroDivisionError
 
+
+
+# bool geopot_egm(size_t, struct cfg_s*, struct st_s*,
+#                 struct in_s*, struct out_s*, struct em_s*)
+libgee.geopot_egm.argtypes = [
+    ctypes.c_size_t, p_cfg_t, p_st_t, p_in_t, p_out_t, p_em_t]
+libgee.geopot_egm.restype = ctypes.c_bool
+def egm(st: st_t, in_: in_t, out: out_t):
+    if not libgee.geopot_egm(
+        0,
+        None,
+        ctypes.byref(st),
+        ctypes.byref(in_),
+        ctypes.byref(out),
+        None
+    ):
+        raise ZeroDivisionError
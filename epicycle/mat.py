@@ -12,7 +12,7 @@ __all__ = (
     "mat_t", "p_mat_t",
     "eye",
     "neg",
-    "tr", "det", "inv", "T",
+    "tr", "det", "inv", "chol", "chol_solve", "T",
     "add", "sub",
     "muls", "mul", "mulv", "vmul",
 )
@@ -58,6 +58,24 @@ def inv(A):
     return A_inv
 
 
+# bool mat_chol(mat_t*, mat_t*)
+libmath.mat_chol.argtypes = [p_mat_t, p_mat_t]
+libmath.mat_chol.restype = ctypes.c_bool
+def chol(A):
+    L = numpy.empty((3, 3), dtype=numpy.float64)
+    if not libmath.mat_chol(A, L):
+        raise ValueError
+    return L
+
+
+# void mat_chol_solve(mat_t*, vec_t*, vec_t*)
+libmath.mat_chol_solve.argtypes = [p_mat_t, p_vec_t, p_vec_t]
+def chol_solve(L, u_bar):
+    v_bar = numpy.empty((3,), dtype=numpy.float64)
+    libmath.mat_chol_solve(L, u_bar, v_bar)
+    return v_bar
+
+
 # void mat__T(mat_t*, mat_t*)
 libmath.mat__T.argtypes = [p_mat_t, p_mat_t]
 def T(A):
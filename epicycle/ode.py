@@ -9,21 +9,185 @@ import numpy
 # internal libraries
 from . import libcore
 from .st import st_t, p_st_t
+from .vehicle_model import (
+    ODE_JAC_SIZE,
+    p_cfg_t,
+    p_st_t as p_st_s,
+    p_in_t,
+    p_out_t,
+    p_em_t,
+)
 
 __all__ = (
+    "ode_fsal_t", "p_ode_fsal_t",
+    "ode_stats_t", "p_ode_stats_t",
+    "ode_dense_t", "p_ode_dense_t",
+    "dense_eval",
+    "ode_multi_t", "p_ode_multi_t",
+    "ode_stage_t", "p_ode_stage_t",
+    "ode_stm_t", "p_ode_stm_t",
+    "ivp_t", "p_ivp_t",
     "solve_ivp",
+    "solve_ivp_ctx",
     "solve_ivp_with_euler",
     "solve_ivp_with_verlet",
     "solve_ivp_with_rk4",
     "solve_ivp_with_heuler",
     "solve_ivp_with_dopri",
+    "solve_ivp_with_dop853",
     "solve_ivp_with_beuler",
     "solve_ivp_with_midp",
     "solve_ivp_with_vgl4",
     "solve_ivp_with_vgl6",
+    "solve_ivp_with_abm",
 )
 
 
+class ode_fsal_t(ctypes.Structure):
+    _fields_ = [
+        ("valid", ctypes.c_bool),
+        ("x", ctypes.c_double),
+        ("k", st_t),
+    ]
+
+
+p_ode_fsal_t = ctypes.POINTER(ode_fsal_t)
+
+
+class ode_stats_t(ctypes.Structure):
+    _fields_ = [
+        ("n_accept", ctypes.c_uint64),
+        ("n_reject", ctypes.c_uint64),
+        ("n_fun", ctypes.c_uint64),
+        ("n_iter", ctypes.c_uint64),
+        ("n_jac", ctypes.c_uint64),
+        ("n_fallback", ctypes.c_uint64),
+    ]
+
+
+p_ode_stats_t = ctypes.POINTER(ode_stats_t)
+
+
+ODE_DENSE_SIZE = 7
+
+
+class ode_dense_t(ctypes.Structure):
+    _fields_ = [
+        ("valid", ctypes.c_bool),
+        ("size", ctypes.c_size_t),
+        ("x0", ctypes.c_double),
+        ("x1", ctypes.c_double),
+        ("y0", st_t),
+        ("k", st_t * ODE_DENSE_SIZE),
+        ("weight_fun", ctypes.c_void_p),
+    ]
+
+
+p_ode_dense_t = ctypes.POINTER(ode_dense_t)
+
+
+ODE_MULTI_SIZE = 8
+
+
+class ode_multi_t(ctypes.Structure):
+    _fields_ = [
+        ("size", ctypes.c_size_t),
+        ("x", ctypes.c_double * ODE_MULTI_SIZE),
+        ("q", ctypes.c_double * 4 * ODE_MULTI_SIZE),
+        ("k", st_t * ODE_MULTI_SIZE),
+    ]
+
+
+p_ode_multi_t = ctypes.POINTER(ode_multi_t)
+
+
+ODE_STAGE_SIZE = 3
+
+
+class ode_stage_t(ctypes.Structure):
+    _fields_ = [
+        ("valid", ctypes.c_bool),
+        ("size", ctypes.c_size_t),
+        ("x0", ctypes.c_double),
+        ("x1", ctypes.c_double),
+        ("k", st_t * ODE_STAGE_SIZE),
+    ]
+
+
+p_ode_stage_t = ctypes.POINTER(ode_stage_t)
+
+
+class ode_stm_t(ctypes.Structure):
+    _fields_ = [
+        ("valid", ctypes.c_bool),
+        ("jac", ctypes.c_void_p),
+        ("Phi", ctypes.c_double * ODE_JAC_SIZE * ODE_JAC_SIZE),
+    ]
+
+
+p_ode_stm_t = ctypes.POINTER(ode_stm_t)
+
+
+class ivp_t(ctypes.Structure):
+    _fields_ = [
+        ("size", ctypes.c_size_t),
+        ("cfg", p_cfg_t),
+        ("prev", p_st_s),
+        ("next", p_st_s),
+        ("curr", p_st_s),
+        ("in_", p_in_t),
+        ("out", p_out_t),
+        ("em", p_em_t),
+        ("force_model", ctypes.c_void_p),
+        ("fsal", p_ode_fsal_t),
+        ("stats", p_ode_stats_t),
+        ("dense", p_ode_dense_t),
+        ("multi", p_ode_multi_t),
+        ("stage", p_ode_stage_t),
+        ("jac", ctypes.c_void_p),
+        ("stm", p_ode_stm_t),
+    ]
+
+
+p_ivp_t = ctypes.POINTER(ivp_t)
+
+
+# bool solve_ivp_ctx(
+#     double, const st_t*,
+#     double, st_t* restrict,
+#     ode_meth_t*, ode_fun_t, ode_step_t,
+#     struct ivp_s*)
+libcore.solve_ivp_ctx.argtypes = [
+    ctypes.c_double, p_st_t,
+    ctypes.c_double, p_st_t,
+    ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p,
+    p_ivp_t
+]
+libcore.solve_ivp_ctx.restype = ctypes.c_bool
+def solve_ivp_ctx(
+    x0: float, y0, x1: float, y1,
+    meth: typing.Optional[typing.Any],
+    fun, step, ivp: ivp_t
+) -> bool:
+    y0 = st_t.from_buffer(y0)
+    y1 = st_t.from_buffer(y1)
+    return libcore.solve_ivp_ctx(
+        x0, ctypes.byref(y0), x1, ctypes.byref(y1),
+        meth, fun, step,
+        ctypes.byref(ivp)
+    )
+
+
+# bool ode_dense_eval(const struct ode_dense_s*, double, st_t* restrict)
+libcore.ode_dense_eval.argtypes = [p_ode_dense_t, ctypes.c_double, p_st_t]
+libcore.ode_dense_eval.restype = ctypes.c_bool
+def dense_eval(dense: ode_dense_t, x: float):
+    y = st_t()
+    if not libcore.ode_dense_eval(ctypes.byref(dense), x, ctypes.byref(y)):
+        raise ValueError
+    return y
+
+
 # bool solve_ivp(
 #     double, const st_t*,
 #     double, st_t* restrict,
@@ -102,6 +266,19 @@ def solve_ivp_with_dopri(
     )
 
 
+def solve_ivp_with_dop853(
+    x0: float, y0: st_t,
+    x1: float, y1: st_t,
+    fun, nargs, *vargs
+) -> bool:
+    meth = libcore._ode_dop853
+    return solve_ivp(
+        x0, y0, x1, y1,
+        meth, fun, libcore.adjust_time_step,
+        nargs, *vargs
+    )
+
+
 def solve_ivp_with_beuler(
     x0: float, y0: st_t,
     x1: float, y1: st_t,
@@ -141,3 +318,24 @@ def solve_ivp_with_vgl6(
     meth = libcore._ode_vgl6
     return solve_ivp(x0, y0, x1, y1, meth, fun, None, nargs, *vargs)
     
+
+
+def solve_ivp_with_abm(
+    x0: float, y0: st_t,
+    x1: float, y1: st_t,
+    fun, ivp: ivp_t, N: int = 2 * ODE_MULTI_SIZE
+) -> bool:
+    # `N` fixed steps, the history (`ivp.multi`) fills up on the first ones
+    meth = ctypes.cast(libcore._ode_abm, ctypes.c_void_p)
+    delta_x, y = (x1 - x0) / N, numpy.array(y0, dtype=numpy.float64)
+    for n in range(N):
+        z = y.copy()
+        if not solve_ivp_ctx(
+            x0 + n * delta_x, y, x0 + (n + 1) * delta_x, z,
+            meth, fun, None, ivp
+        ):
+            return False
+        z[3:7] /= numpy.linalg.norm(z[3:7])  # as `solve_vehicle_model`
+        y = z
+    numpy.frombuffer(st_t.from_buffer(y1))[:] = y
+    return True
@@ -2,7 +2,8 @@
 import ctypes
 
 # external libraries
-# ...
+import numpy
+import numpy.ctypeslib
 
 # internal libraries
 from . import libgee
@@ -10,7 +11,7 @@ from .vehicle_model import (
     cfg_t, p_cfg_t,
     st_t, p_st_t,
     in_t, p_in_t,
-    p_out_t,
+    out_t, p_out_t,
     p_em_t,
 )
 
@@ -20,7 +21,7 @@ __all__ = (
     "A_G0", "A_M0", "A_T0", "A_P0",
     "A_G7", "A_M7", "A_T7",
     "atm_t", "p_atm_t",
-    "eval", "stdatm",
+    "model", "eval", "eval_n", "stdatm",
 )
 
 # constants
@@ -39,6 +40,7 @@ class atm_t(ctypes.Structure):
         ("th", ctypes.c_double),
         ("p", ctypes.c_double),
         ("rho", ctypes.c_double),
+        ("rho_z", ctypes.c_double),
     ]
 
 
@@ -49,7 +51,17 @@ p_atm_t = ctypes.POINTER(atm_t)
 libgee.stdatm_init()
 
 
-# bool stdatm_eval(struct atm_s*)
+# bool stdatm_model(double, struct atm_s*)
+libgee.stdatm_model.argtypes = [ctypes.c_double, p_atm_t]
+libgee.stdatm_model.restype = ctypes.c_bool
+def model(z: float) -> atm_t:
+    atm = atm_t()
+    if not libgee.stdatm_model(z, ctypes.byref(atm)):
+        raise OverflowError
+    return atm
+
+
+# bool stdatm_eval(double, struct atm_s*)
 libgee.stdatm_eval.argtypes = [ctypes.c_double, p_atm_t]
 libgee.stdatm_eval.restype = ctypes.c_bool
 def eval(z: float) -> atm_t:
@@ -59,6 +71,17 @@ def eval(z: float) -> atm_t:
     return atm
 
 
+# bool stdatm_eval_n(size_t, double*, struct atm_s*)
+libgee.stdatm_eval_n.argtypes = [ctypes.c_size_t, ctypes.c_void_p, p_atm_t]
+libgee.stdatm_eval_n.restype = ctypes.c_bool
+def eval_n(z_lst: numpy.ndarray) -> ctypes.Array:
+    z_lst = numpy.ascontiguousarray(z_lst, dtype=numpy.float64)
+    atm_lst = (atm_t * len(z_lst))()
+    if not libgee.stdatm_eval_n(len(z_lst), z_lst.ctypes.data, atm_lst):
+        raise OverflowError
+    return atm_lst
+
+
 # bool stdatm(size_t, struct cfg_s*, struct st_s*,
 #             struct in_s*, struct out_s*, struct em_s*)
 libgee.stdatm.argtypes = [
@@ -70,7 +93,7 @@ def stdatm(size: int, cfg: cfg_t, st: st_t, in_: in_t):
         ctypes.byref(cfg),
         ctypes.byref(st),
         ctypes.byref(in_),
-        None,
+        ctypes.byref(out_t()),
         None
     ):
         raise ZeroDivisionError
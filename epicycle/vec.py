@@ -17,6 +17,7 @@ __all__ = (
     "cross_mat",
     "exp",
     "rot", "irot",
+    "rot_n", "irot_n",
 )
 
 
@@ -123,3 +124,20 @@ def irot(q, u_bar):
     libmath.vec_irot(q, u_bar, v_bar)
     return v_bar
 
+
+# void vec_rot_n(quat_t*, size_t, vec_t*, vec_t*)
+p_vec_n_t = numpy.ctypeslib.ndpointer(
+    dtype=numpy.float64, ndim=2, flags="C")
+libmath.vec_rot_n.argtypes = [p_quat_t, ctypes.c_size_t, p_vec_n_t, p_vec_n_t]
+def rot_n(q, u_bar):
+    v_bar = numpy.empty(u_bar.shape, dtype=numpy.float64)
+    libmath.vec_rot_n(q, len(u_bar), u_bar, v_bar)
+    return v_bar
+
+
+# void vec_irot_n(quat_t*, size_t, vec_t*, vec_t*)
+libmath.vec_irot_n.argtypes = [p_quat_t, ctypes.c_size_t, p_vec_n_t, p_vec_n_t]
+def irot_n(q, u_bar):
+    v_bar = numpy.empty(u_bar.shape, dtype=numpy.float64)
+    libmath.vec_irot_n(q, len(u_bar), u_bar, v_bar)
+    return v_bar
@@ -7,7 +7,7 @@ import enum
 import numpy
 
 # internal libraries
-from . import MAX_OBJ_COUNT
+from . import MAX_OBJ_COUNT, G_DEG, G_ORD
 from .vec import vec_t
 from .quat import quat_t
 from .mat import mat_t
@@ -21,6 +21,7 @@ __all__ = (
     "in_t", "p_in_t",
     "out_t", "p_out_t",
     "em_t", "p_em_t",
+    "stm_t", "p_stm_t",
     "vehicle_model_t", "p_vehicle_model_t",
 )
 
@@ -44,11 +45,32 @@ class cfg_t(ctypes.Structure):
             ("r_bar", vec_t),
             ("q", quat_t),
         ]
+
+    class drv_t(ctypes.Structure):
+
+        class obj_t(ctypes.Structure):
+            _fields_ = [
+                ("q", quat_t),
+                ("r_bar", vec_t),
+                ("bbox", dmat_t),
+                ("R", mat_t),
+                ("S", mat_t),
+                ("K", mat_t),
+            ]
+
+        _fields_ = [
+            ("size", ctypes.c_size_t),
+            ("n", ctypes.c_ulonglong),
+            ("K", mat_t),
+            ("L", mat_t),
+            ("obj_lst", obj_t * MAX_OBJ_COUNT),
+        ]
     
     _fields_ = [
         ("clk", clk_t),
         ("sys", sys_t),
         ("obj_lst", obj_t * MAX_OBJ_COUNT),
+        ("drv", drv_t),
     ]
 
 
@@ -156,10 +178,39 @@ class in_t(ctypes.Structure):
             ("F_bar", vec_t),
             ("M_bar", vec_t),
         ]
+
+    class env_t(ctypes.Structure):
+
+        class key_t(ctypes.Structure):
+            _fields_ = [
+                ("t", ctypes.c_double),
+                ("r_bar", vec_t),
+                ("q", quat_t),
+                ("c_bar", vec_t),
+            ]
+
+        _fields_ = [
+            ("flags", ctypes.c_uint),
+            ("key", key_t),
+            ("q_i2f", quat_t),
+            ("r_bar", vec_t),
+            ("r", ctypes.c_double),
+            ("a", ctypes.c_double),
+            ("x", ctypes.c_double),
+            ("y", ctypes.c_double),
+            ("z", ctypes.c_double),
+            ("R", ctypes.c_double * (max(G_DEG, 2) + 1)),
+            ("P", ctypes.c_double * ((G_DEG + 1) * (G_DEG + 2) // 2)),
+            ("Q", ctypes.c_double * ((G_DEG + 1) * (G_DEG + 2) // 2)),
+            ("C", ctypes.c_double * (G_ORD + 1)),
+            ("S", ctypes.c_double * (G_ORD + 1)),
+            ("alt", ctypes.c_double),
+        ]
     
     _fields_ = [
         ("sys", sys_t),
         ("obj_lst", obj_t * MAX_OBJ_COUNT),
+        ("env", env_t),
     ]
 
 
@@ -170,10 +221,30 @@ class out_t(ctypes.Structure):
             ("m", ctypes.c_double),
             ("c_bar", vec_t),
             ("I_cm", mat_t),
+            ("L_cm", mat_t),
+            ("chol", ctypes.c_bool),
+        ]
+
+    class acc_t(ctypes.Structure):
+
+        class obj_t(ctypes.Structure):
+            _fields_ = [
+                ("m", ctypes.c_double),
+                ("I_cm", dmat_t),
+            ]
+
+        _fields_ = [
+            ("size", ctypes.c_size_t),
+            ("n", ctypes.c_ulonglong),
+            ("gen", ctypes.c_ulonglong),
+            ("m_bar", vec_t),
+            ("I_bar", mat_t),
+            ("obj_lst", obj_t * MAX_OBJ_COUNT),
         ]
     
     _fields_ = [
         ("sys", sys_t),
+        ("acc", acc_t),
     ]
 
 
@@ -201,6 +272,17 @@ class em_t(ctypes.Structure):
     ]
 
 
+ODE_JAC_SIZE = 12
+
+
+class stm_t(ctypes.Structure):
+    _fields_ = [
+        ("valid", ctypes.c_bool),
+        ("t", ctypes.c_double),
+        ("Phi", ctypes.c_double * ODE_JAC_SIZE * ODE_JAC_SIZE),
+    ]
+
+
 class vehicle_model_t(ctypes.Structure):
     _fields_ = [
         ("size", ctypes.c_size_t),
@@ -210,6 +292,7 @@ class vehicle_model_t(ctypes.Structure):
         ("in_", in_t),
         ("out", out_t),
         ("em", em_t),
+        ("stm", stm_t),
     ]
 
 
@@ -267,5 +350,6 @@ p_ch_t = ctypes.POINTER(ch_t)
 p_in_t = ctypes.POINTER(in_t)
 p_out_t = ctypes.POINTER(out_t)
 p_em_t = ctypes.POINTER(em_t)
+p_stm_t = ctypes.POINTER(stm_t)
 p_vehicle_model_t = ctypes.POINTER(vehicle_model_t)
 
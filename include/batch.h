@@ -0,0 +1,82 @@
+
+#ifndef __BATCH_H__
+#define __BATCH_H__
+
+/* Batch propagation library
+ * -------------------------
+ */
+
+/* Internal libraries */
+#include "vehicle_model.h"
+#include "force_model.h"
+#include "ode.h"
+
+/* Built-in libraries */
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Data types */
+struct batch_s {  // per-vehicle propagation workspace
+    struct st_s swap[3];
+    struct st_s* prev;
+    struct st_s* next;
+    struct st_s* curr;
+    struct ode_fsal_s fsal;  // derivative at `next` (see `ode_fsal_s`)
+    struct ode_stats_s stats;  // integration counters
+    struct ode_dense_s dense;  // dense output of the step `prev` to `next`
+    struct ode_multi_s multi;  // multistep history up to `prev`
+    struct ode_stage_s stage;  // implicit stages of the last step
+    struct ode_stm_s stm;  // state transition matrix of the steps taken
+};
+
+/* Initialize batch workspace
+ * :param size_t N: number of vehicles
+ * :param vehicle_model_s* vehicle_model: vehicle model array
+ * :param batch_s* batch: workspace array
+ */
+void batch_init(
+    size_t N,
+    const struct vehicle_model_s[static N],
+    struct batch_s[static N]
+);
+
+/* Solve vehicle model
+ * :param vehicle_model_s* vehicle_model: vehicle model
+ * :param batch_s* batch: workspace
+ * :param ode_meth_t meth: integration function
+ * :param force_model_s* force_model: force model
+ *
+ * Advances the vehicle model to the requested change time (`ch->clk.t`),
+ * interpolates its state there and applies any pending changes.
+ *
+ * While `stm.valid` is set, also propagates `stm.Phi` with every step
+ * (with `force_model->jac_fun`, or `jacobian_force_model`), so that it
+ * maps tangent space perturbations (see `ODE_JAC_SIZE`) of the state it
+ * was set at to the end of the last step, `stm.t`. Methods without
+ * variational equations and pending changes (which restart the
+ * integration from the interpolated state) clear it.
+ */
+void solve_vehicle_model(
+    struct vehicle_model_s* restrict,
+    struct batch_s* restrict,
+    ode_meth_t,
+    const struct force_model_s*
+);
+
+/* Solve batch of vehicle models
+ * :param size_t N: number of vehicles
+ * :param double t: target time
+ * :param vehicle_model_s* vehicle_model: vehicle model array
+ * :param batch_s* batch: workspace array
+ * :param ode_meth_t meth: integration function
+ * :param force_model_s* force_model: force model
+ */
+void solve_batch(
+    size_t N, double,
+    struct vehicle_model_s[static restrict N],
+    struct batch_s[static restrict N],
+    ode_meth_t,
+    const struct force_model_s*
+);
+
+#endif  // __BATCH_H__
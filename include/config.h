@@ -1,4 +1,5 @@
 #ifndef __CONFIG_H__
+#define __CONFIG_H__
 
 /* Configuration items
  * --------------------
@@ -8,6 +9,12 @@
 #define ABSTOL 1.48e-8
 #define RELTOL 1.22e-4
 
+#define MAX_THREAD_COUNT 64
+#define MAX_DELTA_COUNT 1024  // incremental updates between full recomputes
+
+#define G_DEG 4  // built-in harmonics degree (`geopot`, `geomag`)
+#define G_ORD 4  // built-in harmonics order
+
 #define NOISE_LEVEL 20
 #define FILE_NAME "/my.shm"
 
@@ -6,29 +6,71 @@
 
 /* External libraries */
 #include <stddef.h>
-#include <stdarg.h>
 
 /* Internal libraries */
 #include "vehicle_model.h"
 #include "ode.h"
 #include "st.h"
+#include "vec.h"
+#include "quat.h"
+#include "mat.h"
+#include "simd.h"
 #include "config.h"
 
 /* Data types */
+typedef bool (*force_fun_t) (
+    size_t,
+    const struct cfg_s*,
+    const struct st_s*,
+    struct in_s* restrict,
+    const struct out_s*,
+    struct em_s* restrict
+);
+
+/* Force function partials
+ * Columns follow the tangent space of `ODE_JAC_SIZE` (r, th, v, om), rows
+ * the inertial force and body torque the force function adds to `in_s`.
+ */
+struct jac_s {
+    double F_bar[3][ODE_JAC_SIZE];  // force (inertial)
+    double M_bar[3][ODE_JAC_SIZE];  // torque (body)
+};
+
+typedef bool (*force_jac_t) (
+    size_t,
+    const struct cfg_s*,
+    const struct st_s*,
+    struct jac_s* restrict,
+    const struct out_s*,
+    const struct em_s*
+);
+
 struct force_model_s {
     size_t size;
     ode_fun_t accum_fun;
     ode_step_t step_fun;
-    bool (*fun_lst[16])(
-        size_t,
-        const struct cfg_s*,
-        const struct st_s*,
-        struct in_s* restrict,
-        const struct out_s*,
-        struct em_s* restrict
-    );
+    ode_jac_t jac_fun;
+    force_fun_t fun_lst[16];
+    force_jac_t jac_lst[16];
 };
 
+/* Accumulate partials block
+ * :param double D: input/output partials (`jac_s` rows)
+ * :param size_t j: first column
+ * :param mat_t A: input block, added to columns `j` to `j + 2`
+ */
+static inline
+void
+jac_add(
+    double D[3][ODE_JAC_SIZE],
+    size_t j,
+    const mat_t A
+) {
+    for (size_t i = 0; i < 3; i++)
+        for (size_t k = 0; k < 3; k++)
+            D[i][j + k] += A[i][k];
+}
+
 /* Interpolate state
  * :param size_t size:
  * :param st_t* prev: previous state structure
@@ -119,11 +161,63 @@ void solve_in(
     const struct out_s*
 );
 
+/* Solve derived configuration
+ * :param size_t size:
+ * :param cfg_t* cfg: configuration structure
+ * :returns bool: derived configuration changed
+ *
+ * Rebuilds the rotation matrix, parallel-axis term and drag matrix of
+ * every object whose attitude, position or bounding box changed since the
+ * last call, then the drag sums; call after the configuration is written
+ * (once per request, not per evaluation).
+ */
+bool solve_cfg(
+    size_t,
+    struct cfg_s* restrict
+);
+
+/* Match derived configuration
+ * :param size_t size:
+ * :param cfg_t* cfg: configuration structure
+ * :returns bool: `cfg->drv` was solved for exactly these objects
+ *
+ * The derived configuration is only a cache; its users check it against
+ * the configuration and fall back to solving in place when it is stale.
+ */
+bool match_cfg(
+    size_t,
+    const struct cfg_s*
+);
+
+/* Solve drag matrices
+ * :param size_t size:
+ * :param cfg_t* cfg: configuration structure
+ * :param mat_t K: drag matrix
+ * :param mat_t L: drag torque matrix
+ *
+ * Every bounding box face sees a force `- rho v (v_bar . n) A n` (body
+ * frame), so the body force and torque are `- rho v K v_bar` and
+ * `- rho v L v_bar`. Uses the derived configuration of the objects it
+ * covers, where it is current.
+ */
+void solve_drag(
+    size_t,
+    const struct cfg_s*,
+    mat_t,
+    mat_t
+);
+
 /* Solve output structure
  * :param size_t size:
  * :param cfg_t* cfg: configuration structure
  * :param st_t* st: state structure
  * :param out_t* out: output structure
+ *
+ * Keeps running sums in `out->acc` and only applies the difference for
+ * objects whose mass properties changed since the last call; the sums are
+ * rebuilt from scratch when the object count or derived configuration
+ * changes (or no longer matches the configuration), and after `MAX_DELTA_COUNT` incremental updates. The Cholesky
+ * factor of `I_cm` is only refreshed when the sums change.
  */
 void solve_out(
     size_t,
@@ -152,38 +246,165 @@ void solve_em(
  * :param em_t* out: electromagnetic structure
  * :returns bool:
  */
-bool em(
+SIMD_INLINE
+bool
+em(
+    size_t size __attribute__((unused)),
+    const struct cfg_s* cfg __attribute__((unused)),
+    const struct st_s* st,
+    struct in_s* restrict in,
+    const struct out_s* out __attribute__((unused)),
+    struct em_s* restrict em
+) {
+    LOG_STATS("em", 0, 0, 0);
+    vec_t foo, bar;
+    vec_cross(st->sys.v_bar, em->sys.B_bar, foo);
+    vec_add(em->sys.E_bar, foo, foo);
+    vec_muls(foo, em->sys.q, foo);
+    vec_add(in->sys.F_bar, foo, in->sys.F_bar);
+    vec_rot(st->sys.q, em->sys.p_bar, foo);
+    vec_cross(foo, em->sys.E_bar, bar);
+    vec_add(in->sys.M_bar, bar, in->sys.M_bar);
+    vec_rot(st->sys.q, em->sys.m_bar, foo);
+    vec_cross(foo, em->sys.B_bar, bar);
+    vec_add(in->sys.M_bar, bar, in->sys.M_bar);
+    return true;
+}
+
+/* Lorentz force partials
+ * :param size_t size:
+ * :param cfg_t* cfg: configuration structure
+ * :param st_t* st: state structure
+ * :param jac_t* jac: partials structure
+ * :param out_t* out: output structure
+ * :param em_t* out: electromagnetic structure
+ * :returns bool:
+ *
+ * The fields are treated as constant (their gradients are neglected).
+ */
+bool em_jac(
     size_t,
     const struct cfg_s*,
     const struct st_s*,
-    struct in_s* restrict,
+    struct jac_s* restrict,
     const struct out_s*,
-    struct em_s* restrict
+    const struct em_s*
 );
 
 /* Apply force model
  * :param double x:
  * :param st_t* y: input position state
  * :param st_t* f: output force state
- * :param size_t nargs: number of arguments
- * :param va_list* vargs: variadic arguments
+ * :param ivp_s* ivp: propagation context
  */
 void apply_force_model(
     double, const st_t*, st_t* restrict,
-    size_t, va_list*
+    struct ivp_s*
+);
+
+/* Force model Jacobian
+ * :param double x:
+ * :param st_t* y: input position state
+ * :param st_t* k: (optional) output force state, as `apply_force_model`
+ * :param double J: output Jacobian (tangent space, see `ODE_JAC_SIZE`)
+ * :param ivp_s* ivp: propagation context
+ *
+ * Kinematic and rigid-body (gyroscopic) terms, plus the partials of every
+ * force function with a `jac_lst` entry; the force and torque of force
+ * functions without one are held constant (the force in the inertial frame,
+ * the torque about the centre of mass in the body frame).
+ */
+void jacobian_force_model(
+    double, const st_t*, st_t* restrict, double [ODE_JAC_SIZE][ODE_JAC_SIZE],
+    struct ivp_s*
 );
 
+/* Begin force model evaluation
+ * :param double x:
+ * :param st_t* y: input position state
+ * :param ivp_s* ivp: propagation context
+ */
+static inline
+void
+begin_force_model(
+    double x,
+    const st_t* y,
+    struct ivp_s* ivp
+) {
+    struct st_s* restrict st = ivp->curr;
+    // copy `st_s` from input `g_vec`
+    st->clk.t = x;
+    memcpy(&st->sys, y, sizeof(st_t));
+    interp_obj_lst(ivp->size, ivp->prev, ivp->next, st);
+    // XXX reset force/torque first
+    vec_zero(ivp->in->sys.F_bar);
+    vec_zero(ivp->in->sys.M_bar);
+    vec_zero(ivp->em->sys.E_bar);
+    vec_zero(ivp->em->sys.B_bar);
+    solve_out(ivp->size, ivp->cfg, st, ivp->out);
+}
+
+/* End force model evaluation
+ * :param st_t* f: output force state
+ * :param ivp_s* ivp: propagation context
+ */
+static inline
+void
+end_force_model(
+    st_t* restrict f,
+    struct ivp_s* ivp
+) {
+    const struct st_s* st = ivp->curr;
+    struct in_s* restrict in = ivp->in;
+    solve_in(ivp->size, ivp->cfg, st, in, ivp->out);
+    // copy `in_s` from output `g_vec`
+    vec_pos(st->sys.v_bar, f->r_bar);
+    vec_muls(st->sys.om_bar, 0.5, &f->q[1]);
+    vec_exp(&f->q[1], f->q);
+    vec_pos(in->sys.v_dot, f->v_bar);
+    vec_pos(in->sys.om_dot, f->om_bar);
+}
+
+/* Fused force models
+ * ------------------
+ * `FUNCTION_FORCE_MODEL_FUSED(name, ...)` defines an accumulator function
+ * equivalent to `apply_force_model` with a fixed list of force functions,
+ * called directly (and inlined where visible) instead of through `fun_lst`.
+ * Force functions are applied with `FORCE_MODEL_APPLY(fun)`, e.g.
+ *
+ *     FUNCTION_FORCE_MODEL_FUSED(geoall_em,
+ *         FORCE_MODEL_APPLY(geoall);
+ *         FORCE_MODEL_APPLY(em);
+ *     )
+ */
+#define FORCE_MODEL_NAME(name) _force_model_##name
+#define FORCE_MODEL_PARAMS (\
+    double x,\
+    const st_t* y,\
+    st_t* restrict f,\
+    struct ivp_s* ivp\
+)
+#define FUNCTION_FORCE_MODEL(name) void FORCE_MODEL_NAME(name) FORCE_MODEL_PARAMS
+#define FUNCTION_FORCE_MODEL_FUSED(name, ...) FUNCTION_FORCE_MODEL(name) {\
+    LOG_STATS("force_model_" #name, 0, 0, 0);\
+    begin_force_model(x, y, ivp);\
+    __VA_ARGS__\
+    end_force_model(f, ivp);\
+}
+#define FORCE_MODEL_APPLY(fun) fun(\
+    ivp->size, ivp->cfg, ivp->curr, ivp->in, ivp->out, ivp->em\
+)
+
 /* Adjust time step
  * :param st_t* y0: (first) input state
  * :param st_t* y1: (second) input state
  * :param st_t* y2: (third) input state
  * :param int q: integration order
- * :param size_t nargs: number of arguments
- * :param va_list* vargs: variadic arguments
+ * :param ivp_s* ivp: propagation context
  */
 bool adjust_time_step(
     const st_t*, const st_t*, const st_t*,
-    int, size_t, va_list*
+    int, struct ivp_s*
 );
 
 #endif  // __FORCE_MODEL_H__
@@ -0,0 +1,25 @@
+#ifndef __FUSED_H__
+#define __FUSED_H__
+
+/* Fused force model library
+ * -------------------------
+ * Specialized accumulator functions for common force model combinations
+ * (see `FUNCTION_FORCE_MODEL_FUSED`).
+ */
+
+/* Internal libraries */
+#include "force_model.h"
+#include "ode.h"
+
+FUNCTION_FORCE_MODEL(gee_fast);         // gee_fast
+FUNCTION_FORCE_MODEL(gee_fast_stdatm);  // gee_fast, stdatm
+FUNCTION_FORCE_MODEL(geoall_em);        // geoall, em
+
+/* Select force model accumulator
+ * :param force_model_s* force_model: force model
+ * :returns ode_fun_t: fused accumulator matching the (non-null) force
+ *     functions, in order, otherwise `apply_force_model`
+ */
+ode_fun_t select_force_model(const struct force_model_s*);
+
+#endif  // __FUSED_H__
@@ -8,22 +8,33 @@
 /* Internal libraries */
 #include "vehicle_model.h"
 #include "quat.h"
+#include "mat.h"
+#include "simd.h"
 
 /* Built-in libraries */
 #include <stddef.h>
 #include <stdbool.h>
 
+/* Data types */
+struct jac_s;
+
 /* Constants */
 #define G_MU 3986004.415E+8
 #define G_RMAX 6378136.3
 #define G_RMIN 6356766.0
 #define G_INVF 298.4579673659263
-#define G_DEG 4
-#define G_ORD 4
+
+/* Environment parts (`env_s.flags`) */
+#define ENV_FRAME 0x1  // ECEF frame and position
+#define ENV_HARM 0x2  // spherical harmonics
+#define ENV_ALT 0x4  // geodetic altitude
 
 /* ECI to ECEF quaternion
  * :param st_t* st: state structure
  * :param quat_t* curr: output quaternion
+ *
+ * Cached per thread on `st->clk.t`, so it is computed once per step time
+ * for all the vehicles of a batch.
  */
 void gee_quat_i2f(const struct st_s*, quat_t);
 
@@ -32,10 +43,21 @@ void gee_quat_i2f(const struct st_s*, quat_t);
  * :param double* lat: geodetic latitude
  * :param double* lon: longitude
  * :param double* alt: geodetic altitude
- * :returns bool: solution converged
+ * :returns bool: false at the center
+ *
+ * Closed form (no iteration), outputs may be NULL.
  */
 bool gee_f2d(const vec_t, double*, double*, double*);
 
+/* ECEF to geodetic (batch)
+ * :param size_t n: number of vectors
+ * :param vec_t* r_lst: input vectors (not at the center)
+ * :param double* lat: geodetic latitudes
+ * :param double* lon: longitudes
+ * :param double* alt: geodetic altitudes
+ */
+void gee_f2d_n(size_t, const vec_t[], double[], double[], double[]);
+
 /* Inverse square law
  * :param vec_t* st: input vector
  * :param double* r__2: square of distance
@@ -50,6 +72,31 @@ void sph_harm(
     double*, double*, double*, double*, double*
 );
 
+/* Spherical coordinates and harmonics
+ * :param vec_t* r_bar: input position (ECEF)
+ * :param env_s* env: output environment (coordinates and harmonics)
+ * :returns bool:
+ */
+bool gee_sph(const vec_t, struct env_s* restrict);
+
+/* Earth environment
+ * :param st_t* st: state structure
+ * :param out_t* out: output structure
+ * :param in_t* in: input structure (holding the environment)
+ * :param unsigned flags: required parts (`ENV_*`)
+ * :returns env_s*: environment, NULL at the origin
+ *
+ * Parts are computed at the center of mass once per state, and shared by
+ * the force functions; they are recomputed when the time, position,
+ * attitude or center of mass differs from `in->env.key`.
+ */
+const struct env_s* gee_env(
+    const struct st_s*,
+    const struct out_s*,
+    struct in_s* restrict,
+    unsigned
+);
+
 /* Gravity force model
  * :param size_t size:
  * :param cfg_t* cfg: configuration structure
@@ -77,13 +124,64 @@ bool gee(
  * :param em_t* em: electromagnetic structure
  * :returns bool:
  */
-bool gee_fast(
+SIMD_INLINE
+bool
+gee_fast(
+    size_t size __attribute__((unused)),
+    const struct cfg_s* cfg __attribute__((unused)),
+    const struct st_s* st,
+    struct in_s* restrict in,
+    const struct out_s* out,
+    struct em_s* restrict em __attribute__((unused))
+) {
+    LOG_STATS("gee_fast", 2, 2, 0);
+    vec_t r_bar, foo, bar;
+    vec_irot(st->sys.q, st->sys.r_bar, r_bar);
+    vec_add(r_bar, out->sys.c_bar, r_bar);
+    // gravity
+    double r__2, g;
+    if (!inv_sq_law(r_bar, &r__2, &g))
+        return false;
+    // point mass
+    vec_muls(r_bar, - out->sys.m * g, foo);
+    vec_cross(out->sys.c_bar, foo, bar);
+    vec_add(in->sys.M_bar, bar, in->sys.M_bar);
+    vec_rot(st->sys.q, foo, bar);
+    vec_add(in->sys.F_bar, bar, in->sys.F_bar);
+    // rigid body
+    mat_mulv((void*) out->sys.I_cm, r_bar, foo);
+    vec_cross(r_bar, foo, bar);
+    vec_muls(bar, 3.0 * g / r__2, bar);
+    vec_add(in->sys.M_bar, bar, in->sys.M_bar);
+    return true;
+}
+
+/* Point mass gravity gradient
+ * :param double m: mass
+ * :param vec_t r_bar: input position
+ * :param mat_t G: output gradient (of the force, `- m g r_bar`)
+ * :returns bool:
+ */
+bool gee_grad(double, const vec_t, mat_t);
+
+/* Gravity force model (fast) partials
+ * :param size_t size:
+ * :param cfg_t* cfg: configuration structure
+ * :param st_t* st: state structure
+ * :param jac_t* jac: partials structure
+ * :param out_t* out: output structure
+ * :param em_t* em: electromagnetic structure
+ * :returns bool:
+ *
+ * Point mass (force and offset torque) and gravity-gradient torque.
+ */
+bool gee_fast_jac(
     size_t,
     const struct cfg_s*,
     const struct st_s*,
-    struct in_s* restrict,
+    struct jac_s* restrict,
     const struct out_s*,
-    struct em_s* restrict
+    const struct em_s*
 );
 
 /* Evalute geopotential and geomagnetic force model */
@@ -13,6 +13,18 @@
 #include <stdbool.h>
 #include <math.h>
 
+/* Constants */
+#define G_NMAX 360  // largest degree (and order) of a loaded model
+#define G_EGM_STEP 1.0  // central difference step of `geopot_egm_grad` (m)
+
+/* Data types */
+struct egm_s {  // loaded coefficient (by order, then degree)
+    double C;   // normalized cosine coefficient (`S` adjacent, SSE2 pair)
+    double S;   // normalized sine coefficient
+    double a;   // recursion constant (of P_n-1,m)
+    double b;   // recursion constant (of P_n-2,m)
+};
+
 extern const double Jg[(G_DEG+1)*(G_DEG+2)/2][2];
 extern const double Kg[(G_DEG+1)*(G_DEG+2)/2];
 
@@ -30,5 +42,100 @@ bool geopot_eval(double, const vec_t, vec_t);
  */
 bool geopot(size_t, const struct cfg_s*, const struct st_s*, struct in_s* restrict, const struct out_s*, struct em_s* restrict);
 
+/* Load geopotential model
+ * :param char* file_name: coefficient file
+ * :param size_t deg: degree
+ * :param size_t ord: order
+ * :returns bool: file read, `deg` and `ord` at most `G_NMAX`
+ *
+ * EGM-style fully normalized coefficients, one `n m C S` row per line
+ * (further columns, ICGEM `gfc` keys and Fortran `D` exponents allowed);
+ * other lines are skipped, as are degrees 0 and 1 (left to `gee`). The
+ * ICGEM `earth_gravity_constant` and `radius` override `G_MU`, `G_RMAX`.
+ * Not thread-safe, load before propagating.
+ */
+bool geopot_load(const char*, size_t, size_t);
+
+/* Truncate geopotential model
+ * :param size_t deg: degree
+ * :param size_t ord: order
+ * :returns bool: within the loaded model
+ */
+bool geopot_trunc(size_t, size_t);
+
+/* Evaluate geopotential force model (loaded)
+ * :param double m: mass
+ * :param vec_t r_bar: input position (ECEF)
+ * :param vec_t F_bar: output force (ECEF)
+ * :returns bool:
+ *
+ * Holmes and Featherstone (2002): forward column recursion of the
+ * modified functions P_nm / cos(phi)^m, summed over the orders by Horner's
+ * scheme in cos(phi); stable to high degree and regular at the poles.
+ */
+bool geopot_egm_eval(double, const vec_t, vec_t);
+
+/* Geopotential force model (loaded)
+ * :param size_t size:
+ * :param cfg_t* cfg: configuration structure
+ * :param st_t* st: state structure
+ * :param in_t* in: input structure
+ * :param out_t* out: output structure
+ * :param em_t* em: electromagnetic structure
+ * :returns bool:
+ *
+ * See `geopot_load`; partials in `geopot_egm_jac`.
+ */
+bool geopot_egm(size_t, const struct cfg_s*, const struct st_s*, struct in_s* restrict, const struct out_s*, struct em_s* restrict);
+
+/* Geopotential gravity gradient (loaded)
+ * :param double m: mass
+ * :param vec_t r_bar: input position (ECEF)
+ * :param mat_t G: output gradient (of the `geopot_egm_eval` force, ECEF)
+ * :returns bool:
+ *
+ * Central differences of `geopot_egm_eval` (step `G_EGM_STEP`); six
+ * evaluations, meant for the Newton iterations of the implicit solvers.
+ */
+bool geopot_egm_grad(double, const vec_t, mat_t);
+
+/* Geopotential gravity gradient
+ * :param double m: mass
+ * :param vec_t r_bar: input position (ECEF)
+ * :param mat_t G: output gradient (of the `geopot_eval` force, ECEF)
+ * :returns bool:
+ *
+ * Second derivatives of the (unnormalized) Cunningham harmonics `V_nm`,
+ * `W_nm`, recursed to degree `G_DEG + 2`.
+ */
+bool geopot_grad(double, const vec_t, mat_t);
+
+/* Geopotential force model partials
+ * :param size_t size:
+ * :param cfg_t* cfg: configuration structure
+ * :param st_t* st: state structure
+ * :param jac_t* jac: partials structure
+ * :param out_t* out: output structure
+ * :param em_t* em: electromagnetic structure
+ * :returns bool:
+ *
+ * Also used for `geoall` (the gradient of `B_bar` is neglected). The Earth
+ * rotation over the step is neglected.
+ */
+bool geopot_jac(size_t, const struct cfg_s*, const struct st_s*, struct jac_s* restrict, const struct out_s*, const struct em_s*);
+
+/* Geopotential force model partials (loaded)
+ * :param size_t size:
+ * :param cfg_t* cfg: configuration structure
+ * :param st_t* st: state structure
+ * :param jac_t* jac: partials structure
+ * :param out_t* out: output structure
+ * :param em_t* em: electromagnetic structure
+ * :returns bool:
+ *
+ * As `geopot_jac`, with the gradient of `geopot_egm_grad`.
+ */
+bool geopot_egm_jac(size_t, const struct cfg_s*, const struct st_s*, struct jac_s* restrict, const struct out_s*, const struct em_s*);
+
 #endif  // __GEOPOT_H__
 
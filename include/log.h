@@ -24,8 +24,9 @@ enum log_e {
 #ifdef __DEBUG__
 #define LOG_TRACE(...)    LOG(E_TRACE, "01;34", __VA_ARGS__)
 #define LOG_DEBUG(...)    LOG(E_DEBUG, "01;32", __VA_ARGS__)
+// operation counts are per thread, `pool_solve` merges its workers'
 extern clock_t stats_tick, stats_tock;
-extern long stats_total_add, stats_total_mul, stats_total_pow;
+extern __thread long stats_total_add, stats_total_mul, stats_total_pow;
 #define START_CLOCK() stats_tick = clock()
 #define STOP_CLOCK() stats_tock = clock()
 #define LOG_STATS(name, add, mul, pow) (\
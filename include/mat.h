@@ -3,9 +3,13 @@
 
 /* Matrix library
  * --------------
+ * The multiplication kernels are C99 `inline` definitions so callers can
+ * inline them; `mat.c` emits the external definitions.
  */
  
 /* Internal libraries */
+#include "log.h"
+#include "simd.h"
 #include "vec.h"
 
 /* Built-in libraries */
@@ -68,6 +72,20 @@ double mat_det(const mat_t);
  */
 bool mat_inv(const mat_t, mat_t);
 
+/* Cholesky factorization (square-root free, `A = L D L^T`)
+ * :param mat_t A: input (symmetric positive-definite) matrix
+ * :param mat_t L: output unit lower-triangular factor, `D` on the diagonal
+ * :returns bool: positive-definite matrix
+ */
+bool mat_chol(const mat_t, mat_t);
+
+/* Cholesky solution
+ * :param mat_t L: input factor (see `mat_chol`)
+ * :param vec_t u_bar: input vector
+ * :param vec_t v_bar: output vector, solves `A v_bar = u_bar`
+ */
+void mat_chol_solve(const mat_t, const vec_t, vec_t);
+
 /* Matrix transpose
  * :param mat_t A: input matrix
  * :param mat_t A__T: output matrix
@@ -100,7 +118,35 @@ void mat_muls(const mat_t, double, mat_t);
  * :param mat_t B: (second) input matrix
  * :param mat_t C: output matrix
  */
-void mat_mul(const mat_t, const mat_t, mat_t);
+SIMD_INLINE
+void
+mat_mul(
+    const mat_t A,
+    const mat_t B,
+    mat_t C
+) {
+    LOG_STATS("mat_mul", 18, 27, 0);
+    for (int i = 0; i < 3; i++) {
+#if defined SIMD_SSE2
+        __m128d a0 = _mm_set1_pd(A[i][0]),
+                a1 = _mm_set1_pd(A[i][1]),
+                a2 = _mm_set1_pd(A[i][2]),
+                x;
+        x = _mm_mul_pd(a0, _mm_loadu_pd(B[0]));
+        x = _mm_add_pd(x, _mm_mul_pd(a1, _mm_loadu_pd(B[1])));
+        x = _mm_add_pd(x, _mm_mul_pd(a2, _mm_loadu_pd(B[2])));
+        _mm_storeu_pd(C[i], x);
+        C[i][2] = A[i][0] * B[0][2] + A[i][1] * B[1][2] + A[i][2] * B[2][2];
+#else
+        for (int j = 0; j < 3; j++)
+            C[i][j] = (
+                A[i][0] * B[0][j]
+                + A[i][1] * B[1][j]
+                + A[i][2] * B[2][j]
+            );
+#endif
+    }
+}
 
 /* Matrix/vector functions */
 #define vec_imul(u_bar, v_bar) vec_dot(u_bar, v_bar)
@@ -117,7 +163,21 @@ void vec_omul(const vec_t, const vec_t, mat_t);
  * :param vec_t u_bar: input vector
  * :param vec_t v_bar: output vector
  */
-void mat_mulv(const mat_t, const vec_t, vec_t);
+SIMD_INLINE
+void
+mat_mulv(
+    const mat_t A,
+    const vec_t u_bar,
+    vec_t v_bar
+) {
+    LOG_STATS("mat_mulv", 6, 9, 0);
+    double v0 = vec_dot(A[0], u_bar),
+           v1 = vec_dot(A[1], u_bar),
+           v2 = vec_dot(A[2], u_bar);
+    v_bar[0] = v0;
+    v_bar[1] = v1;
+    v_bar[2] = v2;
+}
 
 /* Vector-matrix multiplication
  * :param vec_t u_bar: input vector
@@ -10,7 +10,9 @@
 
 /* Built-in libraries */
 #include <stdarg.h>
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #define ODE_METHOD_NAME(name) _ode_##name
 #define ODE_METHOD_PARAMS (\
@@ -18,12 +20,88 @@
     double x1, st_t* restrict y1,\
     ode_fun_t fun,\
     ode_step_t step __attribute__((unused)),\
-    size_t nargs, va_list* vargs\
+    struct ivp_s* ivp\
 )
 #define FUNCTION_ODE_METHOD(name) bool ODE_METHOD_NAME(name) ODE_METHOD_PARAMS
 
-typedef void (*ode_fun_t) (double, const st_t*, st_t* restrict, size_t, va_list*);
-typedef bool (*ode_step_t) (const st_t*, const st_t*, const st_t*, int, size_t, va_list*);
+/* Data types */
+struct ode_fsal_s {  // first-same-as-last (or first-stage) derivative
+    bool valid;
+    double x;
+    st_t k;  // derivative at `x` (end of the last step, or a rejected start)
+};
+
+struct ode_stats_s {  // integration counters
+    uint64_t n_accept;  // accepted steps
+    uint64_t n_reject;  // rejected steps
+    uint64_t n_fun;     // accumulator function evaluations
+    uint64_t n_iter;    // implicit stage iterations (sweeps)
+    uint64_t n_jac;     // Jacobian evaluations (and factorizations)
+    uint64_t n_fallback;  // failed Newton solves (fixed-point fallback)
+};
+
+#define ODE_DENSE_SIZE 7  // maximum number of stages
+
+struct ode_dense_s {  // dense output (continuous extension) of the last step
+    bool valid;
+    size_t size;  // number of stages
+    double x0, x1;
+    st_t y0;
+    st_t k[ODE_DENSE_SIZE];
+    void (*weight_fun)(double, double*);  // b_bar(theta), `theta` in [0, 1]
+};
+
+#define ODE_MULTI_SIZE 8  // number of steps (and order) of `abm`
+
+struct ode_multi_s {  // multistep derivative history (most recent first)
+    size_t size;  // number of valid entries (0 restarts the method)
+    double x[ODE_MULTI_SIZE];
+    quat_t q[ODE_MULTI_SIZE];  // rotation at `x`
+    st_t k[ODE_MULTI_SIZE];  // derivative at `x`
+};
+
+#define ODE_STAGE_SIZE 3  // maximum number of implicit stages
+#define ODE_STAGE_RATIO 2.0  // largest step size ratio of a warm start
+
+struct ode_stage_s {  // stage derivatives of the last implicit step
+    bool valid;
+    size_t size;  // number of stages
+    double x0, x1;
+    st_t k[ODE_STAGE_SIZE];
+};
+
+#define ODE_JAC_SIZE 12  // tangent space dimension (r_bar, th_bar, v_bar, om_bar)
+
+struct ivp_s;
+typedef void (*ode_jac_t) (double, const st_t*, st_t* restrict, double [ODE_JAC_SIZE][ODE_JAC_SIZE], struct ivp_s*);
+
+struct ode_stm_s {  // state transition matrix (variational equations)
+    bool valid;  // propagated by every step since it was set
+    ode_jac_t jac;  // accumulator Jacobian (and derivative)
+    double Phi[ODE_JAC_SIZE][ODE_JAC_SIZE];  // tangent space, d y(x) / d y(x0)
+};
+
+struct ivp_s {  // propagation context
+    size_t size;
+    struct cfg_s* cfg;
+    const struct st_s* prev;
+    const struct st_s* next;
+    struct st_s* curr;
+    struct in_s* in;
+    struct out_s* out;
+    struct em_s* em;
+    const struct force_model_s* force_model;
+    struct ode_fsal_s* fsal;  // (optional) shared by consecutive steps
+    struct ode_stats_s* stats;  // (optional) counters
+    struct ode_dense_s* dense;  // (optional) dense output
+    struct ode_multi_s* multi;  // (optional) multistep history
+    struct ode_stage_s* stage;  // (optional) implicit stage initial guess
+    ode_jac_t jac;  // (optional) accumulator Jacobian, selects simplified Newton
+    struct ode_stm_s* stm;  // (optional) state transition matrix
+};
+
+typedef void (*ode_fun_t) (double, const st_t*, st_t* restrict, struct ivp_s*);
+typedef bool (*ode_step_t) (const st_t*, const st_t*, const st_t*, int, struct ivp_s*);
 typedef bool (*ode_meth_t) ODE_METHOD_PARAMS;
 
 /* Ordinary differential equation methods
@@ -33,21 +111,85 @@ typedef bool (*ode_meth_t) ODE_METHOD_PARAMS;
  * :param st_t* y1: output state
  * :param ode_fun_t fun: accumulator function
  * :param ode_step_t fun: step function
- * :param size_t nargs: number of arguments
- * :param va_list* vargs: variadic arguments
+ * :param ivp_s* ivp: propagation context
  * :returns bool: repeat step
+ *
+ * Explicit methods take `k[0]` from `ivp->fsal` when it is valid at `x0`,
+ * and otherwise store it there, so a rejected step is retried without
+ * re-evaluating it; FSAL methods (`dopri`) also store their last stage
+ * when a step is accepted. The caller invalidates it whenever the state,
+ * inputs or configuration change outside of the integrator.
+ *
+ * Methods with a continuous extension (`dopri`, `vgl6`) store it in
+ * `ivp->dense` when a step is accepted (see `ode_dense_eval`).
+ *
+ * Implicit methods (`midp`, `vgl4`, `vgl6`) solve their stages by
+ * fixed-point iteration, or by simplified Newton iteration when
+ * `ivp->jac` is given: the Jacobian is evaluated at `y0` (in the tangent
+ * space, with the rotation as `quat_log` increments) and the stage
+ * system factored once per step. Both count sweeps in `ivp->stats`; when
+ * the stage system is singular or Newton does not converge, the stages
+ * are swept by fixed-point iteration instead (counted in `n_fallback`).
+ * With `ivp->stage`, `vgl4` and `vgl6` store their stages and start the
+ * next step (or the retry of a rejected one) from the derivative of the
+ * last collocation polynomial, extrapolated to the new nodes; the caller
+ * invalidates it as `ivp->fsal`, and step size ratios outside
+ * [1 / `ODE_STAGE_RATIO`, `ODE_STAGE_RATIO`] start cold.
+ *
+ * The multistep method (`abm`) requires `ivp->multi` (so `solve_ivp_ctx`,
+ * not `solve_ivp`) and keeps its derivative history there across calls;
+ * it takes single steps (`dopri`, or `rk4` without a step function) until
+ * the history is full, and the caller restarts it by clearing the
+ * history, as for `ivp->fsal`.
+ *
+ * With a valid `ivp->stm`, the Runge-Kutta methods (`rk4`, `dopri`,
+ * `dop853`, `midp`, `vgl4`, `vgl6`) also integrate the variational
+ * equations, Phi_dot = J Phi, with the same scheme: every stage evaluates
+ * the derivative together with its Jacobian (`stm->jac`, in place of
+ * `fun`), and `stm->Phi` is advanced when a step is accepted. The
+ * rotation perturbation is taken in the body frame at every state
+ * (q exp(th_bar)), so `Phi` chains across steps. The other methods
+ * invalidate it.
  */
 FUNCTION_ODE_METHOD(euler);  // Euler method
 FUNCTION_ODE_METHOD(verlet); // Verlet integration
 FUNCTION_ODE_METHOD(rk4);    // Runge-Kutta (4th-order) method
 FUNCTION_ODE_METHOD(heuler); // Heun-Euler method
 FUNCTION_ODE_METHOD(dopri);  // Dormand-Prince method
+FUNCTION_ODE_METHOD(dop853); // Dormand-Prince 8(5,3) method
 FUNCTION_ODE_METHOD(beuler); // backward Euler method
 FUNCTION_ODE_METHOD(midp);   // Midpointm method
 FUNCTION_ODE_METHOD(vgl4);   // Gauss-Legendre (4th-order) method
 FUNCTION_ODE_METHOD(vgl6);   // Gauss-Legendre (6th-order) method
+FUNCTION_ODE_METHOD(abm);    // Adams-Bashforth-Moulton (8th-order) method
+
+/* Evaluate dense output
+ * :param ode_dense_s* dense: dense output of an accepted step
+ * :param double x: (within the step)
+ * :param st_t* y: output state
+ * :returns bool: valid dense output (and `x` within the step)
+ *
+ * Order 4 for `dopri` (Shampine's continuous extension), order 3 for
+ * `vgl6` (collocation polynomial); both match `y1` at the end of the step.
+ */
+bool ode_dense_eval(const struct ode_dense_s*, double, st_t* restrict);
 
 /* Solve initial value problem
+ * :param double x0:
+ * :param st_t* y0: input state
+ * :param double x1:
+ * :param st_t* y1: output state
+ * :param ode_meth_t meth: integration function
+ * :param ode_fun_t fun: accumulator function
+ * :param ode_step_t fun: step function
+ * :param ivp_s* ivp: propagation context
+ * :returns bool: step accepted
+ *
+ * Counts accepted and rejected steps in `ivp->stats` (when given).
+ */
+bool solve_ivp_ctx(double, const st_t*, double, st_t* restrict, ode_meth_t, ode_fun_t, ode_step_t, struct ivp_s*);
+
+/* Solve initial value problem (variadic)
  * :param double x0:
  * :param st_t* y0: input state
  * :param double x1:
@@ -56,6 +198,10 @@ FUNCTION_ODE_METHOD(vgl6);   // Gauss-Legendre (6th-order) method
  * :param ode_fun_t fun: accumulator function
  * :param ode_step_t fun: step function
  * :param size_t nargs: number of arguments
+ * :returns bool: step accepted
+ *
+ * Packs the (nine) variadic arguments into a `ivp_s` context, in order,
+ * and forwards to `solve_ivp_ctx`.
  */
 bool solve_ivp(double, const st_t*, double, st_t* restrict, ode_meth_t, ode_fun_t, ode_step_t, size_t, ...);
 
@@ -0,0 +1,83 @@
+
+#ifndef __POOL_H__
+#define __POOL_H__
+
+/* Worker pool library
+ * -------------------
+ * Propagates a batch of independent vehicle models across threads
+ */
+
+/* External libraries */
+#include <pthread.h>
+
+/* Internal libraries */
+#include "vehicle_model.h"
+#include "force_model.h"
+#include "batch.h"
+#include "ode.h"
+#include "config.h"
+
+/* Built-in libraries */
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Data types */
+struct pool_s {
+    size_t size;  // number of workers
+    pthread_t thread_lst[MAX_THREAD_COUNT];
+    struct pool_task_s {  // per-worker range of vehicles
+        struct pool_s* pool;
+        pthread_mutex_t lock;
+        size_t lo, hi;
+    } task_lst[MAX_THREAD_COUNT];
+    pthread_mutex_t lock;
+    pthread_cond_t start, done;
+    unsigned long gen;  // job generation
+    size_t busy;  // number of busy workers
+    bool quit;
+    long stats[3];  // operation counts of the workers (`__DEBUG__`)
+    struct {  // current job
+        double t;
+        struct vehicle_model_s* vehicle_model;
+        struct batch_s* batch;
+        ode_meth_t meth;
+        const struct force_model_s* force_model;
+    } job;
+};
+
+/* Initialize worker pool
+ * :param pool_s* pool: worker pool
+ * :param size_t size: number of workers
+ * :returns bool: workers started
+ */
+bool pool_init(struct pool_s* restrict, size_t);
+
+/* Finalize worker pool
+ * :param pool_s* pool: worker pool
+ */
+void pool_free(struct pool_s* restrict);
+
+/* Solve batch of vehicle models (in parallel)
+ * :param pool_s* pool: worker pool
+ * :param size_t N: number of vehicles
+ * :param double t: target time
+ * :param vehicle_model_s* vehicle_model: vehicle model array
+ * :param batch_s* batch: workspace array
+ * :param ode_meth_t meth: integration function
+ * :param force_model_s* force_model: force model
+ *
+ * Each worker starts on a contiguous range of vehicles and steals from
+ * the tail of the other ranges once its own is exhausted. Vehicles are
+ * independent, so results match `solve_batch` bit for bit. Operation
+ * counts (`__DEBUG__`) are kept per worker and added to the caller's.
+ */
+void pool_solve(
+    struct pool_s* restrict,
+    size_t N, double,
+    struct vehicle_model_s[static N],
+    struct batch_s[static N],
+    ode_meth_t,
+    const struct force_model_s*
+);
+
+#endif  // __POOL_H__
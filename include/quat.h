@@ -3,13 +3,18 @@
 
 /* Quaternion library
  * ------------------
+ * The arithmetic and rotation kernels are C99 `inline` definitions so
+ * callers can inline them; `quat.c` emits the external definitions.
  */
 /* Internal libraries */
+#include "log.h"
 #include "mat.h"
+#include "simd.h"
 #include "util.h"
 #include "vec.h"
 
 /* Built-in libraries */
+#include <assert.h>
 #include <math.h>
 #include <stdbool.h>
 #include <string.h>
@@ -109,21 +114,76 @@ quat_isunit(
  * :param quat_t q: (second) input quaternion
  * :param quat_t r: output quaternion
  */
-void quat_add(const quat_t, const quat_t, quat_t);
+SIMD_INLINE
+void
+quat_add(
+    const quat_t p,
+    const quat_t q,
+    quat_t r
+) {
+    LOG_STATS("quat_add", 4, 0, 0);
+#if defined SIMD_AVX2
+    _mm256_storeu_pd(r, _mm256_add_pd(_mm256_loadu_pd(p), _mm256_loadu_pd(q)));
+    _mm256_zeroupper();
+#elif defined SIMD_SSE2
+    _mm_storeu_pd(&r[0], _mm_add_pd(_mm_loadu_pd(&p[0]), _mm_loadu_pd(&q[0])));
+    _mm_storeu_pd(&r[2], _mm_add_pd(_mm_loadu_pd(&p[2]), _mm_loadu_pd(&q[2])));
+#else
+    for (int i = 0; i < 4; i++)
+        r[i] = p[i] + q[i];
+#endif
+}
 
 /* Quaternion subtraction
  * :param quat_t p: (first) input quaternion
  * :param quat_t q: (second) input quaternion
  * :param quat_t r: output quaternion
  */
-void quat_sub(const quat_t, const quat_t, quat_t);
+SIMD_INLINE
+void
+quat_sub(
+    const quat_t p,
+    const quat_t q,
+    quat_t r
+) {
+    LOG_STATS("quat_sub", 4, 0, 0);
+#if defined SIMD_AVX2
+    _mm256_storeu_pd(r, _mm256_sub_pd(_mm256_loadu_pd(p), _mm256_loadu_pd(q)));
+    _mm256_zeroupper();
+#elif defined SIMD_SSE2
+    _mm_storeu_pd(&r[0], _mm_sub_pd(_mm_loadu_pd(&p[0]), _mm_loadu_pd(&q[0])));
+    _mm_storeu_pd(&r[2], _mm_sub_pd(_mm_loadu_pd(&p[2]), _mm_loadu_pd(&q[2])));
+#else
+    for (int i = 0; i < 4; i++)
+        r[i] = p[i] - q[i];
+#endif
+}
 
 /* Quaternion-scalar multiplication
  * :param quat_t p: input quaternion
  * :param double s: input scalar
  * :param quat_t q: output quaternion
  */
-void quat_muls(const quat_t, double, quat_t);
+SIMD_INLINE
+void
+quat_muls(
+    const quat_t p,
+    double s,
+    quat_t q
+) {
+    LOG_STATS("quat_muls", 0, 4, 0);
+#if defined SIMD_AVX2
+    _mm256_storeu_pd(q, _mm256_mul_pd(_mm256_loadu_pd(p), _mm256_set1_pd(s)));
+    _mm256_zeroupper();
+#elif defined SIMD_SSE2
+    __m128d s2 = _mm_set1_pd(s);
+    _mm_storeu_pd(&q[0], _mm_mul_pd(_mm_loadu_pd(&p[0]), s2));
+    _mm_storeu_pd(&q[2], _mm_mul_pd(_mm_loadu_pd(&p[2]), s2));
+#else
+    for (int i = 0; i < 4; i++)
+        q[i] = p[i] * s;
+#endif
+}
 
 /* Quaternion-vector multiplication
  * :param quat_t p: input quaternion
@@ -144,7 +204,66 @@ void quat_vmul(const vec_t, const quat_t, quat_t);
  * :param quat_t q: (second) input quaternion
  * :param quat_t r: output quaternion
  */
-void quat_mul(const quat_t, const quat_t, quat_t);
+SIMD_INLINE
+void
+quat_mul(
+    const quat_t p,
+    const quat_t q,
+    quat_t r
+) {
+    LOG_STATS("quat_mul", 12, 16, 0);
+    /* r = p[0] * (q0, q1, q2, q3) + p[1] * (-q1, q0, -q3, q2)
+     *   + p[2] * (-q2, q3, q0, -q1) + p[3] * (-q3, -q2, q1, q0)
+     * summed in the same order as the scalar expressions below
+     */
+#if defined SIMD_AVX2
+    __m256d a = _mm256_loadu_pd(q),
+            b = _mm256_permute_pd(a, 0x5),
+            c = _mm256_permute2f128_pd(a, a, 0x1),
+            d = _mm256_permute_pd(c, 0x5),
+            x;
+    b = _mm256_xor_pd(b, _mm256_set_pd(0.0, -0.0, 0.0, -0.0));
+    c = _mm256_xor_pd(c, _mm256_set_pd(-0.0, 0.0, 0.0, -0.0));
+    d = _mm256_xor_pd(d, _mm256_set_pd(0.0, 0.0, -0.0, -0.0));
+    x = _mm256_mul_pd(_mm256_set1_pd(p[0]), a);
+    x = _mm256_add_pd(x, _mm256_mul_pd(_mm256_set1_pd(p[1]), b));
+    x = _mm256_add_pd(x, _mm256_mul_pd(_mm256_set1_pd(p[2]), c));
+    x = _mm256_add_pd(x, _mm256_mul_pd(_mm256_set1_pd(p[3]), d));
+    _mm256_storeu_pd(r, x);
+    _mm256_zeroupper();
+#elif defined SIMD_SSE2
+    __m128d q01 = _mm_loadu_pd(&q[0]),
+            q23 = _mm_loadu_pd(&q[2]),
+            q10 = _mm_shuffle_pd(q01, q01, 0x1),
+            q32 = _mm_shuffle_pd(q23, q23, 0x1),
+            lo = _mm_set_pd(0.0, -0.0),
+            hi = _mm_set_pd(-0.0, 0.0),
+            p0 = _mm_set1_pd(p[0]),
+            p1 = _mm_set1_pd(p[1]),
+            p2 = _mm_set1_pd(p[2]),
+            p3 = _mm_set1_pd(p[3]),
+            x, y;
+    x = _mm_mul_pd(p0, q01);
+    x = _mm_add_pd(x, _mm_mul_pd(p1, _mm_xor_pd(q10, lo)));
+    x = _mm_add_pd(x, _mm_mul_pd(p2, _mm_xor_pd(q23, lo)));
+    x = _mm_add_pd(x, _mm_mul_pd(p3, _mm_xor_pd(q32, _mm_or_pd(lo, hi))));
+    y = _mm_mul_pd(p0, q23);
+    y = _mm_add_pd(y, _mm_mul_pd(p1, _mm_xor_pd(q32, lo)));
+    y = _mm_add_pd(y, _mm_mul_pd(p2, _mm_xor_pd(q01, hi)));
+    y = _mm_add_pd(y, _mm_mul_pd(p3, q10));
+    _mm_storeu_pd(&r[0], x);
+    _mm_storeu_pd(&r[2], y);
+#else
+    double r0 = p[0] * q[0] - p[1] * q[1] - p[2] * q[2] - p[3] * q[3],
+           r1 = p[0] * q[1] + p[1] * q[0] + p[2] * q[3] - p[3] * q[2],
+           r2 = p[0] * q[2] - p[1] * q[3] + p[2] * q[0] + p[3] * q[1],
+           r3 = p[0] * q[3] + p[1] * q[2] - p[2] * q[1] + p[3] * q[0];
+    r[0] = r0;
+    r[1] = r1;
+    r[2] = r2;
+    r[3] = r3;
+#endif
+}
 
 /* Quaternion exponentiation
  * :param quat_t p: input quaternion
@@ -170,14 +289,72 @@ void quat_log(const quat_t, vec_t);
  * :param vec_t* u_bar: input vector
  * :param vec_t* v_bar: output vector
  */
-void vec_rot(const quat_t, const vec_t, vec_t);
+SIMD_INLINE
+void
+vec_rot(
+    const quat_t q,
+    const vec_t u_bar,
+    vec_t v_bar
+) {
+    LOG_STATS("vec_rot", 9, 18, 0);
+    assert(fabs(quat_norm(q) - 1.0) < M_ARCSEC);
+    // v = u + s * t + w x t, t = 2 * w x u, q = (s, w)
+    const double* w = &q[1];
+    double t0 = (w[1] * u_bar[2] - w[2] * u_bar[1]) * 2.0,
+           t1 = (w[2] * u_bar[0] - w[0] * u_bar[2]) * 2.0,
+           t2 = (w[0] * u_bar[1] - w[1] * u_bar[0]) * 2.0,
+           v0 = u_bar[0] + q[0] * t0 + (w[1] * t2 - w[2] * t1),
+           v1 = u_bar[1] + q[0] * t1 + (w[2] * t0 - w[0] * t2),
+           v2 = u_bar[2] + q[0] * t2 + (w[0] * t1 - w[1] * t0);
+    v_bar[0] = v0;
+    v_bar[1] = v1;
+    v_bar[2] = v2;
+}
 
 /* Vector (inverse) rotation
  * :param quat_t q: input (unit) quaternion
  * :param vec_t* u_bar: input vector
  * :param vec_t* v_bar: output vector
  */
-void vec_irot(const quat_t, const vec_t, vec_t);
+SIMD_INLINE
+void
+vec_irot(
+    const quat_t q,
+    const vec_t u_bar,
+    vec_t v_bar
+) {
+    LOG_STATS("vec_irot", 9, 18, 0);
+    assert(fabs(quat_norm(q) - 1.0) < M_ARCSEC);
+    // v = u + s * t + t x w, t = 2 * u x w, q = (s, w)
+    const double* w = &q[1];
+    double t0 = (u_bar[1] * w[2] - u_bar[2] * w[1]) * 2.0,
+           t1 = (u_bar[2] * w[0] - u_bar[0] * w[2]) * 2.0,
+           t2 = (u_bar[0] * w[1] - u_bar[1] * w[0]) * 2.0,
+           v0 = u_bar[0] + q[0] * t0 + (t1 * w[2] - t2 * w[1]),
+           v1 = u_bar[1] + q[0] * t1 + (t2 * w[0] - t0 * w[2]),
+           v2 = u_bar[2] + q[0] * t2 + (t0 * w[1] - t1 * w[0]);
+    v_bar[0] = v0;
+    v_bar[1] = v1;
+    v_bar[2] = v2;
+}
+
+/* Vector rotation (batch)
+ * Expands the quaternion into a rotation matrix once for all vectors.
+ * :param quat_t q: input (unit) quaternion
+ * :param size_t n: number of vectors
+ * :param vec_t* u_bar: input vectors
+ * :param vec_t* v_bar: output vectors
+ */
+void vec_rot_n(const quat_t, size_t, const vec_t[], vec_t[]);
+
+/* Vector (inverse) rotation (batch)
+ * Expands the quaternion into a rotation matrix once for all vectors.
+ * :param quat_t q: input (unit) quaternion
+ * :param size_t n: number of vectors
+ * :param vec_t* u_bar: input vectors
+ * :param vec_t* v_bar: output vectors
+ */
+void vec_irot_n(const quat_t, size_t, const vec_t[], vec_t[]);
 
 /* Quaternion rotation matrix
  * :param quat_t q: input (unit) quaternion
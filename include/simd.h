@@ -0,0 +1,38 @@
+#ifndef __SIMD_H__
+#define __SIMD_H__
+
+/* SIMD selection
+ * --------------
+ * Instruction sets are selected at build time from the compiler target
+ * (e.g. `make ARCH=-mavx2`); `__NO_SIMD__` forces the scalar fallback.
+ * The SSE2 kernels handle 2-wide lanes (vector/quaternion components),
+ * the AVX2 kernels whole quaternions; 3-vector rotations stay scalar.
+ * AVX2 kernels end with `_mm256_zeroupper()` since the surrounding
+ * (SSE-encoded) code would otherwise pay the AVX/SSE transition penalty.
+ */
+
+#if !defined __NO_SIMD__ && defined __SSE2__
+#define SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+#if !defined __NO_SIMD__ && defined __AVX2__
+#define SIMD_AVX2
+#include <immintrin.h>
+#endif
+
+/* Kernel inlining
+ * The primitives are C99 `inline` definitions; force inlining since `-Os`
+ * would otherwise keep the (PLT) calls.
+ */
+#define SIMD_INLINE inline __attribute__((always_inline))
+
+#if defined SIMD_AVX2
+#define SIMD_NAME "avx2"
+#elif defined SIMD_SSE2
+#define SIMD_NAME "sse2"
+#else
+#define SIMD_NAME "scalar"
+#endif
+
+#endif  // __SIMD_H__
@@ -22,11 +22,23 @@
 #define A_M7 28.95e-3
 #define A_T7 186.87
 
+/* Table
+ * Cells of `A_STEP`, in geopotential altitude below 86km (up to its 85th
+ * cell) and in geometric altitude from 86km to 1000km, so that the layer
+ * and `uasa20` boundaries fall on cell edges.
+ */
+#define A_STEP 1e3
+#define A_LOWER_SIZE 85
+#define A_TABLE_SIZE (A_LOWER_SIZE + 914)
+
 /* Data types */
+struct jac_s;
+
 struct atm_s {  // atmosphere condiion structure
     double th;  // temperature
     double p;   // pressure
     double rho; // density
+    double rho_z; // density gradient (altitude)
 };
 
 struct uasa20_s { // unofficial Australian standard atmosphere
@@ -35,12 +47,41 @@ struct uasa20_s { // unofficial Australian standard atmosphere
     struct poly_s p;
 };
 
-/* Initialize standard atmosphere */
+struct stdatm_cell_s {  // table cell, cubics about the cell midpoint
+    double th[4];  // temperature
+    double p[4];  // pressure at the midpoint, then log pressure
+    double rho[4];  // density at the midpoint, then log density
+};
+
+/* Initialize standard atmosphere (and its table) */
 void stdatm_init();
 
-/* Evalute standard atmosphere force model */
+/* Evaluate standard atmosphere model
+ * :param double z: geometric altitude
+ * :param atm_s* atm: output conditions
+ * :returns bool: altitude within the model (up to 1000km)
+ *
+ * Reference for the table of `stdatm_eval`.
+ */
+bool stdatm_model(double, struct atm_s* restrict);
+
+/* Evaluate standard atmosphere
+ * :param double z: geometric altitude
+ * :param atm_s* atm: output conditions
+ * :returns bool: altitude within the model (up to 1000km)
+ *
+ * Interpolated from the table of `stdatm_init`.
+ */
 bool stdatm_eval(double, struct atm_s* restrict);
 
+/* Evaluate standard atmosphere (batch)
+ * :param size_t n: number of altitudes
+ * :param double* z: geometric altitudes
+ * :param atm_s* atm: output conditions (zero outside the model)
+ * :returns bool: all altitudes within the model
+ */
+bool stdatm_eval_n(size_t, const double[], struct atm_s[]);
+
 /* Standard atmosphere force model
  * :param size_t size:
  * :param cfg_t* cfg: configuration structure
@@ -52,5 +93,17 @@ bool stdatm_eval(double, struct atm_s* restrict);
  */
 bool stdatm(size_t, const struct cfg_s*, const struct st_s*, struct in_s* restrict, const struct out_s*, struct em_s* restrict);
 
-#endif  // __STDATM_H__
+/* Standard atmosphere force model partials
+ * :param size_t size:
+ * :param cfg_t* cfg: configuration structure
+ * :param st_t* st: state structure
+ * :param jac_t* jac: partials structure
+ * :param out_t* out: output structure
+ * :param em_t* em: electromagnetic structure
+ * :returns bool:
+ *
+ * The altitude gradient is taken along the radial direction.
+ */
+bool stdatm_jac(size_t, const struct cfg_s*, const struct st_s*, struct jac_s* restrict, const struct out_s*, const struct em_s*);
 
+#endif  // __STDATM_H__
@@ -3,10 +3,14 @@
 
 /* Vector library
  * --------------
+ * The arithmetic kernels are C99 `inline` definitions so callers can
+ * inline them; `vec.c` emits the external definitions.
  */
  
 /* Internal libraries */
 #include "config.h"
+#include "log.h"
+#include "simd.h"
 
 /* Built-in libraries */
 #include <math.h>
@@ -93,21 +97,66 @@ vec_isunit(
  * :param vec_t v_hat: (second) input vector
  * :param vec_t w_hat: output vector
  */
-void vec_add(const vec_t, const vec_t, vec_t);
+SIMD_INLINE
+void
+vec_add(
+    const vec_t u_bar,
+    const vec_t v_bar,
+    vec_t w_bar
+) {
+    LOG_STATS("vec_add", 3, 0, 0);
+#if defined SIMD_SSE2
+    _mm_storeu_pd(w_bar, _mm_add_pd(_mm_loadu_pd(u_bar), _mm_loadu_pd(v_bar)));
+    w_bar[2] = u_bar[2] + v_bar[2];
+#else
+    for (int i = 0; i < 3; i++)
+        w_bar[i] = u_bar[i] + v_bar[i];
+#endif
+}
 
 /* Vector subtraction
  * :param vec_t u_bar: (first) input vector
  * :param vec_t v_hat: (second) input vector
  * :param vec_t w_hat: output vector
  */
-void vec_sub(const vec_t, const vec_t, vec_t);
+SIMD_INLINE
+void
+vec_sub(
+    const vec_t u_bar,
+    const vec_t v_bar,
+    vec_t w_bar
+) {
+    LOG_STATS("vec_sub", 3, 0, 0);
+#if defined SIMD_SSE2
+    _mm_storeu_pd(w_bar, _mm_sub_pd(_mm_loadu_pd(u_bar), _mm_loadu_pd(v_bar)));
+    w_bar[2] = u_bar[2] - v_bar[2];
+#else
+    for (int i = 0; i < 3; i++)
+        w_bar[i] = u_bar[i] - v_bar[i];
+#endif
+}
 
 /* Vector-scalar multiplication
  * :param vec_t u_bar: input vector
  * :param double s: input scalar
  * :param vec_t v_hat: output vector
  */
-void vec_muls(const vec_t, double, vec_t);
+SIMD_INLINE
+void
+vec_muls(
+    const vec_t u_bar,
+    double s,
+    vec_t v_bar
+) {
+    LOG_STATS("vec_muls", 0, 3, 0);
+#if defined SIMD_SSE2
+    _mm_storeu_pd(v_bar, _mm_mul_pd(_mm_loadu_pd(u_bar), _mm_set1_pd(s)));
+    v_bar[2] = u_bar[2] * s;
+#else
+    for (int i = 0; i < 3; i++)
+        v_bar[i] = u_bar[i] * s;
+#endif
+}
 
 /* Vector dot product
  * :param vec_t u_bar: (first) input vector
@@ -115,14 +164,36 @@ void vec_muls(const vec_t, double, vec_t);
  * :returns: output scalar
  * :rtype: double
  */
-double vec_dot(const vec_t, const vec_t);
+SIMD_INLINE
+double
+vec_dot(
+    const vec_t u_bar,
+    const vec_t v_bar
+) {
+    LOG_STATS("vec_dot", 3, 3, 0);
+    return u_bar[0] * v_bar[0] + u_bar[1] * v_bar[1] + u_bar[2] * v_bar[2];
+}
 
 /* Vector cross product
  * :param vec_t u_bar: (first) input vector
  * :param vec_t v_hat: (second) input vector
  * :param vec_t w_hat: output vector
  */
-void vec_cross(const vec_t, const vec_t, vec_t);
+SIMD_INLINE
+void
+vec_cross(
+    const vec_t u_bar,
+    const vec_t v_bar,
+    vec_t w_bar
+) {
+    LOG_STATS("vec_cross", 3, 6, 0);
+    double w0 = u_bar[1] * v_bar[2] - u_bar[2] * v_bar[1],
+           w1 = u_bar[2] * v_bar[0] - u_bar[0] * v_bar[2],
+           w2 = u_bar[0] * v_bar[1] - u_bar[1] * v_bar[0];
+    w_bar[0] = w0;
+    w_bar[1] = w1;
+    w_bar[2] = w2;
+}
 
 #endif  // __VEC_H__
 
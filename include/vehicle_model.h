@@ -6,8 +6,10 @@
  */
 
 /* Internal libraries */
+#include "config.h"
 #include "dmat.h"
 #include "mat.h"
+#include "ode.h"
 #include "quat.h"
 #include "st.h"
 #include "util.h"
@@ -32,6 +34,24 @@
 #error "Maximum object count undefined"
 #endif
 
+/* Object list layout
+ * `__SOA__` stores each object field contiguously (structure-of-arrays) so
+ * per-object loops can be vectorized; the default is an array-of-structures.
+ * Either way, fields are accessed as `cfg->OBJ_LST(idx, r_bar)`. The change
+ * structure (`ch_s`) is sparse and always an array-of-structures.
+ *
+ * Only the element-wise kernels (`interp_obj_lst`, `solve_st_dot`) are
+ * written as flat per-field loops; they roughly halve in time under `-O3`
+ * (`bench_ode`, `__XLARGE__`). The accumulating kernels (`solve_in`,
+ * `solve_em`, `solve_out`, `gee`) rotate each object and sum in order,
+ * which does not vectorize without reassociation, and are left as is.
+ */
+#if defined __SOA__
+#define OBJ_LST(idx, field) obj_lst.field[idx]
+#else
+#define OBJ_LST(idx, field) obj_lst[idx].field
+#endif
+
 /* Data types */
 struct vehicle_model_s {
     size_t size;
@@ -42,12 +62,35 @@ struct vehicle_model_s {
         struct {
             char sym[4];
         } sys;
+#if defined __SOA__
+        struct {
+            char sym[MAX_OBJ_COUNT][4];
+            dmat_t bbox[MAX_OBJ_COUNT];  // bounding box
+            vec_t r_bar[MAX_OBJ_COUNT];  // position vector
+            quat_t q[MAX_OBJ_COUNT];  // attitude quaternion
+        } obj_lst;
+#else
         struct {
             char sym[4];
             dmat_t bbox;  // bounding box
             vec_t r_bar;  // position vector
             quat_t q;  // attitude quaternion
         } obj_lst[MAX_OBJ_COUNT];
+#endif
+        struct {
+            size_t size;  // number of derived objects
+            uint64_t n;  // generation (bumped on every rebuild)
+            mat_t K;  // drag matrix (sum)
+            mat_t L;  // drag torque matrix, sum of `[r_bar x] K`
+            struct {
+                quat_t q;  // attitude quaternion (derived from)
+                vec_t r_bar;  // position vector (derived from)
+                dmat_t bbox;  // bounding box (derived from)
+                mat_t R;  // rotation matrix
+                mat_t S;  // parallel-axis term, `[r_bar x]^2`
+                mat_t K;  // drag matrix, `R diag(A) R^T` (face areas `A`)
+            } obj_lst[MAX_OBJ_COUNT];
+        } drv;  // derived configuration, maintained by `solve_cfg`
     } cfg;
     struct st_s {
         struct {
@@ -55,12 +98,21 @@ struct vehicle_model_s {
             double t;
         } clk;
         st_t sys;
+#if defined __SOA__
+        struct {
+            double m[MAX_OBJ_COUNT];  // mass
+            dmat_t I_cm[MAX_OBJ_COUNT];  // moment of inertia
+            vec_t p_bar[MAX_OBJ_COUNT];  // momentum vector
+            vec_t h_bar[MAX_OBJ_COUNT];  // angular momentum
+        } obj_lst;
+#else
         struct {
             double m;  // mass
             dmat_t I_cm;  // moment of inertia
             vec_t p_bar;  // momentum vector
             vec_t h_bar;  // angular momentum
         } obj_lst[MAX_OBJ_COUNT];
+#endif
     } st;
     struct ch_s {
         struct {
@@ -95,18 +147,56 @@ struct vehicle_model_s {
             vec_t v_dot;  // force vector
             vec_t om_dot;  // torque vector
         } sys;
+#if defined __SOA__
+        struct {
+            double m_dot[MAX_OBJ_COUNT];  // mass flow rate
+            vec_t F_bar[MAX_OBJ_COUNT];  // force vector
+            vec_t M_bar[MAX_OBJ_COUNT];  // torque vector
+        } obj_lst;
+#else
         struct {
             double m_dot;  // mass flow rate
             vec_t F_bar;  // force vector
             vec_t M_bar;  // torque vector
         } obj_lst[MAX_OBJ_COUNT];
+#endif
+        struct env_s {  // Earth environment, shared by the force functions
+            unsigned flags;  // valid parts (`ENV_*`)
+            struct {
+                double t;  // time
+                vec_t r_bar;  // position vector
+                quat_t q;  // attitude quaternion
+                vec_t c_bar;  // center of mass
+            } key;  // state the parts were computed for
+            quat_t q_i2f;  // ECI to ECEF quaternion
+            vec_t r_bar;  // center of mass position (ECEF)
+            double r, a, x, y, z;  // spherical coordinates (see `sph_harm`)
+            double R[MAX(G_DEG,2)+1];  // radius ratio powers
+            double P[(G_DEG+1)*(G_DEG+2)/2];  // Legendre functions
+            double Q[(G_DEG+1)*(G_DEG+2)/2];  // Legendre function derivatives
+            double C[G_ORD+1], S[G_ORD+1];  // longitude harmonics
+            double alt;  // geodetic altitude
+        } env;  // computed on demand by `gee_env`
     } in;
     struct out_s {
         struct {
             double m;  // mass
             vec_t c_bar;  // center of mass
             mat_t I_cm;  // moment of inertia
+            mat_t L_cm;  // moment of inertia (Cholesky factor)
+            bool chol;  // `L_cm` factors `I_cm`, clear when writing `I_cm`
         } sys;
+        struct {
+            size_t size;  // number of accumulated objects
+            uint64_t n;  // incremental updates since the last full recompute
+            uint64_t gen;  // derived configuration generation
+            vec_t m_bar;  // first mass moment
+            mat_t I_bar;  // moment of inertia (about the body origin)
+            struct {
+                double m;  // mass
+                dmat_t I_cm;  // moment of inertia
+            } obj_lst[MAX_OBJ_COUNT];
+        } acc;  // running sums, maintained by `solve_out`
     } out;
     struct em_s {
         struct {
@@ -116,12 +206,25 @@ struct vehicle_model_s {
             vec_t E_bar;  // electric field
             vec_t B_bar;  // magnetic field
         } sys;
+#if defined __SOA__
+        struct {
+            double q[MAX_OBJ_COUNT];  // charge
+            vec_t p_bar[MAX_OBJ_COUNT];  // electric dipole moment
+            vec_t m_bar[MAX_OBJ_COUNT];  // magnetic dipole moment
+        } obj_lst;
+#else
         struct {
             double q;  // charge
             vec_t p_bar;  // electric dipole moment
             vec_t m_bar;  // magnetic dipole moment
         } obj_lst[MAX_OBJ_COUNT];
+#endif
     } em;
+    struct stm_s {
+        bool valid;  // propagated (set by the caller, with `Phi`, to start)
+        double t;  // time of `Phi` (end of the last integration step)
+        double Phi[ODE_JAC_SIZE][ODE_JAC_SIZE];  // state transition matrix
+    } stm;
 };
 
 #endif  // __VEHICLE_MODEL_H__
@@ -12,8 +12,8 @@
 #include "config.h"
 #include "util.h"
 #include "log.h"
-#include "interp.h"
 #include "ode.h"
+#include "batch.h"
 #include "shared_data.h"
 #include "vehicle_model.h"
 #include "force_model.h"
@@ -21,9 +21,12 @@
 #include "geopot.h"
 #include "geomag.h"
 #include "stdatm.h"
+#include "fused.h"
 
 enum log_e noise_level;
 char* file_name;
+char* egm_file_name = NULL;
+size_t egm_deg = G_NMAX;
 
 ode_meth_t ode_meth = NULL;
 struct force_model_s force_model = {
@@ -52,8 +55,11 @@ int setup(int argc, char ** argv) {
         {"geopot",  no_argument,       NULL,  0 },
         {"geomag",  no_argument,       NULL,  0 },
         {"geoall",  no_argument,       NULL,  0 },
+        {"egm",     required_argument, NULL,  0 },
+        {"egm-deg", required_argument, NULL,  0 },
         {"stdatm",  no_argument,       NULL,  0 },
         {"adapt",   no_argument,       NULL, 'a'},
+        {"newton",  no_argument,       NULL,  0 },
         {0,         0,                 0,     0 }
     };
     int longindex = 0;
@@ -67,27 +73,48 @@ int setup(int argc, char ** argv) {
                 LOG_WARNING("gee: `true`");
                 force_model.size = MAX(1, force_model.size);
                 force_model.fun_lst[0] = gee_fast;
+                force_model.jac_lst[0] = gee_fast_jac;
             } else if (!strcmp(longopts[longindex].name, "stdatm")) {
                 LOG_WARNING("stdatm: `true`");
                 force_model.size = MAX(2, force_model.size);
                 force_model.fun_lst[1] = stdatm;
+                force_model.jac_lst[1] = stdatm_jac;
             } else if (!strcmp(longopts[longindex].name, "geopot")) {
                 LOG_WARNING("geopot: `true`");
                 force_model.size = MAX(3, force_model.size);
                 force_model.fun_lst[2] = geopot;
+                force_model.jac_lst[2] = geopot_jac;
             } else if (!strcmp(longopts[longindex].name, "geomag")) {
                 LOG_WARNING("geomag: `true`");
                 force_model.size = MAX(5, force_model.size);
                 force_model.fun_lst[3] = geomag;
                 force_model.fun_lst[4] = em;
+                force_model.jac_lst[3] = NULL;
+                force_model.jac_lst[4] = em_jac;
             } else if (!strcmp(longopts[longindex].name, "geoall")) {
                 LOG_WARNING("geoall: `true`");
                 force_model.size = MAX(4, force_model.size);
                 force_model.fun_lst[2] = geoall;
                 force_model.fun_lst[3] = em;
                 force_model.fun_lst[4] = NULL;
+                force_model.jac_lst[2] = geopot_jac;
+                force_model.jac_lst[3] = em_jac;
+                force_model.jac_lst[4] = NULL;
+            } else if (!strcmp(longopts[longindex].name, "egm")) {
+                LOG_WARNING("egm: `%s`", optarg);
+                egm_file_name = optarg;
+                force_model.size = MAX(3, force_model.size);
+                force_model.fun_lst[2] = geopot_egm;
+                force_model.jac_lst[2] = geopot_egm_jac;
+            } else if (!strcmp(longopts[longindex].name, "egm-deg")) {
+                LOG_WARNING("egm-deg: `%s`", optarg);
+                egm_deg = atoi(optarg);
             } else if (!strcmp(longopts[longindex].name, "adapt"))
                 force_model.step_fun = adjust_time_step;
+            else if (!strcmp(longopts[longindex].name, "newton")) {
+                LOG_WARNING("newton: `true`");
+                force_model.jac_fun = jacobian_force_model;
+            }
             break;
         case 'v':
             if (noise_level > E_DEBUG) 
@@ -104,10 +131,14 @@ int setup(int argc, char ** argv) {
                 ode_meth = ODE_METHOD_NAME(rk4);
             else if (!strcmp(optarg, "dopri"))
                 ode_meth = ODE_METHOD_NAME(dopri);
+            else if (!strcmp(optarg, "dop853"))
+                ode_meth = ODE_METHOD_NAME(dop853);
             else if (!strcmp(optarg, "vgl4"))
                 ode_meth = ODE_METHOD_NAME(vgl4);
             else if (!strcmp(optarg, "vgl6"))
                 ode_meth = ODE_METHOD_NAME(vgl6);
+            else if (!strcmp(optarg, "abm"))
+                ode_meth = ODE_METHOD_NAME(abm);
             LOG_WARNING("method: `%s`", optarg);
             break;
         case 'a':
@@ -117,6 +148,7 @@ int setup(int argc, char ** argv) {
             LOG_WARNING("gee: `true`");
             force_model.size = MAX(1, force_model.size);
             force_model.fun_lst[0] = gee_fast;
+            force_model.jac_lst[0] = gee_fast_jac;
             break;
         case -1:
             break;
@@ -124,6 +156,15 @@ int setup(int argc, char ** argv) {
             return -1;
         }
     } while (c != -1);
+    // loaded geopotential (full order)
+    if (egm_file_name != NULL && !geopot_load(egm_file_name, egm_deg, egm_deg)) {
+        LOG_ERROR("geopot_load: `%s`", egm_file_name);
+        return -1;
+    }
+    // fused accumulator for known force model combinations
+    force_model.accum_fun = select_force_model(&force_model);
+    if (force_model.accum_fun != apply_force_model)
+        LOG_WARNING("force model: `fused`");
     if (optind < argc) file_name = argv[optind];
     else               file_name = FILE_NAME;
     return 0;
@@ -160,16 +201,8 @@ int main(int argc, char ** argv) {
     shared_data->size = sizeof(struct vehicle_model_s);
     struct vehicle_model_s* vehicle_model = (struct vehicle_model_s*) &shared_data->data;
     memset(vehicle_model, 0, sizeof(struct vehicle_model_s));
-    size_t* size = &vehicle_model->size;
-    struct cfg_s* cfg = &vehicle_model->cfg;
-    struct st_s swap[3];
-    struct st_s *st = &vehicle_model->st, *prev = &swap[0], *next = &swap[1], *curr = &swap[2];
-    struct ch_s* ch = &vehicle_model->ch;
-    struct in_s* in = &vehicle_model->in;
-    struct out_s* out = &vehicle_model->out;
-    struct em_s* em = &vehicle_model->em;
+    struct batch_s batch;
     
-    interp_init();
     stdatm_init();
 
     bool first = true;
@@ -179,36 +212,19 @@ int main(int argc, char ** argv) {
         RESET_STATS();
         START_CLOCK();
         if (first) {
-            memcpy(next, st, sizeof(struct st_s));
+            batch_init(1, vehicle_model, &batch);
             first = false;
         }
-        LOG_INFO("delta_t: %f", cfg->clk.delta_t);
-        while (ch->clk.t > next->clk.t) {
-            SWAP(&prev, &next);
-            solve_em(*size, cfg, em);
-            do solve_st_dot(*size, cfg, prev, next, in);
-            while (
-                !solve_ivp(
-                    prev->clk.t, &prev->sys,
-                    next->clk.t, &next->sys,
-                    ode_meth,  // default `ode_meth_t`
-                    force_model.accum_fun,
-                    force_model.step_fun,
-                    9, *size, cfg, prev, next, curr, in, out, em, &force_model
-                )
-            );
-            quat_unit(next->sys.q, next->sys.q); // XXX hack
-            next->clk.n = prev->clk.n + 1;
-        }
-        curr->clk.n = MAX(st->clk.n + 1, next->clk.n);
-        curr->clk.t = ch->clk.t;
-        interp_st(*size, prev, next, curr);
-        memcpy(st, curr, sizeof(struct st_s));
-        if (solve_ch(*size, cfg, ch, st, curr, in, em)) {
-            solve_st_delta(*size, cfg, curr, st, out);
-            memcpy(next, st, sizeof(struct st_s));
-        } else
-            solve_out(*size, cfg, curr, out);
+        LOG_INFO("delta_t: %f", vehicle_model->cfg.clk.delta_t);
+        solve_vehicle_model(vehicle_model, &batch, ode_meth, &force_model);
+        LOG_INFO("steps: %llu accepted, %llu rejected, %llu evaluations",
+                 (unsigned long long) batch.stats.n_accept,
+                 (unsigned long long) batch.stats.n_reject,
+                 (unsigned long long) batch.stats.n_fun);
+        LOG_INFO("implicit: %llu iterations, %llu jacobians, %llu fallbacks",
+                 (unsigned long long) batch.stats.n_iter,
+                 (unsigned long long) batch.stats.n_jac,
+                 (unsigned long long) batch.stats.n_fallback);
         STOP_CLOCK();
         SHOW_STATS();
         sem_post(&shared_data->sem2);
@@ -0,0 +1,126 @@
+
+#include <string.h>
+#include "batch.h"
+#include "interp.h"
+#include "util.h"
+#include "log.h"
+
+void batch_init(
+    size_t N,
+    const struct vehicle_model_s vehicle_model[static N],
+    struct batch_s batch[static N]
+) {
+    LOG_STATS("batch_init", 0, 0, 0);
+    interp_init();
+    for (size_t i = 0; i < N; i++) {
+        batch[i].prev = &batch[i].swap[0];
+        batch[i].next = &batch[i].swap[1];
+        batch[i].curr = &batch[i].swap[2];
+        batch[i].fsal.valid = false;
+        batch[i].dense.valid = false;
+        batch[i].multi.size = 0;
+        batch[i].stage.valid = false;
+        batch[i].stm.valid = false;
+        memset(&batch[i].stats, 0, sizeof(struct ode_stats_s));
+        memcpy(batch[i].next, &vehicle_model[i].st, sizeof(struct st_s));
+    }
+}
+
+void solve_vehicle_model(
+    struct vehicle_model_s* restrict vehicle_model,
+    struct batch_s* restrict batch,
+    ode_meth_t meth,
+    const struct force_model_s* force_model
+) {
+    LOG_STATS("solve_vehicle_model", 0, 0, 0);
+    size_t size = vehicle_model->size;
+    struct cfg_s* cfg = &vehicle_model->cfg;
+    struct st_s* st = &vehicle_model->st;
+    struct ch_s* ch = &vehicle_model->ch;
+    struct in_s* in = &vehicle_model->in;
+    struct out_s* out = &vehicle_model->out;
+    struct em_s* em = &vehicle_model->em;
+    struct ivp_s ivp = {
+        .size=size, .cfg=cfg, .curr=batch->curr,
+        .in=in, .out=out, .em=em,
+        .force_model=force_model,
+        .fsal=&batch->fsal, .stats=&batch->stats, .dense=&batch->dense,
+        .multi=&batch->multi, .stage=&batch->stage,
+        .jac=force_model->jac_fun
+    };
+    if (vehicle_model->stm.valid) {
+        batch->stm.valid = true;
+        batch->stm.jac = (
+            force_model->jac_fun != NULL
+            ? force_model->jac_fun : jacobian_force_model
+        );
+        memcpy(batch->stm.Phi, vehicle_model->stm.Phi, sizeof(batch->stm.Phi));
+        ivp.stm = &batch->stm;
+    }
+    if (solve_cfg(size, cfg)) {
+        batch->fsal.valid = false;
+        batch->multi.size = 0;
+        batch->stage.valid = false;
+    }
+    while (ch->clk.t > batch->next->clk.t) {
+        SWAP(&batch->prev, &batch->next);
+        ivp.prev = batch->prev;
+        ivp.next = batch->next;
+        solve_em(size, cfg, em);
+        do solve_st_dot(size, cfg, batch->prev, batch->next, in);
+        while (
+            !solve_ivp_ctx(
+                batch->prev->clk.t, &batch->prev->sys,
+                batch->next->clk.t, &batch->next->sys,
+                meth,  // default `ode_meth_t`
+                force_model->accum_fun,
+                force_model->step_fun,
+                &ivp
+            )
+        );
+        batch->next->clk.n = batch->prev->clk.n + 1;
+    }
+    if (ivp.stm != NULL) {
+        vehicle_model->stm.valid = batch->stm.valid;
+        vehicle_model->stm.t = batch->next->clk.t;
+        memcpy(vehicle_model->stm.Phi, batch->stm.Phi, sizeof(batch->stm.Phi));
+    }
+    batch->curr->clk.n = MAX(st->clk.n + 1, batch->next->clk.n);
+    batch->curr->clk.t = ch->clk.t;
+    // continuous extension of the last step, if the method has one
+    if (
+        batch->dense.valid
+        && batch->dense.x0 == batch->prev->clk.t
+        && batch->dense.x1 == batch->next->clk.t
+    ) {
+        ode_dense_eval(&batch->dense, ch->clk.t, &batch->curr->sys);
+        interp_obj_lst(size, batch->prev, batch->next, batch->curr);
+    } else
+        interp_st(size, batch->prev, batch->next, batch->curr);
+    memcpy(st, batch->curr, sizeof(struct st_s));
+    if (solve_ch(size, cfg, ch, st, batch->curr, in, em)) {
+        solve_st_delta(size, cfg, batch->curr, st, out);
+        memcpy(batch->next, st, sizeof(struct st_s));
+        batch->fsal.valid = false;
+        batch->dense.valid = false;
+        batch->multi.size = 0;
+        batch->stage.valid = false;
+        vehicle_model->stm.valid = false;
+    } else
+        solve_out(size, cfg, batch->curr, out);
+}
+
+void solve_batch(
+    size_t N, double t,
+    struct vehicle_model_s vehicle_model[static restrict N],
+    struct batch_s batch[static restrict N],
+    ode_meth_t meth,
+    const struct force_model_s* force_model
+) {
+    LOG_STATS("solve_batch", 0, 0, 0);
+    // vehicle-major order keeps each working set hot in cache
+    for (size_t i = 0; i < N; i++) {
+        vehicle_model[i].ch.clk.t = t;
+        solve_vehicle_model(&vehicle_model[i], &batch[i], meth, force_model);
+    }
+}
@@ -9,6 +9,15 @@
 #include "interp.h"
 #include "log.h"
 
+extern inline bool em(
+    size_t,
+    const struct cfg_s*,
+    const struct st_s*,
+    struct in_s* restrict,
+    const struct out_s*,
+    struct em_s* restrict
+);
+
 void interp_st(
     size_t size,
     const struct st_s* prev,
@@ -35,32 +44,30 @@ void interp_obj_lst(
     const struct st_s* next,
     struct st_s* restrict curr
 ) {
-    LOG_STATS("interp_obj_lst", 0, size, 0);
-    for (size_t idx = 0; idx < size; idx++) {
-        curr->obj_lst[idx].m = interp_lerp(
-            prev->clk.t, prev->obj_lst[idx].m,
-            next->clk.t, next->obj_lst[idx].m,
-            curr->clk.t
-        );
-        dmat_muls(
-            prev->obj_lst[idx].I_cm,
-            curr->obj_lst[idx].m / prev->obj_lst[idx].m,
-            curr->obj_lst[idx].I_cm
+    LOG_STATS("interp_obj_lst", 4, 3 * size, 0);
+    // flat per-field loops so the structure-of-arrays layout vectorizes
+    double delta_t = next->clk.t - prev->clk.t,
+           t = (curr->clk.t - prev->clk.t) / delta_t;
+    for (size_t idx = 0; idx < size; idx++)
+        curr->OBJ_LST(idx, m) = (
+            prev->OBJ_LST(idx, m) * (1.0 - t)
+            + next->OBJ_LST(idx, m) * t
         );
-        /* XXX momentum vectors not interpolated
-         *  interp_vlerp(
-         *      prev->clk.t, prev->obj_lst[idx].p_bar,
-         *      next->clk.t, next->obj_lst[idx].p_bar,
-         *      curr->clk.t, curr->obj_lst[idx].p_bar
-         *  );
-         *  interp_vlerp(
-         *      prev->clk.t, prev->obj_lst[idx].h_bar,
-         *      next->clk.t, next->obj_lst[idx].h_bar,
-         *      curr->clk.t, curr->obj_lst[idx].h_bar
-         *  );
-         */
-        vec_pos(next->obj_lst[idx].p_bar, curr->obj_lst[idx].p_bar);
-        vec_pos(next->obj_lst[idx].h_bar, curr->obj_lst[idx].h_bar);
+    for (size_t idx = 0; idx < size; idx++) {
+        double s = curr->OBJ_LST(idx, m) / prev->OBJ_LST(idx, m);
+        for (size_t i = 0; i < 3; i++)
+            curr->OBJ_LST(idx, I_cm)[i] = prev->OBJ_LST(idx, I_cm)[i] * s;
+    }
+    /* XXX momentum vectors not interpolated
+     *  interp_vlerp(
+     *      prev->clk.t, prev->OBJ_LST(idx, p_bar),
+     *      next->clk.t, next->OBJ_LST(idx, p_bar),
+     *      curr->clk.t, curr->OBJ_LST(idx, p_bar)
+     *  );
+     */
+    for (size_t idx = 0; idx < size; idx++) {
+        vec_pos(next->OBJ_LST(idx, p_bar), curr->OBJ_LST(idx, p_bar));
+        vec_pos(next->OBJ_LST(idx, h_bar), curr->OBJ_LST(idx, h_bar));
     }
 }
 
@@ -83,18 +90,81 @@ void solve_st_dot(
     quat_mul(prev->sys.q, bar, next->sys.q);
     vec_pos(prev->sys.v_bar, next->sys.v_bar);
     vec_pos(prev->sys.om_bar, next->sys.om_bar);
-    for (size_t idx = 0; idx < size; idx++) {
-        next->obj_lst[idx].m = (
-            prev->obj_lst[idx].m
-            + in->obj_lst[idx].m_dot * delta_t
-        );
-        dmat_muls(
-            prev->obj_lst[idx].I_cm,
-            next->obj_lst[idx].m / prev->obj_lst[idx].m,
-            next->obj_lst[idx].I_cm
+    for (size_t idx = 0; idx < size; idx++)
+        next->OBJ_LST(idx, m) = (
+            prev->OBJ_LST(idx, m)
+            + in->OBJ_LST(idx, m_dot) * delta_t
         );
-        vec_pos(prev->obj_lst[idx].p_bar, next->obj_lst[idx].p_bar);
-        vec_pos(prev->obj_lst[idx].h_bar, next->obj_lst[idx].h_bar);
+    for (size_t idx = 0; idx < size; idx++) {
+        double s = next->OBJ_LST(idx, m) / prev->OBJ_LST(idx, m);
+        for (size_t i = 0; i < 3; i++)
+            next->OBJ_LST(idx, I_cm)[i] = prev->OBJ_LST(idx, I_cm)[i] * s;
+    }
+    for (size_t idx = 0; idx < size; idx++) {
+        vec_pos(prev->OBJ_LST(idx, p_bar), next->OBJ_LST(idx, p_bar));
+        vec_pos(prev->OBJ_LST(idx, h_bar), next->OBJ_LST(idx, h_bar));
+    }
+}
+
+/* Derived object is current
+ * :param cfg_t* cfg: configuration structure
+ * :param size_t idx: object index
+ * :returns bool: `cfg->drv` was solved for the object as it is now
+ */
+static inline bool __match_obj(
+    const struct cfg_s* cfg,
+    size_t idx
+) {
+    return (
+        idx < cfg->drv.size
+        && !memcmp(cfg->drv.obj_lst[idx].q, cfg->OBJ_LST(idx, q), sizeof(quat_t))
+        && !memcmp(cfg->drv.obj_lst[idx].r_bar, cfg->OBJ_LST(idx, r_bar), sizeof(vec_t))
+        && !memcmp(cfg->drv.obj_lst[idx].bbox, cfg->OBJ_LST(idx, bbox), sizeof(dmat_t))
+    );
+}
+
+/* Object rotation matrix
+ * :param cfg_t* cfg: configuration structure
+ * :param size_t idx: object index
+ * :param mat_t temp: scratch matrix
+ * :returns mat_t: rotation matrix, `cfg->drv` while current, else `temp`
+ */
+static inline const double (*__obj_rot(
+    const struct cfg_s* cfg,
+    size_t idx,
+    mat_t temp
+))[3] {
+    if (__match_obj(cfg, idx))
+        return cfg->drv.obj_lst[idx].R;
+    quat_rot_mat(cfg->OBJ_LST(idx, q), temp);
+    return (void*) temp;
+}
+
+/* Solve moment of inertia
+ * :param out_t* out: output structure
+ * :param vec_t h_bar: input vector
+ * :param vec_t om_bar: output vector, solves `I_cm om_bar = h_bar`
+ *
+ * Uses the Cholesky factor cached by `solve_out`, or factors `I_cm` when
+ * the output structure was filled in by hand; falls back to the inverse
+ * when `I_cm` is not positive-definite.
+ */
+static void solve_I_cm(
+    const struct out_s* out,
+    const vec_t h_bar,
+    vec_t om_bar
+) {
+    LOG_STATS("solve_I_cm", 0, 0, 0);
+    mat_t L;
+    if (out->sys.chol)
+        mat_chol_solve((void*) out->sys.L_cm, h_bar, om_bar);
+    else if (mat_chol((void*) out->sys.I_cm, L))
+        mat_chol_solve((void*) L, h_bar, om_bar);
+    else if (mat_inv((void*) out->sys.I_cm, L))
+        mat_mulv((void*) L, h_bar, om_bar);
+    else {
+        LOG_WARNING("singular moment of inertia");
+        vec_zero(om_bar);
     }
 }
 
@@ -116,22 +186,22 @@ void solve_st_delta(
     vec_cross(out->sys.c_bar, p_bar, temp);
     vec_add(h_bar, temp, h_bar);
     for (size_t idx = 0; idx < size; idx++) {
-        vec_t foo, bar;
-        vec_sub(next->obj_lst[idx].p_bar, prev->obj_lst[idx].p_bar, temp);
-        vec_rot(cfg->obj_lst[idx].q, temp, foo);
-        vec_sub(p_bar, foo, p_bar);
-        vec_sub(next->obj_lst[idx].h_bar, prev->obj_lst[idx].h_bar, temp);
-        vec_rot(cfg->obj_lst[idx].q, temp, bar);
-        vec_cross(cfg->obj_lst[idx].r_bar, foo, temp);
-        vec_add(bar, temp, bar);
-        vec_sub(h_bar, bar, h_bar);
+        mat_t R_obj;
+        const double (*R)[3] = __obj_rot(cfg, idx, R_obj);
+        vec_t delta[2];  // momentum, angular momentum
+        vec_sub(next->OBJ_LST(idx, p_bar), prev->OBJ_LST(idx, p_bar), delta[0]);
+        vec_sub(next->OBJ_LST(idx, h_bar), prev->OBJ_LST(idx, h_bar), delta[1]);
+        mat_mulv(R, delta[0], delta[0]);
+        mat_mulv(R, delta[1], delta[1]);
+        vec_sub(p_bar, delta[0], p_bar);
+        vec_cross(cfg->OBJ_LST(idx, r_bar), delta[0], temp);
+        vec_add(delta[1], temp, delta[1]);
+        vec_sub(h_bar, delta[1], h_bar);
     }
-    mat_t eye;
     solve_out(size, cfg, next, out);
-    mat_inv((void*) out->sys.I_cm, eye);
     vec_cross(out->sys.c_bar, p_bar, temp);
     vec_sub(h_bar, temp, h_bar);
-    mat_mulv((void*) eye, h_bar, next->sys.om_bar);
+    solve_I_cm(out, h_bar, next->sys.om_bar);
     vec_cross(out->sys.c_bar, next->sys.om_bar, temp);
     vec_muls(p_bar, 1.0 / out->sys.m, p_bar);
     vec_add(p_bar, temp, p_bar);
@@ -151,40 +221,40 @@ bool solve_ch(
     for (size_t idx = 0; idx < size; idx++) {
         switch (ch->obj_lst[idx].T) {
         case E_ST:
-            LOG_WARNING("[E_ST] `%s`", cfg->obj_lst[idx].sym);
+            LOG_WARNING("[E_ST] `%s`", cfg->OBJ_LST(idx, sym));
             LOG_STATS("solve_ch[E_ST]", 2, 1, 0);
             flag = true;
-            next->obj_lst[idx].m = prev->obj_lst[idx].m
+            next->OBJ_LST(idx, m) = prev->OBJ_LST(idx, m)
                                  + ch->obj_lst[idx].u.st.m;
-            dmat_muls(prev->obj_lst[idx].I_cm,
-                      next->obj_lst[idx].m / (next->obj_lst[idx].m - ch->obj_lst[idx].u.st.m),
-                      next->obj_lst[idx].I_cm);
-            vec_add(prev->obj_lst[idx].p_bar,
+            dmat_muls(prev->OBJ_LST(idx, I_cm),
+                      next->OBJ_LST(idx, m) / (next->OBJ_LST(idx, m) - ch->obj_lst[idx].u.st.m),
+                      next->OBJ_LST(idx, I_cm));
+            vec_add(prev->OBJ_LST(idx, p_bar),
                     ch->obj_lst[idx].u.st.p_bar, 
-                    next->obj_lst[idx].p_bar);
-            vec_add(prev->obj_lst[idx].h_bar,
+                    next->OBJ_LST(idx, p_bar));
+            vec_add(prev->OBJ_LST(idx, h_bar),
                     ch->obj_lst[idx].u.st.h_bar,
-                    next->obj_lst[idx].h_bar);
+                    next->OBJ_LST(idx, h_bar));
             break;
         case E_IN:
-            LOG_WARNING("[E_IN] `%s`", cfg->obj_lst[idx].sym);
+            LOG_WARNING("[E_IN] `%s`", cfg->OBJ_LST(idx, sym));
             LOG_STATS("solve_ch[E_IN]", 0, 0, 0);
             flag = true;
-            in->obj_lst[idx].m_dot = ch->obj_lst[idx].u.in.m_dot;
+            in->OBJ_LST(idx, m_dot) = ch->obj_lst[idx].u.in.m_dot;
             vec_pos(ch->obj_lst[idx].u.in.F_bar,
-                    in->obj_lst[idx].F_bar);
+                    in->OBJ_LST(idx, F_bar));
             vec_pos(ch->obj_lst[idx].u.in.M_bar,
-                    in->obj_lst[idx].M_bar);
+                    in->OBJ_LST(idx, M_bar));
             break;
         case E_EM:
-            LOG_WARNING("[E_EM] `%s`", cfg->obj_lst[idx].sym);
+            LOG_WARNING("[E_EM] `%s`", cfg->OBJ_LST(idx, sym));
             LOG_STATS("solve_ch[E_EM]", 0, 0, 0);
             flag = true;
-            em->obj_lst[idx].q = ch->obj_lst[idx].u.em.q;
+            em->OBJ_LST(idx, q) = ch->obj_lst[idx].u.em.q;
             vec_pos(ch->obj_lst[idx].u.em.p_bar,
-                    em->obj_lst[idx].p_bar);
+                    em->OBJ_LST(idx, p_bar));
             vec_pos(ch->obj_lst[idx].u.em.m_bar,
-                    em->obj_lst[idx].m_bar);
+                    em->OBJ_LST(idx, m_bar));
             break;
         default:
             break;
@@ -203,15 +273,17 @@ void solve_in(
 ) {
     LOG_STATS("solve_in", 0, 1, 0);
     vec_t temp, foo, bar;
-    mat_t eye;
     vec_irot(st->sys.q, in->sys.F_bar, temp);
     for (size_t idx = 0; idx < size; idx++) {
-        vec_rot(cfg->obj_lst[idx].q, in->obj_lst[idx].F_bar, foo);
-        vec_add(temp, foo, temp);
-        vec_cross(cfg->obj_lst[idx].r_bar, foo, bar);
+        mat_t R_obj;
+        const double (*R)[3] = __obj_rot(cfg, idx, R_obj);
+        vec_t FM[2];  // force, torque
+        mat_mulv(R, in->OBJ_LST(idx, F_bar), FM[0]);
+        mat_mulv(R, in->OBJ_LST(idx, M_bar), FM[1]);
+        vec_add(temp, FM[0], temp);
+        vec_cross(cfg->OBJ_LST(idx, r_bar), FM[0], bar);
         vec_add(in->sys.M_bar, bar, in->sys.M_bar);
-        vec_rot(cfg->obj_lst[idx].q, in->obj_lst[idx].M_bar, foo);
-        vec_add(in->sys.M_bar, foo, in->sys.M_bar);
+        vec_add(in->sys.M_bar, FM[1], in->sys.M_bar);
     }
     // om_bar
     vec_cross(out->sys.c_bar, temp, foo);
@@ -219,8 +291,7 @@ void solve_in(
     mat_mulv(out->sys.I_cm, st->sys.om_bar, foo);
     vec_cross(st->sys.om_bar, foo, bar);
     vec_sub(in->sys.om_dot, bar, foo);
-    mat_inv((void*)out->sys.I_cm, eye);
-    mat_mulv((void*)eye, foo, in->sys.om_dot);
+    solve_I_cm(out, foo, in->sys.om_dot);
     // v_bar
     vec_rot(st->sys.q, temp, in->sys.F_bar);
     vec_cross(st->sys.om_bar, out->sys.c_bar, foo);
@@ -232,6 +303,135 @@ void solve_in(
     vec_add(in->sys.v_dot, foo, in->sys.v_dot);
 }
 
+/* Object drag matrix
+ * :param cfg_t* cfg: configuration structure
+ * :param size_t idx: object index
+ * :param mat_t R: rotation matrix (columns are the face normals)
+ * :param mat_t K: drag matrix, `R diag(A) R^T`
+ */
+static void drag_mat(
+    const struct cfg_s* cfg,
+    size_t idx,
+    const mat_t R,
+    mat_t K
+) {
+    LOG_STATS("drag_mat", 21, 30, 0);
+    const double* bbox = cfg->OBJ_LST(idx, bbox);
+    vec_t A;
+    for (size_t i = 0; i < 3; i++)
+        A[i] = bbox[(i+1)%3] * bbox[(i+2)%3];
+    for (size_t i = 0; i < 3; i++)
+        for (size_t j = 0; j < 3; j++)
+            K[i][j] = R[i][0] * A[0] * R[j][0]
+                    + R[i][1] * A[1] * R[j][1]
+                    + R[i][2] * A[2] * R[j][2];
+}
+
+bool match_cfg(
+    size_t size,
+    const struct cfg_s* cfg
+) {
+    LOG_STATS("match_cfg", 0, 0, 0);
+    if (cfg->drv.size != size)
+        return false;
+    for (size_t idx = 0; idx < size; idx++)
+        if (!__match_obj(cfg, idx))
+            return false;
+    return true;
+}
+
+bool solve_cfg(
+    size_t size,
+    struct cfg_s* restrict cfg
+) {
+    LOG_STATS("solve_cfg", 0, 0, 0);
+    bool flag = false;
+    for (size_t idx = 0; idx < size; idx++) {
+        mat_t temp;
+        if (__match_obj(cfg, idx))
+            continue;
+        quat_pos(cfg->OBJ_LST(idx, q), cfg->drv.obj_lst[idx].q);
+        vec_pos(cfg->OBJ_LST(idx, r_bar), cfg->drv.obj_lst[idx].r_bar);
+        vec_pos(cfg->OBJ_LST(idx, bbox), cfg->drv.obj_lst[idx].bbox);
+        quat_rot_mat(cfg->OBJ_LST(idx, q), cfg->drv.obj_lst[idx].R);
+        vec_cross_mat(cfg->OBJ_LST(idx, r_bar), temp);
+        mat_mul((void*) temp, (void*) temp, cfg->drv.obj_lst[idx].S);
+        drag_mat(cfg, idx, (void*) cfg->drv.obj_lst[idx].R, cfg->drv.obj_lst[idx].K);
+        flag = true;
+    }
+    if (flag || cfg->drv.size != size) {
+        cfg->drv.size = size;
+        solve_drag(size, cfg, cfg->drv.K, cfg->drv.L);
+    }
+    cfg->drv.n += flag;
+    return flag;
+}
+
+void solve_drag(
+    size_t size,
+    const struct cfg_s* cfg,
+    mat_t K,
+    mat_t L
+) {
+    LOG_STATS("solve_drag", 0, 0, 0);
+    mat_zero(K);
+    mat_zero(L);
+    for (size_t idx = 0; idx < size; idx++) {
+        LOG_STATS("solve_drag", 18, 27, 0);
+        mat_t foo, bar, temp;
+        const double (*K_obj)[3] = (void*) foo;
+        if (__match_obj(cfg, idx)) {
+            K_obj = cfg->drv.obj_lst[idx].K;
+        } else {
+            quat_rot_mat(cfg->OBJ_LST(idx, q), temp);
+            drag_mat(cfg, idx, (void*) temp, foo);
+        }
+        mat_add((void*) K, K_obj, K);
+        vec_cross_mat(cfg->OBJ_LST(idx, r_bar), temp);
+        mat_mul((void*) temp, K_obj, bar);
+        mat_add((void*) L, (void*) bar, L);
+    }
+}
+
+/* Accumulate object mass properties
+ * :param cfg_t* cfg: configuration structure
+ * :param size_t idx: object index
+ * :param double m: mass (difference)
+ * :param dmat_t I_cm: moment of inertia (difference)
+ * :param out_t* out: output structure
+ */
+static void accum_out(
+    const struct cfg_s* cfg,
+    size_t idx,
+    double m,
+    const dmat_t I_cm,
+    struct out_s* restrict out
+) {
+    LOG_STATS("accum_out", 18, 39, 0);
+    mat_t foo, bar, temp;
+    const double (*R)[3] = (void*) foo, (*S)[3] = (void*) bar;
+    if (__match_obj(cfg, idx)) {
+        R = cfg->drv.obj_lst[idx].R;
+        S = cfg->drv.obj_lst[idx].S;
+    } else {
+        quat_rot_mat(cfg->OBJ_LST(idx, q), foo);
+        vec_cross_mat(cfg->OBJ_LST(idx, r_bar), temp);
+        mat_mul((void*) temp, (void*) temp, bar);
+    }
+    out->sys.m += m;
+    for (size_t i = 0; i < 3; i++)
+        out->acc.m_bar[i] += m * cfg->OBJ_LST(idx, r_bar)[i];
+    // R diag(I) R^T - m [r_bar x]^2
+    for (size_t i = 0; i < 3; i++)
+        for (size_t j = 0; j < 3; j++)
+            out->acc.I_bar[i][j] += (
+                R[i][0] * I_cm[0] * R[j][0]
+                + R[i][1] * I_cm[1] * R[j][1]
+                + R[i][2] * I_cm[2] * R[j][2]
+                - m * S[i][j]
+            );
+}
+
 void solve_out(
     size_t size,
     const struct cfg_s* cfg,
@@ -240,30 +440,49 @@ void solve_out(
 ) {
     LOG_STATS("solve_out", 0, 1, 0);
     mat_t eye, temp;
-    out->sys.m = 0.0;
-    vec_zero(out->sys.c_bar);
-    mat_zero(out->sys.I_cm);
-    for (size_t idx = 0; idx < size; idx++) {
-        vec_t foo;
-        mat_t bar;
-        out->sys.m += st->obj_lst[idx].m;
-        vec_muls(cfg->obj_lst[idx].r_bar, st->obj_lst[idx].m, foo);
-        vec_add(out->sys.c_bar, foo, out->sys.c_bar);
-        quat_rot_mat(cfg->obj_lst[idx].q, temp);
-        dmat_muld((void*)temp, st->obj_lst[idx].I_cm, bar);
-        mat__T((void*)temp, temp);
-        mat_mul((void*)bar, (void*)temp, eye);
-        mat_add((void*)out->sys.I_cm, (void*)eye, out->sys.I_cm);
-        vec_cross_mat(cfg->obj_lst[idx].r_bar, temp);
-        mat_mul((void*)temp, (void*)temp, eye);
-        mat_muls((void*)eye, st->obj_lst[idx].m, eye);
-        mat_sub((void*)out->sys.I_cm, (void*)eye, out->sys.I_cm);
+    if (
+        out->acc.size != size
+        || out->acc.gen != cfg->drv.n
+        || out->acc.n >= MAX_DELTA_COUNT
+        || !match_cfg(size, cfg)
+    ) {
+        out->sys.m = 0.0;
+        vec_zero(out->acc.m_bar);
+        mat_zero(out->acc.I_bar);
+        for (size_t idx = 0; idx < size; idx++) {
+            accum_out(
+                cfg, idx,
+                st->OBJ_LST(idx, m), st->OBJ_LST(idx, I_cm),
+                out
+            );
+            out->acc.obj_lst[idx].m = st->OBJ_LST(idx, m);
+            vec_pos(st->OBJ_LST(idx, I_cm), out->acc.obj_lst[idx].I_cm);
+        }
+        out->acc.size = size;
+        out->acc.n = 0;
+        out->acc.gen = cfg->drv.n;
+    } else {
+        size_t n = out->acc.n;
+        for (size_t idx = 0; idx < size; idx++) {
+            double m = st->OBJ_LST(idx, m) - out->acc.obj_lst[idx].m;
+            dmat_t I_cm;
+            vec_sub(st->OBJ_LST(idx, I_cm), out->acc.obj_lst[idx].I_cm, I_cm);
+            if (m == 0.0 && I_cm[0] == 0.0 && I_cm[1] == 0.0 && I_cm[2] == 0.0)
+                continue;
+            accum_out(cfg, idx, m, I_cm, out);
+            out->acc.obj_lst[idx].m = st->OBJ_LST(idx, m);
+            vec_pos(st->OBJ_LST(idx, I_cm), out->acc.obj_lst[idx].I_cm);
+            out->acc.n++;
+        }
+        if (out->acc.n == n)
+            return;  // mass properties (and factor) unchanged
     }
-    vec_muls(out->sys.c_bar, 1.0 / out->sys.m, out->sys.c_bar);
+    vec_muls(out->acc.m_bar, 1.0 / out->sys.m, out->sys.c_bar);
     vec_cross_mat(out->sys.c_bar, temp);
     mat_mul((void*)temp, (void*)temp, eye);
     mat_muls((void*)eye, out->sys.m, eye);
-    mat_add((void*)out->sys.I_cm, (void*)eye, out->sys.I_cm);
+    mat_add((void*)out->acc.I_bar, (void*)eye, out->sys.I_cm);
+    out->sys.chol = mat_chol((void*)out->sys.I_cm, out->sys.L_cm);
 }
 
 void solve_em(
@@ -277,36 +496,47 @@ void solve_em(
     vec_zero(em->sys.p_bar);
     vec_zero(em->sys.m_bar);
     for (size_t idx = 0; idx < size; idx++) {
-        em->sys.q += em->obj_lst[idx].q;
-        vec_muls(cfg->obj_lst[idx].r_bar, em->obj_lst[idx].q, temp);
-        vec_add(em->sys.p_bar, temp, em->sys.p_bar);
-        vec_rot(cfg->obj_lst[idx].q, em->obj_lst[idx].p_bar, temp);
+        em->sys.q += em->OBJ_LST(idx, q);
+        vec_muls(cfg->OBJ_LST(idx, r_bar), em->OBJ_LST(idx, q), temp);
         vec_add(em->sys.p_bar, temp, em->sys.p_bar);
-        vec_rot(cfg->obj_lst[idx].q, em->obj_lst[idx].m_bar, temp);
-        vec_add(em->sys.m_bar, temp, em->sys.m_bar);
+        mat_t R_obj;
+        const double (*R)[3] = __obj_rot(cfg, idx, R_obj);
+        vec_t pm[2];  // electric, magnetic dipole moments
+        mat_mulv(R, em->OBJ_LST(idx, p_bar), pm[0]);
+        mat_mulv(R, em->OBJ_LST(idx, m_bar), pm[1]);
+        vec_add(em->sys.p_bar, pm[0], em->sys.p_bar);
+        vec_add(em->sys.m_bar, pm[1], em->sys.m_bar);
     }
 }
 
-bool em(
+bool em_jac(
     size_t size __attribute__((unused)),
     const struct cfg_s* cfg __attribute__((unused)),
     const struct st_s* st,
-    struct in_s* restrict in,
+    struct jac_s* restrict jac,
     const struct out_s* out __attribute__((unused)),
-    struct em_s* restrict em
+    const struct em_s* em
 ) {
-    LOG_STATS("em", 0, 0, 0);
-    vec_t foo, bar;
-    vec_cross(st->sys.v_bar, em->sys.B_bar, foo);
-    vec_add(em->sys.E_bar, foo, foo);
-    vec_muls(foo, em->sys.q, foo);
-    vec_add(in->sys.F_bar, foo, in->sys.F_bar);
-    vec_rot(st->sys.q, em->sys.p_bar, foo);
-    vec_cross(foo, em->sys.E_bar, bar);
-    vec_add(in->sys.M_bar, bar, in->sys.M_bar);
-    vec_rot(st->sys.q, em->sys.m_bar, foo);
-    vec_cross(foo, em->sys.B_bar, bar);
-    vec_add(in->sys.M_bar, bar, in->sys.M_bar);
+    LOG_STATS("em_jac", 0, 0, 0);
+    mat_t R, A, B, C;
+    // F_bar = q (E_bar + v_bar x B_bar)
+    vec_cross_mat(em->sys.B_bar, A);
+    mat_muls((void*) A, - em->sys.q, A);
+    jac_add(jac->F_bar, 6, (void*) A);
+    // M_bar = (R p_bar) x E_bar + (R m_bar) x B_bar, d(R u) / d th = - 2 R [u]x
+    quat_rot_mat(st->sys.q, R);
+    vec_cross_mat(em->sys.p_bar, A);
+    mat_mul((void*) R, (void*) A, B);
+    vec_cross_mat(em->sys.E_bar, A);
+    mat_mul((void*) A, (void*) B, C);
+    mat_muls((void*) C, 2.0, C);
+    jac_add(jac->M_bar, 3, (void*) C);
+    vec_cross_mat(em->sys.m_bar, A);
+    mat_mul((void*) R, (void*) A, B);
+    vec_cross_mat(em->sys.B_bar, A);
+    mat_mul((void*) A, (void*) B, C);
+    mat_muls((void*) C, 2.0, C);
+    jac_add(jac->M_bar, 3, (void*) C);
     return true;
 }
 
@@ -315,42 +545,123 @@ apply_force_model(
     double x,
     const st_t* y,
     st_t* restrict f,
-    size_t nargs,
-    va_list* vargs
+    struct ivp_s* ivp
 ) {
     LOG_STATS("apply_force_model", 0, 0, 0);
-    assert(nargs >= 9);
-    size_t size                = va_arg(*vargs, size_t);
-    const struct cfg_s* cfg    = va_arg(*vargs, void*);
-    const struct st_s* prev    = va_arg(*vargs, void*);
-    const struct st_s* next    = va_arg(*vargs, void*);
-    struct st_s* restrict st   = va_arg(*vargs, void*);
-    struct in_s* restrict in   = va_arg(*vargs, void*);
-    struct out_s* restrict out = va_arg(*vargs, void*);
-    struct em_s* restrict em   = va_arg(*vargs, void*);
-    const struct force_model_s* force_model = va_arg(*vargs, void*);
-    // copy `st_s` from input `g_vec`
-    st->clk.t = x;
-    memcpy(&st->sys, y, sizeof(st_t));
-    interp_obj_lst(size, prev, next, st);
-    // XXX reset force/torque first
-    vec_zero(in->sys.F_bar);
-    vec_zero(in->sys.M_bar);
-    vec_zero(em->sys.E_bar);
-    vec_zero(em->sys.B_bar);
-    solve_out(size, cfg, st, out);
+    const struct force_model_s* force_model = ivp->force_model;
+    begin_force_model(x, y, ivp);
+    for (size_t idx = 0; idx < force_model->size; idx++) {
+        if (force_model->fun_lst[idx] == NULL)
+            continue;
+        FORCE_MODEL_APPLY(force_model->fun_lst[idx]);
+    }
+    end_force_model(f, ivp);
+}
+
+void
+jacobian_force_model(
+    double x,
+    const st_t* y,
+    st_t* restrict k,
+    double J[ODE_JAC_SIZE][ODE_JAC_SIZE],
+    struct ivp_s* ivp
+) {
+    LOG_STATS("jacobian_force_model", 0, 0, 0);
+    const struct force_model_s* force_model = ivp->force_model;
+    const struct out_s* out = ivp->out;
+    struct jac_s jac;
+    st_t f;
+    vec_t F_bar, a_bar, h_bar, foo, bar;
+    // force functions first (the partials use their fields), split into
+    // forces with and without partials
+    begin_force_model(x, y, ivp);
+    vec_zero(F_bar);
+    vec_zero(a_bar);
     for (size_t idx = 0; idx < force_model->size; idx++) {
         if (force_model->fun_lst[idx] == NULL)
             continue;
-        force_model->fun_lst[idx](size, cfg, st, in, out, em);
+        vec_pos(ivp->in->sys.F_bar, foo);
+        FORCE_MODEL_APPLY(force_model->fun_lst[idx]);
+        vec_sub(ivp->in->sys.F_bar, foo, foo);
+        if (force_model->jac_lst[idx] != NULL)
+            vec_add(F_bar, foo, F_bar);
+        else
+            vec_add(a_bar, foo, a_bar);
+    }
+    vec_irot(y->q, F_bar, F_bar);
+    memset(&jac, 0, sizeof(jac));
+    for (size_t idx = 0; idx < force_model->size; idx++) {
+        if (force_model->jac_lst[idx] == NULL)
+            continue;
+        force_model->jac_lst[idx](
+            ivp->size, ivp->cfg, ivp->curr, &jac, out, ivp->em
+        );
+    }
+    end_force_model(&f, ivp);
+    if (k != NULL)
+        st_pos(&f, k);
+    // body acceleration, less the (inertial) forces without partials
+    vec_muls(a_bar, 1.0 / out->sys.m, a_bar);
+    vec_sub(f.v_bar, a_bar, a_bar);
+    vec_irot(y->q, a_bar, a_bar);
+    mat_mulv((void*) out->sys.I_cm, y->om_bar, h_bar);
+    memset(J, 0, ODE_JAC_SIZE * sizeof(J[0]));
+    for (size_t i = 0; i < 3; i++) {
+        J[0 + i][6 + i] = 1.0;  // r_dot = v_bar
+        J[3 + i][9 + i] = 0.5;  // th_dot = om_bar / 2
+    }
+    // chain rule through `solve_in`, one column at a time
+    for (size_t j = 0; j < ODE_JAC_SIZE; j++) {
+        LOG_STATS("jacobian_force_model", 12, 30, 0);
+        vec_t e_bar = {0.0, 0.0, 0.0}, dF_bar, dM_bar, dom_bar, da_bar;
+        for (size_t i = 0; i < 3; i++) {
+            dF_bar[i] = jac.F_bar[i][j];
+            dM_bar[i] = jac.M_bar[i][j];
+        }
+        // temp = R^T F_bar, d(R^T u) / d th = 2 [R^T u]x
+        vec_irot(y->q, dF_bar, dF_bar);
+        if (3 <= j && j < 6) {
+            e_bar[j - 3] = 1.0;
+            vec_cross(F_bar, e_bar, foo);
+            vec_muls(foo, 2.0, foo);
+            vec_add(dF_bar, foo, dF_bar);
+        }
+        // om_dot = I_cm^-1 (M_bar - c_bar x temp - om_bar x I_cm om_bar)
+        vec_cross(out->sys.c_bar, dF_bar, foo);
+        vec_sub(dM_bar, foo, dM_bar);
+        if (9 <= j) {
+            e_bar[j - 9] = 1.0;
+            mat_mulv((void*) out->sys.I_cm, e_bar, foo);
+            vec_cross(y->om_bar, foo, bar);
+            vec_sub(dM_bar, bar, dM_bar);
+            vec_cross(e_bar, h_bar, foo);
+            vec_sub(dM_bar, foo, dM_bar);
+        }
+        solve_I_cm(out, dM_bar, dom_bar);
+        // v_dot = R (c_bar x om_dot - om_bar x (om_bar x c_bar) + temp / m)
+        vec_cross(out->sys.c_bar, dom_bar, da_bar);
+        vec_muls(dF_bar, 1.0 / out->sys.m, foo);
+        vec_add(da_bar, foo, da_bar);
+        if (9 <= j) {
+            vec_cross(y->om_bar, out->sys.c_bar, foo);
+            vec_cross(e_bar, foo, bar);
+            vec_sub(da_bar, bar, da_bar);
+            vec_cross(e_bar, out->sys.c_bar, foo);
+            vec_cross(y->om_bar, foo, bar);
+            vec_sub(da_bar, bar, da_bar);
+        }
+        // d(R u) / d th = - 2 R [u]x
+        if (3 <= j && j < 6) {
+            vec_cross(a_bar, e_bar, foo);
+            vec_muls(foo, 2.0, foo);
+            vec_sub(da_bar, foo, da_bar);
+        }
+        vec_rot(y->q, da_bar, da_bar);
+        for (size_t i = 0; i < 3; i++) {
+            J[6 + i][j] = da_bar[i];
+            J[9 + i][j] = dom_bar[i];
+        }
     }
-    solve_in(size, cfg, st, in, out);
-    // copy `in_s` from output `g_vec`
-    vec_pos(st->sys.v_bar, f->r_bar);
-    vec_muls(st->sys.om_bar, 0.5, &f->q[1]);
-    vec_exp(&f->q[1], f->q);
-    vec_pos(in->sys.v_dot, f->v_bar);
-    vec_pos(in->sys.om_dot, f->om_bar);
 }
 
 bool
@@ -358,7 +669,7 @@ adjust_time_step(
     const st_t* y0,
     const st_t* y1,
     const st_t* y2,
-    int q, size_t nargs, va_list* vargs
+    int q, struct ivp_s* ivp
 ) {
     LOG_STATS("adjust_time_step", 2 * 13, 2 + 13, 1);
     vec_t temp;
@@ -385,10 +696,7 @@ adjust_time_step(
     err = vec_norm(temp);
     tol = ABSTOL + RELTOL * MAX(vec_norm(y0->om_bar), vec_norm(y1->om_bar));
     E = MAX(E, err / tol);
-    assert(nargs >= 2);  // we only care about `cfg_s`
-    va_arg(*vargs, size_t);
-    struct cfg_s* restrict cfg = va_arg(*vargs, void*);
-    cfg->clk.delta_t *= 0.9 * MAX(0.5, MIN(pow(E, -1.0 / (q + 1)), 2.0));
+    ivp->cfg->clk.delta_t *= 0.9 * MAX(0.5, MIN(pow(E, -1.0 / (q + 1)), 2.0));
     return E <= 1.0;
 }
 
@@ -0,0 +1,54 @@
+#include <stddef.h>
+#include "fused.h"
+#include "gee.h"
+#include "stdatm.h"
+#include "util.h"
+#include "log.h"
+
+FUNCTION_FORCE_MODEL_FUSED(gee_fast,
+    FORCE_MODEL_APPLY(gee_fast);
+)
+
+FUNCTION_FORCE_MODEL_FUSED(gee_fast_stdatm,
+    FORCE_MODEL_APPLY(gee_fast);
+    FORCE_MODEL_APPLY(stdatm);
+)
+
+FUNCTION_FORCE_MODEL_FUSED(geoall_em,
+    FORCE_MODEL_APPLY(geoall);
+    FORCE_MODEL_APPLY(em);
+)
+
+#define FUSED_COUNT 4
+
+static const struct {
+    ode_fun_t accum_fun;
+    size_t size;
+    force_fun_t fun_lst[FUSED_COUNT];
+} __fused_lst[] = {
+    {FORCE_MODEL_NAME(gee_fast), 1, {gee_fast}},
+    {FORCE_MODEL_NAME(gee_fast_stdatm), 2, {gee_fast, stdatm}},
+    {FORCE_MODEL_NAME(geoall_em), 2, {geoall, em}},
+};
+
+ode_fun_t select_force_model(const struct force_model_s* force_model)
+{
+    LOG_STATS("select_force_model", 0, 0, 0);
+    force_fun_t fun_lst[FUSED_COUNT];
+    size_t size = 0;
+    for (size_t idx = 0; idx < force_model->size; idx++) {
+        if (force_model->fun_lst[idx] == NULL)
+            continue;
+        if (size == FUSED_COUNT)
+            return apply_force_model;
+        fun_lst[size++] = force_model->fun_lst[idx];
+    }
+    for (size_t i = 0; i < sizeof(__fused_lst) / sizeof(__fused_lst[0]); i++) {
+        bool flag = (__fused_lst[i].size == size);
+        for (size_t j = 0; flag && j < size; j++)
+            flag = (__fused_lst[i].fun_lst[j] == fun_lst[j]);
+        if (flag)
+            return __fused_lst[i].accum_fun;
+    }
+    return apply_force_model;
+}
@@ -1,7 +1,10 @@
 #include <math.h>
+#include <string.h>
+#include <stdint.h>
 #include "gee.h"
 #include "geopot.h"
 #include "geomag.h"
+#include "force_model.h"
 #include "vec.h"
 #include "mat.h"
 #include "quat.h"
@@ -11,6 +14,15 @@
 #include "util.h"
 #include "log.h"
 
+extern inline bool gee_fast(
+    size_t,
+    const struct cfg_s*,
+    const struct st_s*,
+    struct in_s* restrict,
+    const struct out_s*,
+    struct em_s* restrict
+);
+
 static const struct poly_s __th_G0 = {.deg=3, .coeff={
     100.4606184,
     36000.77004,
@@ -18,10 +30,29 @@ static const struct poly_s __th_G0 = {.deg=3, .coeff={
     -2.583e-8
 }};
 
+/* Earth rotation cache
+ * Direct-mapped on the time, per thread, so vehicles of a batch (or of a
+ * pool worker) stepping through the same times share the rotation.
+ */
+#define G_I2F_SIZE 16
+static __thread struct {
+    bool valid;
+    double t;
+    quat_t q;
+} __gee_i2f_lst[G_I2F_SIZE];
+
 void gee_quat_i2f(
     const struct st_s* st,
     quat_t q
 ) {
+    LOG_STATS("gee_quat_i2f", 0, 0, 0);
+    uint64_t bits;
+    memcpy(&bits, &st->clk.t, sizeof(double));
+    size_t i = (bits * 0x9E3779B97F4A7C15ull) >> 60;  // (`G_I2F_SIZE`)
+    if (__gee_i2f_lst[i].valid && __gee_i2f_lst[i].t == st->clk.t) {
+        quat_pos(__gee_i2f_lst[i].q, q);
+        return;
+    }
     LOG_STATS("gee_quat_i2f", 6, 7, 0);
     double JD = st->clk.t / 86400 + 2440587.5,
            J0 = floor(JD + 0.5) - 0.5,
@@ -30,32 +61,158 @@ void gee_quat_i2f(
            th_G = poly_eval(&__th_G0, T0) + (360.98564724 / 24.0) * UT;
     vec_t foo = {0.0, 0.0, 0.5 * th_G * M_PI_180};
     vec_exp(foo, q);
+    __gee_i2f_lst[i].valid = true;
+    __gee_i2f_lst[i].t = st->clk.t;
+    quat_pos(q, __gee_i2f_lst[i].q);
 }
 
-bool gee_f2d(const vec_t r_bar, double* lat, double* lon, double* alt) {
-    LOG_STATS("gee_f2d", 5, 14, 5);
-    double p__2 = r_bar[0] * r_bar[0] + r_bar[1] * r_bar[1],
-           p = sqrt(p__2),
-           z = r_bar[2],
-           z__2 = z * z,
-           e__2 = (2.0 - 1.0 / G_INVF) / G_INVF,
-           ae__2 = G_RMAX * e__2,
-           inv_k0 = pow(1 - 1.0 / G_INVF, 2.0),
-           k = 1.0 / inv_k0;
-    bool done = false;
-    for (size_t n = 0; n < 50; n++) {
-        LOG_STATS("gee_f2d", 5, 10, 1);
-        double c = pow(p__2 + inv_k0 * z__2 * k * k, 1.5) / ae__2;
-        double delta_k = (c + inv_k0 * z__2 * k * k * k) / (c - p__2) - k;
-        k += delta_k;
-        done = fabs(delta_k) < ABSTOL + RELTOL * fabs(k);
-        if (done)
-            break;
+/* ECEF to geodetic, closed form (Vermeille, 2002 and 2011)
+ * :param double P__2: square of the distance from the axis
+ * :param double z: distance from the equatorial plane
+ * :param double* lat: geodetic latitude
+ * :param double* alt: geodetic altitude
+ *
+ * `u` is the root of a cubic, `u = r (1 + t + 1 / t)` outside the evolute
+ * of the ellipsoid (`r > 0`, all but the ~43km around the center). With
+ * `t + 1 / t = 2 c`, `c` solves `4 c^3 - 3 c = 1 + s`; for `s < 1e-2`
+ * (the surface is at `s < 7e-4`) its series replaces the cube root.
+ * With `k = K / 2v` the altitude takes one division.
+ */
+static inline void __gee_f2d(double P__2, double z, double* lat, double* alt) {
+    LOG_STATS("gee_f2d", 16, 33, 3);
+    const double e__2 = (2.0 - 1.0 / G_INVF) / G_INVF,
+                 e__4 = e__2 * e__2;
+    double p = P__2 / (G_RMAX * G_RMAX),
+           q = (1.0 - e__2) * z * z / (G_RMAX * G_RMAX),
+           r = (p + q - e__4) / 6.0,
+           e__4pq = e__4 * p * q,
+           s = e__4pq / (4.0 * r * r * r),
+           u;
+    if (r > 0.0 && s < 1e-2) {
+        double c_1 = s * (1.0 / 9.0 + s * (- 4.0 / 243.0 + s * (28.0 / 6561.0
+                   + s * (- 80.0 / 59049.0 + s * (2288.0 / 4782969.0
+                   + s * (- 23296.0 / 129140163.0))))));
+        u = r * (3.0 + 2.0 * c_1);
+    } else if (r > 0.0) {
+        LOG_STATS("gee_f2d", 3, 2, 2);
+        double t = cbrt(1.0 + s + sqrt(s * (2.0 + s)));
+        u = r * (1.0 + t + 1.0 / t);
+    } else {
+        LOG_STATS("gee_f2d", 4, 6, 3);
+        double ev = 8.0 * r * r * r + e__4pq;
+        if (ev > 0.0) {
+            double foo = cbrt(sqrt(ev) + sqrt(e__4pq)),
+                   bar = cbrt(sqrt(ev) - sqrt(e__4pq));
+            u = r + 0.5 * foo * foo + 0.5 * bar * bar;
+        } else {
+            double th = atan2(sqrt(- s * (2.0 + s)), 1.0 + s) / 3.0;
+            u = r * (1.0 + 2.0 * cos(th + 2.0 * M_PI / 3.0));
+        }
     }
-    if (lat != NULL) *lat = atan(k * z / p);
+    double v = sqrt(u * u + e__4 * q),
+           A = u + v - q,
+           K = sqrt(4.0 * v * v * (u + v) + e__4 * A * A) - e__2 * A,
+           B = K + 2.0 * v * e__2;
+    if (lat != NULL) *lat = atan2(z * B, K * sqrt(P__2));
+    if (alt != NULL) *alt = (K + 2.0 * v * (e__2 - 1.0)) * sqrt(K * K * P__2 + z * z * B * B) / (K * B);
+}
+
+bool gee_f2d(const vec_t r_bar, double* lat, double* lon, double* alt) {
+    LOG_STATS("gee_f2d", 1, 2, 0);
+    double P__2 = r_bar[0] * r_bar[0] + r_bar[1] * r_bar[1];
+    if (P__2 + r_bar[2] * r_bar[2] < ABSTOL * ABSTOL)
+        return false;
+    __gee_f2d(P__2, r_bar[2], lat, alt);
     if (lon != NULL) *lon = atan2(r_bar[1], r_bar[0]);
-    if (alt != NULL) *alt = (1.0 / k - inv_k0) * sqrt(p__2 + z__2 * k * k) / e__2;
-    return done;
+    return true;
+}
+
+void gee_f2d_n(
+    size_t n, const vec_t r_lst[],
+    double lat[], double lon[], double alt[]
+) {
+    LOG_STATS("gee_f2d_n", 0, 0, 0);
+    size_t i = 0;
+#if defined SIMD_SSE2
+    // pairs of positions on the series branch of `__gee_f2d`
+    const double e__2 = (2.0 - 1.0 / G_INVF) / G_INVF,
+                 e__4 = e__2 * e__2;
+    const __m128d zero = _mm_setzero_pd();
+    for (; i + 1 < n; i += 2) {
+        LOG_STATS("gee_f2d_n", 16, 34, 3);
+        __m128d x = _mm_set_pd(r_lst[i+1][0], r_lst[i][0]),
+                y = _mm_set_pd(r_lst[i+1][1], r_lst[i][1]),
+                z = _mm_set_pd(r_lst[i+1][2], r_lst[i][2]),
+                P__2 = _mm_add_pd(_mm_mul_pd(x, x), _mm_mul_pd(y, y)),
+                z__2 = _mm_mul_pd(z, z),
+                p = _mm_div_pd(P__2, _mm_set1_pd(G_RMAX * G_RMAX)),
+                q = _mm_div_pd(_mm_mul_pd(_mm_mul_pd(_mm_set1_pd(1.0 - e__2), z), z), _mm_set1_pd(G_RMAX * G_RMAX)),
+                r = _mm_div_pd(_mm_sub_pd(_mm_add_pd(p, q), _mm_set1_pd(e__4)), _mm_set1_pd(6.0)),
+                s = _mm_div_pd(
+                    _mm_mul_pd(_mm_mul_pd(_mm_set1_pd(e__4), p), q),
+                    _mm_mul_pd(_mm_mul_pd(_mm_mul_pd(_mm_set1_pd(4.0), r), r), r)
+                );
+        if (_mm_movemask_pd(_mm_and_pd(
+                _mm_cmpgt_pd(r, zero), _mm_cmplt_pd(s, _mm_set1_pd(1e-2))
+            )) != 3) {
+            for (size_t k = i; k < i + 2; k++)
+                gee_f2d(
+                    r_lst[k],
+                    (lat != NULL) ? &lat[k] : NULL,
+                    (lon != NULL) ? &lon[k] : NULL,
+                    (alt != NULL) ? &alt[k] : NULL
+                );
+            continue;
+        }
+        __m128d c_1 = _mm_set1_pd(- 23296.0 / 129140163.0);
+        c_1 = _mm_add_pd(_mm_set1_pd(2288.0 / 4782969.0), _mm_mul_pd(s, c_1));
+        c_1 = _mm_add_pd(_mm_set1_pd(- 80.0 / 59049.0), _mm_mul_pd(s, c_1));
+        c_1 = _mm_add_pd(_mm_set1_pd(28.0 / 6561.0), _mm_mul_pd(s, c_1));
+        c_1 = _mm_add_pd(_mm_set1_pd(- 4.0 / 243.0), _mm_mul_pd(s, c_1));
+        c_1 = _mm_add_pd(_mm_set1_pd(1.0 / 9.0), _mm_mul_pd(s, c_1));
+        c_1 = _mm_mul_pd(s, c_1);
+        __m128d u = _mm_mul_pd(r, _mm_add_pd(_mm_set1_pd(3.0), _mm_mul_pd(_mm_set1_pd(2.0), c_1))),
+                v = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(u, u), _mm_mul_pd(_mm_set1_pd(e__4), q))),
+                uv = _mm_add_pd(u, v),
+                A = _mm_sub_pd(uv, q),
+                K = _mm_sub_pd(
+                    _mm_sqrt_pd(_mm_add_pd(
+                        _mm_mul_pd(_mm_mul_pd(_mm_mul_pd(_mm_set1_pd(4.0), v), v), uv),
+                        _mm_mul_pd(_mm_mul_pd(_mm_set1_pd(e__4), A), A)
+                    )),
+                    _mm_mul_pd(_mm_set1_pd(e__2), A)
+                ),
+                B = _mm_add_pd(K, _mm_mul_pd(_mm_mul_pd(_mm_set1_pd(2.0), v), _mm_set1_pd(e__2)));
+        if (alt != NULL) {
+            __m128d foo = _mm_add_pd(K, _mm_mul_pd(_mm_mul_pd(_mm_set1_pd(2.0), v), _mm_set1_pd(e__2 - 1.0))),
+                    bar = _mm_sqrt_pd(_mm_add_pd(
+                        _mm_mul_pd(_mm_mul_pd(K, K), P__2),
+                        _mm_mul_pd(_mm_mul_pd(z__2, B), B)
+                    ));
+            _mm_storeu_pd(&alt[i], _mm_div_pd(_mm_mul_pd(foo, bar), _mm_mul_pd(K, B)));
+        }
+        if (lat != NULL) {
+            double zB[2], KP[2];
+            _mm_storeu_pd(zB, _mm_mul_pd(z, B));
+            _mm_storeu_pd(KP, _mm_mul_pd(K, _mm_sqrt_pd(P__2)));
+            lat[i] = atan2(zB[0], KP[0]);
+            lat[i+1] = atan2(zB[1], KP[1]);
+        }
+        if (lon != NULL) {
+            lon[i] = atan2(r_lst[i][1], r_lst[i][0]);
+            lon[i+1] = atan2(r_lst[i+1][1], r_lst[i+1][0]);
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        LOG_STATS("gee_f2d_n", 1, 2, 0);
+        __gee_f2d(
+            r_lst[i][0] * r_lst[i][0] + r_lst[i][1] * r_lst[i][1], r_lst[i][2],
+            (lat != NULL) ? &lat[i] : NULL,
+            (alt != NULL) ? &alt[i] : NULL
+        );
+        if (lon != NULL) lon[i] = atan2(r_lst[i][1], r_lst[i][0]);
+    }
 }
 
 bool inv_sq_law(const vec_t r_bar, double* r__2, double* g) {
@@ -104,6 +261,75 @@ void sph_harm(
     }
 }
 
+bool gee_sph(const vec_t r_bar, struct env_s* restrict env) {
+    LOG_STATS("gee_sph", 0, 7, 2);
+    double r = vec_norm(r_bar);
+    if (r < ABSTOL)
+        return false;
+    // convert position to spherical coordinates
+    double a = sqrt(r_bar[0] * r_bar[0] + r_bar[1] * r_bar[1]) / r;
+    env->r = r;
+    env->a = a;
+    env->z = r_bar[2] / r;
+    if (a > ABSTOL) {
+        env->x = r_bar[0] / r / a;
+        env->y = r_bar[1] / r / a;
+    } else {
+        env->x = r_bar[0] / r * a;
+        env->y = r_bar[1] / r * a;
+    }
+    sph_harm(r, a, env->x, env->y, env->z, env->R, env->P, env->Q, env->C, env->S);
+    return true;
+}
+
+const struct env_s* gee_env(
+    const struct st_s* st,
+    const struct out_s* out,
+    struct in_s* restrict in,
+    unsigned flags
+) {
+    LOG_STATS("gee_env", 0, 0, 0);
+    struct env_s* env = &in->env;
+    vec_t r_bar;
+    // parts are kept only while the state is the one they were computed for
+    if (
+        memcmp(&env->key.t, &st->clk.t, sizeof(double))
+        || memcmp(env->key.r_bar, st->sys.r_bar, sizeof(vec_t))
+        || memcmp(env->key.q, st->sys.q, sizeof(quat_t))
+        || memcmp(env->key.c_bar, out->sys.c_bar, sizeof(vec_t))
+    ) {
+        env->flags = 0;
+        env->key.t = st->clk.t;
+        vec_pos(st->sys.r_bar, env->key.r_bar);
+        quat_pos(st->sys.q, env->key.q);
+        vec_pos(out->sys.c_bar, env->key.c_bar);
+    }
+    flags &= ~env->flags;
+    // rotate position into ECEF frame
+    if (flags & (ENV_FRAME | ENV_HARM) && !(env->flags & ENV_FRAME)) {
+        gee_quat_i2f(st, env->q_i2f);
+        vec_rot(st->sys.q, out->sys.c_bar, r_bar);
+        vec_add(st->sys.r_bar, r_bar, r_bar);
+        vec_irot(env->q_i2f, r_bar, env->r_bar);
+        env->flags |= ENV_FRAME;
+    }
+    if (flags & ENV_HARM) {
+        if (!gee_sph(env->r_bar, env))
+            return NULL;
+        env->flags |= ENV_HARM;
+    }
+    // the altitude does not depend on the Earth rotation (ECI will do)
+    if (flags & ENV_ALT) {
+        if (!(env->flags & ENV_FRAME)) {
+            vec_rot(st->sys.q, out->sys.c_bar, r_bar);
+            vec_add(st->sys.r_bar, r_bar, r_bar);
+        }
+        gee_f2d((env->flags & ENV_FRAME) ? env->r_bar : r_bar, NULL, NULL, &env->alt);
+        env->flags |= ENV_ALT;
+    }
+    return env;
+}
+
 bool gee(
     size_t size,
     const struct cfg_s* cfg,
@@ -118,18 +344,18 @@ bool gee(
     vec_irot(st->sys.q, st->sys.r_bar, c_bar);
     for (size_t idx = 0; idx < size; idx++) {
         vec_t r_bar, foo, bar;
-        vec_add(c_bar, cfg->obj_lst[idx].r_bar, r_bar);
+        vec_add(c_bar, cfg->OBJ_LST(idx, r_bar), r_bar);
         // gravity
         double r__2, g;
         if (!inv_sq_law(r_bar, &r__2, &g))
             return false;
         // point mass
-        vec_muls(r_bar, - st->obj_lst[idx].m * g, foo);
+        vec_muls(r_bar, - st->OBJ_LST(idx, m) * g, foo);
         vec_add(temp, foo, temp);
-        vec_cross(cfg->obj_lst[idx].r_bar, foo, bar);
+        vec_cross(cfg->OBJ_LST(idx, r_bar), foo, bar);
         vec_add(in->sys.M_bar, bar, in->sys.M_bar);
         // rigid body
-        dmat_mulv(st->obj_lst[idx].I_cm, r_bar, foo);
+        dmat_mulv(st->OBJ_LST(idx, I_cm), r_bar, foo);
         vec_cross(r_bar, foo, bar);
         vec_muls(bar, 3.0 * g / r__2, bar);
         vec_add(in->sys.M_bar, bar, in->sys.M_bar);
@@ -139,67 +365,95 @@ bool gee(
     return true;
 }
 
-bool gee_fast(
+bool gee_grad(double m, const vec_t r_bar, mat_t G) {
+    LOG_STATS("gee_grad", 9, 12, 0);
+    double r__2, g;
+    if (!inv_sq_law(r_bar, &r__2, &g))
+        return false;
+    // m g (3 r r^T / r^2 - I)
+    for (size_t i = 0; i < 3; i++)
+        for (size_t j = 0; j < 3; j++)
+            G[i][j] = m * g * (3.0 * r_bar[i] * r_bar[j] / r__2 - (i == j));
+    return true;
+}
+
+bool gee_fast_jac(
     size_t size __attribute__((unused)),
     const struct cfg_s* cfg __attribute__((unused)),
     const struct st_s* st,
-    struct in_s* restrict in,
+    struct jac_s* restrict jac,
     const struct out_s* out,
-    struct em_s* restrict em __attribute__((unused))
+    const struct em_s* em __attribute__((unused))
 ) {
-    LOG_STATS("gee_fast", 2, 2, 0);
+    LOG_STATS("gee_fast_jac", 0, 3, 0);
     vec_t r_bar, foo, bar;
+    mat_t R, R_T, T, G, A, B, C;
+    quat_rot_mat(st->sys.q, R);
+    mat__T((void*) R, R_T);
     vec_irot(st->sys.q, st->sys.r_bar, r_bar);
+    // r_bar (body) = R^T r_bar + c_bar, d(R^T u) / d th = 2 [R^T u]x
+    vec_cross_mat(r_bar, T);
+    mat_muls((void*) T, 2.0, T);
     vec_add(r_bar, out->sys.c_bar, r_bar);
-    // gravity
     double r__2, g;
-    if (!inv_sq_law(r_bar, &r__2, &g))
+    if (!inv_sq_law(r_bar, &r__2, &g) || !gee_grad(out->sys.m, r_bar, G))
         return false;
-    // point mass
+    // point mass, F_bar = R foo, M_bar = c_bar x foo
     vec_muls(r_bar, - out->sys.m * g, foo);
-    vec_cross(out->sys.c_bar, foo, bar);
-    vec_add(in->sys.M_bar, bar, in->sys.M_bar);
-    vec_rot(st->sys.q, foo, bar);
-    vec_add(in->sys.F_bar, bar, in->sys.F_bar);
-    // rigid body
-    mat_mulv(out->sys.I_cm, r_bar, foo);
+    mat_mul((void*) R, (void*) G, A);
+    mat_mul((void*) A, (void*) R_T, B);
+    jac_add(jac->F_bar, 0, (void*) B);
+    mat_mul((void*) A, (void*) T, B);
+    vec_cross_mat(foo, C);
+    mat_mul((void*) R, (void*) C, A);
+    mat_muls((void*) A, -2.0, A);
+    mat_add((void*) B, (void*) A, B);
+    jac_add(jac->F_bar, 3, (void*) B);
+    vec_cross_mat(out->sys.c_bar, C);
+    mat_mul((void*) C, (void*) G, A);
+    mat_mul((void*) A, (void*) R_T, B);
+    jac_add(jac->M_bar, 0, (void*) B);
+    mat_mul((void*) A, (void*) T, B);
+    jac_add(jac->M_bar, 3, (void*) B);
+    // rigid body, M_bar = s r_bar x I_cm r_bar, s = 3 mu / r^5
+    double s = 3.0 * g / r__2;
+    mat_mulv((void*) out->sys.I_cm, r_bar, foo);
     vec_cross(r_bar, foo, bar);
-    vec_muls(bar, 3.0 * g / r__2, bar);
-    vec_add(in->sys.M_bar, bar, in->sys.M_bar);
+    vec_cross_mat(r_bar, C);
+    mat_mul((void*) C, (void*) out->sys.I_cm, A);
+    vec_cross_mat(foo, C);
+    mat_sub((void*) A, (void*) C, A);
+    mat_muls((void*) A, s, A);
+    vec_omul(bar, r_bar, C);
+    mat_muls((void*) C, -5.0 * s / r__2, C);
+    mat_add((void*) A, (void*) C, A);
+    mat_mul((void*) A, (void*) R_T, B);
+    jac_add(jac->M_bar, 0, (void*) B);
+    mat_mul((void*) A, (void*) T, B);
+    jac_add(jac->M_bar, 3, (void*) B);
     return true;
 }
 
-bool geoall_eval(
-    double m, const vec_t r_bar,
+/* Accumulate geopotential and geomagnetic harmonics
+ * :param double m: mass
+ * :param env_s* env: environment (`ENV_HARM`)
+ * :param vec_t* F_bar: output force (ECEF)
+ * :param vec_t* B_bar: output field (ECEF)
+ */
+static void __geoall_sum(
+    double m, const struct env_s* env,
     vec_t F_bar, vec_t B_bar
 ) {
-    LOG_STATS("geoall_eval", 17, 37, 2);
-    double r__2;
-    if (!inv_sq_law(r_bar, &r__2, NULL))
-        return false;
-    // convert position to spherical coordinates
-    double g = G_MU * m / r__2,
-           r = sqrt(r__2),
-           a = sqrt(r_bar[0] * r_bar[0] + r_bar[1] * r_bar[1]) / r,
-           x, y, z = r_bar[2] / r;
-    if (a > ABSTOL) {
-        x = r_bar[0] / r / a;
-        y = r_bar[1] / r / a;
-    } else {
-        x = r_bar[0] / r * a;
-        y = r_bar[1] / r * a;
-    }
-    // calculate spherical harmonics
-    double R[MAX(G_DEG,2)+1], C[G_ORD+1], S[G_ORD+1],
-           P[(G_DEG+1)*(G_DEG+2)/2],
-           Q[(G_DEG+1)*(G_DEG+2)/2];
-    sph_harm(r, a, x, y ,z, R, P, Q, C, S);
+    LOG_STATS("geoall_eval", 17, 37, 0);
+    const double *R = env->R, *P = env->P, *Q = env->Q, *C = env->C, *S = env->S;
+    double g = G_MU * m / (env->r * env->r),
+           a = env->a, x = env->x, y = env->y, z = env->z;
     // accumulate component forces
     double F_dot_r = 0.0, F_dot_th = 0.0, F_dot_ph = 0.0,
            B_dot_r = 0.0, B_dot_th = 0.0, B_dot_ph = 0.0;
     for (size_t n = 1; n <= G_DEG; n++)
         for (size_t m = 0; m <= MIN(n, G_ORD); m++) {
-            LOG_STATS("geoall_eval", 8, 22, 0);
+            LOG_STATS("geoall_eval", 10, 26, 0);
             double foo = Kg[n*(n+1)/2+m] * R[n] * P[n*(n+1)/2+m],
                    bar = Kg[n*(n+1)/2+m] * R[n] * Q[n*(n+1)/2+m],
                    fizz = Jg[n*(n+1)/2+m][0] * C[m]
@@ -211,6 +465,10 @@ bool geoall_eval(
             F_dot_ph += m * ((a > ABSTOL) ? foo : bar) * buzz;
             foo = Km[n*(n+1)/2+m] * R[n] * P[n*(n+1)/2+m];
             bar = Km[n*(n+1)/2+m] * R[n] * Q[n*(n+1)/2+m];
+            fizz = Jm[n*(n+1)/2+m][0] * C[m]
+                 + Jm[n*(n+1)/2+m][1] * S[m];
+            buzz = Jm[n*(n+1)/2+m][1] * C[m]
+                 - Jm[n*(n+1)/2+m][0] * S[m];
             B_dot_r += (n + 1) * foo * fizz;
             B_dot_th += bar * fizz;
             B_dot_ph += m * ((a > ABSTOL) ? foo : bar) * buzz;
@@ -227,6 +485,17 @@ bool geoall_eval(
     B_bar[0] = x * (a * B_dot_r + z * B_dot_th) - y * B_dot_ph;
     B_bar[1] = y * (a * B_dot_r + z * B_dot_th) + x * B_dot_ph;
     B_bar[2] = z * B_dot_r - a * B_dot_th;
+}
+
+bool geoall_eval(
+    double m, const vec_t r_bar,
+    vec_t F_bar, vec_t B_bar
+) {
+    LOG_STATS("geoall_eval", 0, 0, 0);
+    struct env_s env;
+    if (!gee_sph(r_bar, &env))
+        return false;
+    __geoall_sum(m, &env, F_bar, B_bar);
     return true;
 }
 
@@ -242,25 +511,18 @@ bool geoall(
     double r__2;
     if (!inv_sq_law(st->sys.r_bar, &r__2, NULL))
         return false;
-    // rotate position into ECEF frame
-    quat_t q_i2f;
-    vec_t r_bar, F_bar, M_bar, B_bar;
-    gee_quat_i2f(st, q_i2f);
-    vec_rot(st->sys.q, out->sys.c_bar, r_bar);
-    vec_add(st->sys.r_bar, r_bar, r_bar);
-    vec_irot(q_i2f, r_bar, r_bar);
-    
-    if (!geoall_eval(out->sys.m, r_bar, F_bar, B_bar))
+    const struct env_s* env = gee_env(st, out, in, ENV_HARM);
+    vec_t F_bar, M_bar, B_bar;
+    if (env == NULL)
         return false;
-        
+    __geoall_sum(out->sys.m, env, F_bar, B_bar);
     // rotate force into ECI frame
-    vec_rot(q_i2f, F_bar, F_bar);
+    vec_rot(env->q_i2f, F_bar, F_bar);
     vec_add(in->sys.F_bar, F_bar, in->sys.F_bar);
     vec_irot(st->sys.q, F_bar, F_bar);
     vec_cross(out->sys.c_bar, F_bar, M_bar);
     vec_add(in->sys.M_bar, M_bar, in->sys.M_bar);
-    vec_rot(q_i2f, B_bar, B_bar);
+    vec_rot(env->q_i2f, B_bar, B_bar);
     vec_add(em->sys.B_bar, B_bar, em->sys.B_bar);
     return true;
 }
-
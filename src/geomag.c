@@ -50,26 +50,14 @@ const double Km[(G_DEG+1)*(G_DEG+2)/2] = {
 #endif
 };
 
-bool geomag_eval(const vec_t r_bar, vec_t B_bar) {
-    LOG_STATS("geomag_eval", 8, 21, 2);
-    double r = vec_norm(r_bar);
-    if (r < ABSTOL)
-        return false;
-    // convert position to spherical coordinates
-    double a = sqrt(r_bar[0] * r_bar[0] + r_bar[1] * r_bar[1]) / r,
-           x, y, z = r_bar[2] / r;
-    if (a > ABSTOL) {
-        x = r_bar[0] / r / a;
-        y = r_bar[1] / r / a;
-    } else {
-        x = r_bar[0] / r * a;
-        y = r_bar[1] / r * a;
-    }
-    // calculate spherical harmonics
-    double R[MAX(G_DEG,2)+1], C[G_ORD+1], S[G_ORD+1],
-           P[(G_DEG+1)*(G_DEG+2)/2],
-           Q[(G_DEG+1)*(G_DEG+2)/2];
-    sph_harm(r, a, x, y ,z, R, P, Q, C, S);
+/* Accumulate geomagnetic harmonics
+ * :param env_s* env: environment (`ENV_HARM`)
+ * :param vec_t* B_bar: output field (ECEF)
+ */
+static void __geomag_sum(const struct env_s* env, vec_t B_bar) {
+    LOG_STATS("geomag_eval", 8, 14, 0);
+    const double *R = env->R, *P = env->P, *Q = env->Q, *C = env->C, *S = env->S;
+    double a = env->a, x = env->x, y = env->y, z = env->z;
     // accumulate component fields
     double B_dot_r = 0.0, B_dot_th = 0.0, B_dot_ph = 0.0;
     for (size_t n = 1; n <= G_DEG; n++)
@@ -90,6 +78,14 @@ bool geomag_eval(const vec_t r_bar, vec_t B_bar) {
     B_bar[0] = x * (a * B_dot_r + z * B_dot_th) - y * B_dot_ph;
     B_bar[1] = y * (a * B_dot_r + z * B_dot_th) + x * B_dot_ph;
     B_bar[2] = z * B_dot_r - a * B_dot_th;
+}
+
+bool geomag_eval(const vec_t r_bar, vec_t B_bar) {
+    LOG_STATS("geomag_eval", 0, 0, 0);
+    struct env_s env;
+    if (!gee_sph(r_bar, &env))
+        return false;
+    __geomag_sum(&env, B_bar);
     return true;
 }
 
@@ -97,26 +93,18 @@ bool geomag(
     size_t size __attribute__((unused)),
     const struct cfg_s* cfg __attribute__((unused)),
     const struct st_s* st,
-    struct in_s* restrict in __attribute__((unused)),
+    struct in_s* restrict in,
     const struct out_s* out,
     struct em_s* restrict em
 ) {
     LOG_STATS("geomag", 0, 0, 0);
-    // rotate position into ECEF frame
-    quat_t q_i2f;
-    vec_t r_bar, B_bar;
-    gee_quat_i2f(st, q_i2f);
-    vec_rot(st->sys.q, out->sys.c_bar, r_bar);
-    vec_add(st->sys.r_bar, r_bar, r_bar);
-    vec_irot(q_i2f, r_bar, r_bar);
-    
-    if (!geomag_eval(r_bar, B_bar))
+    const struct env_s* env = gee_env(st, out, in, ENV_HARM);
+    vec_t B_bar;
+    if (env == NULL)
         return false;
-    
+    __geomag_sum(env, B_bar);
     // rotate field into ECI frame
-    vec_t temp;
-    vec_rot(q_i2f, B_bar, temp);
-    vec_add(em->sys.B_bar, temp, em->sys.B_bar);
+    vec_rot(env->q_i2f, B_bar, B_bar);
+    vec_add(em->sys.B_bar, B_bar, em->sys.B_bar);
     return true;
 }
-
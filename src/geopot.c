@@ -1,4 +1,8 @@
+#include <stdio.h>
+#include <string.h>
 #include "geopot.h"
+#include "force_model.h"
+#include "mat.h"
 #include "vec.h"
 #include "quat.h"
 #include "config.h"
@@ -51,28 +55,16 @@ const double Kg[(G_DEG+1)*(G_DEG+2)/2] = {
 #endif
 };
 
-bool geopot_eval(double m, const vec_t r_bar, vec_t F_bar) {
-    LOG_STATS("geopot_eval", 9, 23, 2);
-    double r__2;
-    if (!inv_sq_law(r_bar, &r__2, NULL))
-        return false;
-    // convert position to spherical coordinates
-    double g = G_MU * m / r__2,
-           r = sqrt(r__2),
-           a = sqrt(r_bar[0] * r_bar[0] + r_bar[1] * r_bar[1]) / r,
-           x, y, z = r_bar[2] / r;
-    if (a > ABSTOL) {
-        x = r_bar[0] / r / a;
-        y = r_bar[1] / r / a;
-    } else {
-        x = r_bar[0] / r * a;
-        y = r_bar[1] / r * a;
-    }
-    // calculate spherical harmonics
-    double R[MAX(G_DEG,2)+1], C[G_ORD+1], S[G_ORD+1],
-           P[(G_DEG+1)*(G_DEG+2)/2],
-           Q[(G_DEG+1)*(G_DEG+2)/2];
-    sph_harm(r, a, x, y ,z, R, P, Q, C, S);
+/* Accumulate geopotential harmonics
+ * :param double m: mass
+ * :param env_s* env: environment (`ENV_HARM`)
+ * :param vec_t* F_bar: output force (ECEF)
+ */
+static void __geopot_sum(double m, const struct env_s* env, vec_t F_bar) {
+    LOG_STATS("geopot_eval", 9, 16, 0);
+    const double *R = env->R, *P = env->P, *Q = env->Q, *C = env->C, *S = env->S;
+    double g = G_MU * m / (env->r * env->r),
+           a = env->a, x = env->x, y = env->y, z = env->z;
     // accumulate component forces
     double F_dot_r = 0.0, F_dot_th = 0.0, F_dot_ph = 0.0;
     for (size_t n = 2; n <= G_DEG; n++)
@@ -95,6 +87,14 @@ bool geopot_eval(double m, const vec_t r_bar, vec_t F_bar) {
     F_bar[0] = x * (a * F_dot_r + z * F_dot_th) - y * F_dot_ph;
     F_bar[1] = y * (a * F_dot_r + z * F_dot_th) + x * F_dot_ph;
     F_bar[2] = z * F_dot_r - a * F_dot_th;
+}
+
+bool geopot_eval(double m, const vec_t r_bar, vec_t F_bar) {
+    LOG_STATS("geopot_eval", 0, 0, 0);
+    struct env_s env;
+    if (!gee_sph(r_bar, &env))
+        return false;
+    __geopot_sum(m, &env, F_bar);
     return true;
 }
 
@@ -107,23 +107,435 @@ bool geopot(
     struct em_s* restrict em __attribute__((unused))
 ) {
     LOG_STATS("geopot", 0, 0, 0);
+    const struct env_s* env = gee_env(st, out, in, ENV_HARM);
+    vec_t F_bar, M_bar;
+    if (env == NULL)
+        return false;
+    __geopot_sum(out->sys.m, env, F_bar);
+    // rotate force into ECI frame
+    vec_rot(env->q_i2f, F_bar, F_bar);
+    vec_add(in->sys.F_bar, F_bar, in->sys.F_bar);
+    vec_irot(st->sys.q, F_bar, F_bar);
+    vec_cross(out->sys.c_bar, F_bar, M_bar);
+    vec_add(in->sys.M_bar, M_bar, in->sys.M_bar);
+    return true;
+}
+
+#define EGM_INDEX(n, m) ((m) * (2 * G_NMAX + 3 - (m)) / 2 + (n) - (m))
+
+static struct egm_s __egm_lst[(G_NMAX+1)*(G_NMAX+2)/2];
+static double __egm_p[G_NMAX+1];  // sectorial P_mm / cos(phi)^m
+static double __egm_mu = G_MU, __egm_R = G_RMAX;
+static size_t __egm_deg = 0, __egm_ord = 0,  // truncation
+              __egm_deg_max = 0, __egm_ord_max = 0;
+
+/* Match header key
+ * :param char* line: input line
+ * :param char* key: header key
+ * :returns char*: value field, or `NULL`
+ */
+static char* __egm_key(char* line, const char* key) {
+    size_t n = strlen(key);
+    if (strncmp(line, key, n) || (line[n] != ' ' && line[n] != '\t'))
+        return NULL;
+    return line + n;
+}
+
+/* Rewrite Fortran exponents (`1.0D-06`) of numeric fields
+ * :param char* p: fields, up to the end of the line
+ * :returns char*: `p`
+ */
+static char* __egm_exp(char* p) {
+    for (char* c = p; *c != '\0'; c++)
+        if (*c == 'D' || *c == 'd')
+            *c = 'e';
+    return p;
+}
+
+bool geopot_load(const char* file_name, size_t deg, size_t ord) {
+    LOG_STATS("geopot_load", 0, 0, 0);
+    char line[256];
+    FILE* file;
+    if (deg > G_NMAX || ord > G_NMAX || (file = fopen(file_name, "r")) == NULL)
+        return false;
+    ord = MIN(ord, deg);
+    memset(__egm_lst, 0, sizeof(__egm_lst));
+    __egm_mu = G_MU;
+    __egm_R = G_RMAX;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        char* p;
+        size_t n, m;
+        double C, S;
+        // exponents are rewritten after the key matched (`radius`)
+        if ((p = __egm_key(line, "earth_gravity_constant")) != NULL) {
+            if (sscanf(__egm_exp(p), "%lf", &C) == 1)
+                __egm_mu = C;
+            continue;
+        }
+        if ((p = __egm_key(line, "radius")) != NULL) {
+            if (sscanf(__egm_exp(p), "%lf", &C) == 1)
+                __egm_R = C;
+            continue;
+        }
+        if ((p = __egm_key(line, "gfc")) == NULL)
+            p = line;
+        if (sscanf(__egm_exp(p), "%zu %zu %lf %lf", &n, &m, &C, &S) != 4)
+            continue;
+        if (n < 2 || n > deg || m > MIN(n, ord))
+            continue;
+        __egm_lst[EGM_INDEX(n, m)].C = C;
+        __egm_lst[EGM_INDEX(n, m)].S = S;
+    }
+    fclose(file);
+    // recursion constants, P_nm = a * t * P_n-1,m - b * P_n-2,m
+    __egm_p[0] = 1.0;
+    for (size_t m = 0; m <= ord; m++) {
+        if (m > 0)
+            __egm_p[m] = __egm_p[m-1] * sqrt((2.0 * m + 1.0) / (m > 1 ? 2.0 * m : 1.0));
+        for (size_t n = m + 1; n <= deg; n++) {
+            double foo = (double) ((n - m) * (n + m));
+            __egm_lst[EGM_INDEX(n, m)].a = sqrt((2.0 * n - 1.0) * (2.0 * n + 1.0) / foo);
+            __egm_lst[EGM_INDEX(n, m)].b = (n > m + 1) ? sqrt(
+                (2.0 * n + 1.0) * (n + m - 1) * (n - m - 1) / (foo * (2.0 * n - 3.0))
+            ) : 0.0;
+        }
+    }
+    __egm_deg = __egm_deg_max = deg;
+    __egm_ord = __egm_ord_max = ord;
+    return true;
+}
+
+bool geopot_trunc(size_t deg, size_t ord) {
+    LOG_STATS("geopot_trunc", 0, 0, 0);
+    if (deg > __egm_deg_max || ord > __egm_ord_max)
+        return false;
+    __egm_deg = deg;
+    __egm_ord = MIN(ord, deg);
+    return true;
+}
+
+bool geopot_egm_eval(double m, const vec_t r_bar, vec_t F_bar) {
+    LOG_STATS("geopot_egm_eval", 0, 0, 0);
+    double r__2;
+    if (!inv_sq_law(r_bar, &r__2, NULL))
+        return false;
+    // t = sin(phi), u = cos(phi), (x, y) = (cos(lambda), sin(lambda))
+    double r = sqrt(r__2),
+           a = sqrt(r_bar[0] * r_bar[0] + r_bar[1] * r_bar[1]),
+           t = r_bar[2] / r,
+           u = a / r,
+           x = (a > ABSTOL) ? r_bar[0] / a : 1.0,
+           y = (a > ABSTOL) ? r_bar[1] / a : 0.0,
+           R[G_NMAX+1], R_dot[G_NMAX+1], C[G_NMAX+1], S[G_NMAX+1];
+    // (R / r)^n, and (n + 1) (R / r)^n of the radial derivative
+    R[0] = R_dot[0] = 1.0;
+    for (size_t n = 1; n <= __egm_deg; n++) {
+        R[n] = R[n-1] * __egm_R / r;
+        R_dot[n] = (n + 1) * R[n];
+    }
+    C[0] = 1.0;
+    S[0] = 0.0;
+    for (size_t k = 1; k <= __egm_ord; k++) {
+        C[k] = x * C[k-1] - y * S[k-1];
+        S[k] = y * C[k-1] + x * S[k-1];
+    }
+    // order sums (by Horner's scheme), radial, dP/dt, m P (shifted), and
+    // longitude (shifted)
+    double H_r = 0.0, H_t = 0.0, H_m = 0.0, H_l = 0.0;
+    for (size_t k = __egm_ord + 1; k-- > 0;) {
+        LOG_STATS("geopot_egm_eval", 12 * (__egm_deg - k + 1), 14 * (__egm_deg - k + 1), 0);
+        const struct egm_s* e = &__egm_lst[EGM_INDEX(k, k)];
+        double p0 = __egm_p[k], p1 = 0.0, d0 = 0.0, d1 = 0.0,
+               AB0[2] = {0.0, 0.0}, AB1[2] = {0.0, 0.0}, AB2[2] = {0.0, 0.0};
+#if defined SIMD_SSE2
+        __m128d ab0 = _mm_setzero_pd(), ab1 = ab0, ab2 = ab0;
+#endif
+        for (size_t n = k; n <= __egm_deg; n++, e++) {
+            if (n > k) {
+                // (short dependency chains, a * t is off the critical path)
+                double p2 = p1, d2 = d1, at = e->a * t;
+                p1 = p0;
+                d1 = d0;
+                p0 = at * p1 - e->b * p2;
+                d0 = at * d1 + (e->a * p1 - e->b * d2);
+            }
+            double foo = R[n] * p0, bar = R_dot[n] * p0, fizz = R[n] * d0;
+#if defined SIMD_SSE2
+            __m128d CS = _mm_loadu_pd(&e->C);
+            ab0 = _mm_add_pd(ab0, _mm_mul_pd(_mm_set1_pd(foo), CS));
+            ab1 = _mm_add_pd(ab1, _mm_mul_pd(_mm_set1_pd(bar), CS));
+            ab2 = _mm_add_pd(ab2, _mm_mul_pd(_mm_set1_pd(fizz), CS));
+#else
+            AB0[0] += foo * e->C;
+            AB0[1] += foo * e->S;
+            AB1[0] += bar * e->C;
+            AB1[1] += bar * e->S;
+            AB2[0] += fizz * e->C;
+            AB2[1] += fizz * e->S;
+#endif
+        }
+#if defined SIMD_SSE2
+        _mm_storeu_pd(AB0, ab0);
+        _mm_storeu_pd(AB1, ab1);
+        _mm_storeu_pd(AB2, ab2);
+#endif
+        double A0 = AB0[0], B0 = AB0[1], A1 = AB1[0], B1 = AB1[1],
+               A2 = AB2[0], B2 = AB2[1];
+        H_r = H_r * u + A1 * C[k] + B1 * S[k];
+        H_t = H_t * u + A2 * C[k] + B2 * S[k];
+        if (k > 0) {
+            H_m = H_m * u + k * (A0 * C[k] + B0 * S[k]);
+            H_l = H_l * u + k * (B0 * C[k] - A0 * S[k]);
+        }
+    }
+    // radial, latitude and longitude components
+    double g = __egm_mu * m / r__2,
+           F_dot_r = - g * H_r,
+           F_dot_ph = g * (u * H_t - t * H_m),
+           F_dot_la = g * H_l,
+           F_dot_a = u * F_dot_r - t * F_dot_ph;
+    // convert force to cartesian coordinates
+    F_bar[0] = x * F_dot_a - y * F_dot_la;
+    F_bar[1] = y * F_dot_a + x * F_dot_la;
+    F_bar[2] = t * F_dot_r + u * F_dot_ph;
+    return true;
+}
+
+bool geopot_egm(
+    size_t size __attribute__((unused)),
+    const struct cfg_s* cfg __attribute__((unused)),
+    const struct st_s* st,
+    struct in_s* restrict in,
+    const struct out_s* out,
+    struct em_s* restrict em __attribute__((unused))
+) {
+    LOG_STATS("geopot_egm", 0, 0, 0);
+    const struct env_s* env = gee_env(st, out, in, ENV_FRAME);
+    vec_t F_bar, M_bar;
+    if (!geopot_egm_eval(out->sys.m, env->r_bar, F_bar))
+        return false;
+    // rotate force into ECI frame
+    vec_rot(env->q_i2f, F_bar, F_bar);
+    vec_add(in->sys.F_bar, F_bar, in->sys.F_bar);
+    vec_irot(st->sys.q, F_bar, F_bar);
+    vec_cross(out->sys.c_bar, F_bar, M_bar);
+    vec_add(in->sys.M_bar, M_bar, in->sys.M_bar);
+    return true;
+}
+
+bool geopot_egm_grad(double m, const vec_t r_bar, mat_t G) {
+    LOG_STATS("geopot_egm_grad", 3, 12, 0);
+    for (size_t j = 0; j < 3; j++) {
+        vec_t r_plus, r_minus, F_plus, F_minus;
+        vec_pos(r_bar, r_plus);
+        vec_pos(r_bar, r_minus);
+        r_plus[j] += G_EGM_STEP;
+        r_minus[j] -= G_EGM_STEP;
+        if (
+            !geopot_egm_eval(m, r_plus, F_plus)
+            || !geopot_egm_eval(m, r_minus, F_minus)
+        )
+            return false;
+        for (size_t i = 0; i < 3; i++)
+            G[i][j] = (F_plus[i] - F_minus[i]) / (2.0 * G_EGM_STEP);
+    }
+    return true;
+}
+
+/* Differentiate harmonic term
+ * :param size_t n: degree
+ * :param size_t m: order
+ * :param double a: coefficient of `V_nm`
+ * :param double b: coefficient of `W_nm`
+ * :param size_t i: axis
+ * :param size_t m_lst: output orders (of degree `n + 1`)
+ * :param double ab_lst: output coefficients (of `V`, `W`)
+ * :returns size_t: number of terms
+ *
+ * Scaled by `G_RMAX`, see Montenbruck and Gill (3.33).
+ */
+static size_t __geopot_diff(
+    size_t n, size_t m,
+    double a, double b,
+    size_t i,
+    size_t m_lst[2],
+    double ab_lst[2][2]
+) {
+    double f = (double) ((n - m + 2) * (n - m + 1));
+    switch (i) {
+    case 0:
+        if (m == 0) {
+            m_lst[0] = 1;
+            ab_lst[0][0] = - a;
+            ab_lst[0][1] = 0.0;
+            return 1;
+        }
+        m_lst[0] = m + 1;
+        ab_lst[0][0] = - 0.5 * a;
+        ab_lst[0][1] = - 0.5 * b;
+        m_lst[1] = m - 1;
+        ab_lst[1][0] = 0.5 * f * a;
+        ab_lst[1][1] = 0.5 * f * b;
+        return 2;
+    case 1:
+        if (m == 0) {
+            m_lst[0] = 1;
+            ab_lst[0][0] = 0.0;
+            ab_lst[0][1] = - a;
+            return 1;
+        }
+        m_lst[0] = m + 1;
+        ab_lst[0][0] = 0.5 * b;
+        ab_lst[0][1] = - 0.5 * a;
+        m_lst[1] = m - 1;
+        ab_lst[1][0] = 0.5 * f * b;
+        ab_lst[1][1] = - 0.5 * f * a;
+        return 2;
+    default:
+        m_lst[0] = m;
+        ab_lst[0][0] = - (double) (n - m + 1) * a;
+        ab_lst[0][1] = - (double) (n - m + 1) * b;
+        return 1;
+    }
+}
+
+bool geopot_grad(double m, const vec_t r_bar, mat_t G) {
+    LOG_STATS("geopot_grad", 0, 4, 1);
+    double r__2;
+    if (!inv_sq_law(r_bar, &r__2, NULL))
+        return false;
+    // Cunningham harmonics, V_00 = R / r
+    double x = r_bar[0] * G_RMAX / r__2,
+           y = r_bar[1] * G_RMAX / r__2,
+           z = r_bar[2] * G_RMAX / r__2,
+           s = G_RMAX * G_RMAX / r__2,
+           V[(G_DEG+3)*(G_DEG+4)/2],
+           W[(G_DEG+3)*(G_DEG+4)/2];
+    V[0] = G_RMAX / sqrt(r__2);
+    W[0] = 0.0;
+    for (size_t n = 1; n <= G_DEG + 2; n++) {
+        LOG_STATS("geopot_grad", 2 * n, 8 * n, 0);
+        size_t k = n * (n + 1) / 2, l = (n - 1) * n / 2;
+        for (size_t m = 0; m < n; m++) {
+            double foo = (2 * n - 1) * z / (n - m), bar = 0.0;
+            V[k+m] = foo * V[l+m];
+            W[k+m] = foo * W[l+m];
+            if (m + 2 <= n) {
+                bar = (n + m - 1) * s / (n - m);
+                V[k+m] -= bar * V[(n-2)*(n-1)/2+m];
+                W[k+m] -= bar * W[(n-2)*(n-1)/2+m];
+            }
+        }
+        V[k+n] = (2 * n - 1) * (x * V[l+n-1] - y * W[l+n-1]);
+        W[k+n] = (2 * n - 1) * (x * W[l+n-1] + y * V[l+n-1]);
+    }
+    // accumulate second derivatives (lower triangle)
+    mat_zero(G);
+    for (size_t n = 2; n <= G_DEG; n++)
+        for (size_t m = 0; m <= MIN(n, G_ORD); m++) {
+            double a = Kg[n*(n+1)/2+m] * Jg[n*(n+1)/2+m][0],
+                   b = Kg[n*(n+1)/2+m] * Jg[n*(n+1)/2+m][1];
+            for (size_t i = 0; i < 3; i++) {
+                size_t m1_lst[2], m2_lst[2];
+                double ab1_lst[2][2], ab2_lst[2][2];
+                size_t n1 = __geopot_diff(n, m, a, b, i, m1_lst, ab1_lst);
+                for (size_t j = 0; j <= i; j++)
+                    for (size_t p = 0; p < n1; p++) {
+                        size_t n2 = __geopot_diff(
+                            n + 1, m1_lst[p], ab1_lst[p][0], ab1_lst[p][1],
+                            j, m2_lst, ab2_lst
+                        );
+                        for (size_t q = 0; q < n2; q++) {
+                            LOG_STATS("geopot_grad", 2, 2, 0);
+                            size_t k = (n + 2) * (n + 3) / 2 + m2_lst[q];
+                            G[i][j] += ab2_lst[q][0] * V[k] + ab2_lst[q][1] * W[k];
+                        }
+                    }
+            }
+        }
+    double g = G_MU * m / (G_RMAX * G_RMAX * G_RMAX);
+    for (size_t i = 0; i < 3; i++)
+        for (size_t j = 0; j <= i; j++)
+            G[j][i] = G[i][j] = g * G[i][j];
+    return true;
+}
+
+/* Geopotential partials
+ * :param st_t* st: state structure
+ * :param jac_t* jac: partials structure
+ * :param out_t* out: output structure
+ * :param eval: force (ECEF)
+ * :param grad: force gradient (ECEF)
+ * :returns bool:
+ */
+static bool __geopot_jac(
+    const struct st_s* st,
+    struct jac_s* restrict jac,
+    const struct out_s* out,
+    bool (*eval)(double, const vec_t, vec_t),
+    bool (*grad)(double, const vec_t, mat_t)
+) {
     // rotate position into ECEF frame
     quat_t q_i2f;
-    vec_t r_bar, F_bar, M_bar;
+    vec_t r_bar, F_bar;
+    mat_t Q, R, G, C, T, A, B;
     gee_quat_i2f(st, q_i2f);
+    quat_rot_mat(q_i2f, Q);
+    quat_rot_mat(st->sys.q, R);
     vec_rot(st->sys.q, out->sys.c_bar, r_bar);
     vec_add(st->sys.r_bar, r_bar, r_bar);
     vec_irot(q_i2f, r_bar, r_bar);
-    
-    if (!geopot_eval(out->sys.m, r_bar, F_bar))
+
+    if (!eval(out->sys.m, r_bar, F_bar) || !grad(out->sys.m, r_bar, A))
         return false;
-    
-    // rotate force into ECI frame
+
+    // rotate gradient into ECI frame, Q G Q^T
+    mat_mul((void*) Q, (void*) A, B);
+    mat__T((void*) Q, A);
+    mat_mul((void*) B, (void*) A, G);
+    jac_add(jac->F_bar, 0, (void*) G);
+    // d(R c_bar) / d th = - 2 R [c_bar]x
+    vec_cross_mat(out->sys.c_bar, C);
+    mat_mul((void*) R, (void*) C, A);
+    mat_muls((void*) A, -2.0, A);
+    mat_mul((void*) G, (void*) A, T);
+    jac_add(jac->F_bar, 3, (void*) T);
+    // M_bar = c_bar x R^T F_bar, d(R^T u) / d th = 2 [R^T u]x
     vec_rot(q_i2f, F_bar, F_bar);
-    vec_add(in->sys.F_bar, F_bar, in->sys.F_bar);
     vec_irot(st->sys.q, F_bar, F_bar);
-    vec_cross(out->sys.c_bar, F_bar, M_bar);
-    vec_add(in->sys.M_bar, M_bar, in->sys.M_bar);
+    mat__T((void*) R, A);
+    mat_mul((void*) C, (void*) A, B);
+    mat_mul((void*) B, (void*) G, A);
+    jac_add(jac->M_bar, 0, (void*) A);
+    mat_mul((void*) B, (void*) T, A);
+    vec_cross_mat(F_bar, G);
+    mat_mul((void*) C, (void*) G, B);
+    mat_muls((void*) B, 2.0, B);
+    mat_add((void*) A, (void*) B, A);
+    jac_add(jac->M_bar, 3, (void*) A);
     return true;
 }
 
+bool geopot_jac(
+    size_t size __attribute__((unused)),
+    const struct cfg_s* cfg __attribute__((unused)),
+    const struct st_s* st,
+    struct jac_s* restrict jac,
+    const struct out_s* out,
+    const struct em_s* em __attribute__((unused))
+) {
+    LOG_STATS("geopot_jac", 0, 0, 0);
+    return __geopot_jac(st, jac, out, geopot_eval, geopot_grad);
+}
+
+bool geopot_egm_jac(
+    size_t size __attribute__((unused)),
+    const struct cfg_s* cfg __attribute__((unused)),
+    const struct st_s* st,
+    struct jac_s* restrict jac,
+    const struct out_s* out,
+    const struct em_s* em __attribute__((unused))
+) {
+    LOG_STATS("geopot_egm_jac", 0, 0, 0);
+    return __geopot_jac(st, jac, out, geopot_egm_eval, geopot_egm_grad);
+}
@@ -4,6 +4,9 @@
 #include "util.h"
 #include "log.h"
 
+extern inline void mat_mul(const mat_t, const mat_t, mat_t);
+extern inline void mat_mulv(const mat_t, const vec_t, vec_t);
+
 void mat_eye(mat_t A) 
 {
     LOG_STATS("mat_eye", 0, 0, 0);
@@ -55,6 +58,35 @@ bool mat_inv(const mat_t A, mat_t A_inv)
     return true;
 }
 
+bool mat_chol(const mat_t A, mat_t L)
+{
+    LOG_STATS("mat_chol", 5, 9, 0);
+    mat_zero(L);
+    if ((L[0][0] = A[0][0]) < ABSTOL)
+        return false;
+    L[1][0] = A[1][0] / L[0][0];
+    L[2][0] = A[2][0] / L[0][0];
+    if ((L[1][1] = A[1][1] - L[1][0] * A[1][0]) < ABSTOL)
+        return false;
+    L[2][1] = (A[2][1] - L[2][0] * A[1][0]) / L[1][1];
+    if ((L[2][2] = A[2][2] - L[2][0] * A[2][0] - L[2][1] * L[2][1] * L[1][1]) < ABSTOL)
+        return false;
+    return true;
+}
+
+void mat_chol_solve(const mat_t L, const vec_t u_bar, vec_t v_bar)
+{
+    LOG_STATS("mat_chol_solve", 6, 6, 0);
+    // L D y = u
+    double y0 = u_bar[0],
+           y1 = u_bar[1] - L[1][0] * y0,
+           y2 = u_bar[2] - L[2][0] * y0 - L[2][1] * y1;
+    // L^T v = y
+    v_bar[2] = y2 / L[2][2];
+    v_bar[1] = y1 / L[1][1] - L[2][1] * v_bar[2];
+    v_bar[0] = y0 / L[0][0] - L[1][0] * v_bar[1] - L[2][0] * v_bar[2];
+}
+
 void mat__T(const mat_t A, mat_t A__T)
 {
     LOG_STATS("mat__T", 0, 0, 0);
@@ -90,17 +122,6 @@ void mat_muls(const mat_t A, double s, mat_t B)
         vec_muls(A[i], s, B[i]);
 }
 
-void mat_mul(const mat_t A, const mat_t B, mat_t C)
-{
-    LOG_STATS("mat_mul", 27, 27, 0);
-    for (size_t i = 0; i < 3; i++)
-        for (size_t j = 0; j < 3; j++) {
-            C[i][j] = 0.0;
-            for (size_t k = 0; k < 3; k++)
-                C[i][j] += A[i][k] * B[k][j];
-        }
-}
-
 /* Matrix/vector functions */
 
 void vec_omul(const vec_t u_bar, const vec_t v_bar, mat_t A)
@@ -110,13 +131,6 @@ void vec_omul(const vec_t u_bar, const vec_t v_bar, mat_t A)
         vec_muls(v_bar, u_bar[i], A[i]);
 }
 
-void mat_mulv(const mat_t A, const vec_t u_bar, vec_t v_bar)
-{
-    LOG_STATS("mat_mulv", 0, 0, 0);
-    for (size_t i = 0; i < 3; i++)
-        v_bar[i] = vec_dot(A[i], u_bar);
-}
-
 void mat_vmul(const vec_t u_bar, const mat_t A, vec_t v_bar)
 {
     LOG_STATS("mat_vmul", 9, 9, 0);
@@ -1,30 +1,395 @@
 #include <assert.h>
 #include <math.h>
+#include <string.h>
 #include "ode.h"
 #include "interp.h"
 #include "quat.h"
 #include "vec.h"
+#include "mat.h"
 #include "config.h"
 #include "util.h"
 #include "log.h"
 
 ode_meth_t ode_default_meth = ODE_METHOD_NAME(midp);
 
+/* Apply stage
+ * :param size_t N: number of stages
+ * :param double A: weights
+ * :param double delta_x:
+ * :param st_t* y0: input state
+ * :param st_t* y1: output state
+ * :param st_t* k: stage derivatives
+ * :param vec_t th_bar: (optional) output rotation increment
+ *
+ * Rotation increments are summed in the Lie algebra (`quat_log` of the
+ * stage derivatives) and applied with a single exponential, as in
+ * Runge-Kutta-Munthe-Kaas methods (see `__apply_dexpinv`).
+ */
 static void __apply_stage(
     size_t N, const double A[static N],
     double delta_x,
     const st_t* y0,
     st_t* restrict y1,
-    const st_t k[static N]
+    const st_t k[static N],
+    double* restrict th_bar
 ) {
-    LOG_STATS("__apply_stage", 0, N, 0);
-    st_int(A[0] * delta_x, &k[0], y0, y1);
-    for (size_t i = 1; i < N; i++) {
+    LOG_STATS("__apply_stage", 0, 0, 0);
+    vec_t th, foo;
+    quat_t bar;
+    vec_pos(y0->r_bar, y1->r_bar);
+    vec_zero(th);
+    vec_pos(y0->v_bar, y1->v_bar);
+    vec_pos(y0->om_bar, y1->om_bar);
+    for (size_t i = 0; i < N; i++) {
         if (fabs(A[i]) < ABSTOL)
             continue;
-        st_t temp;
-        st_int(A[i] * delta_x, &k[i], y1, &temp);
-        st_pos(&temp, y1);
+        LOG_STATS("__apply_stage", 12, 12, 0);
+        double h = A[i] * delta_x;
+        vec_muls(k[i].r_bar, h, foo);
+        vec_add(y1->r_bar, foo, y1->r_bar);
+        quat_log(k[i].q, foo);
+        vec_muls(foo, h, foo);
+        vec_add(th, foo, th);
+        vec_muls(k[i].v_bar, h, foo);
+        vec_add(y1->v_bar, foo, y1->v_bar);
+        vec_muls(k[i].om_bar, h, foo);
+        vec_add(y1->om_bar, foo, y1->om_bar);
+    }
+    vec_exp(th, bar);
+    quat_mul(y0->q, bar, y1->q);
+    if (th_bar != NULL)
+        vec_pos(th, th_bar);
+}
+
+/* Apply inverse exponential derivative
+ * :param vec_t th_bar: rotation increment of the stage (see `quat_log`)
+ * :param st_t* k: stage derivative
+ *
+ * Maps the rotation rate `v` at the stage to the rate of its increment,
+ * v + th x v + c * th x (th x v), with c = (1 - |th| cot |th|) / |th|^2
+ * expanded to |th|^4, so that the summed increments keep the order of
+ * the method.
+ */
+static void __apply_dexpinv(
+    const vec_t th_bar,
+    st_t* restrict k
+) {
+    LOG_STATS("__apply_dexpinv", 10, 15, 0);
+    vec_t v_bar, foo, bar;
+    double s = vec_dot(th_bar, th_bar);
+    if (s < ABSTOL * ABSTOL)
+        return;
+    quat_log(k->q, v_bar);
+    vec_cross(th_bar, v_bar, foo);
+    vec_cross(th_bar, foo, bar);
+    vec_add(v_bar, foo, v_bar);
+    vec_muls(bar, 1.0 / 3.0 + s * (1.0 / 45.0 + s * 2.0 / 945.0), bar);
+    vec_add(v_bar, bar, v_bar);
+    vec_exp(v_bar, k->q);
+}
+
+/* Apply accumulator function
+ * Counts the evaluation in `ivp->stats` (when given).
+ */
+static inline void __apply_fun(
+    double x,
+    const st_t* y,
+    st_t* restrict k,
+    ode_fun_t fun,
+    struct ivp_s* ivp
+) {
+    if (ivp->stats != NULL)
+        ivp->stats->n_fun++;
+    fun(x, y, k, ivp);
+}
+
+/* Check state transition matrix
+ * :param ivp_s* ivp: propagation context
+ * :returns bool: `ivp->stm` given and valid
+ */
+static inline bool __stm_active(const struct ivp_s* ivp)
+{
+    return ivp->stm != NULL && ivp->stm->valid;
+}
+
+/* Invalidate state transition matrix
+ * :param ivp_s* ivp: propagation context
+ * For methods without variational equations.
+ */
+static inline void __stm_invalid(struct ivp_s* ivp)
+{
+    if (ivp->stm != NULL)
+        ivp->stm->valid = false;
+}
+
+/* Apply accumulator Jacobian (variational equations)
+ * :param double x:
+ * :param st_t* y: input state
+ * :param st_t* k: (optional) output state derivative
+ * :param double J: output Jacobian
+ * :param ivp_s* ivp: propagation context
+ *
+ * Adds the transport of the rotation perturbation along the body frame,
+ * th_dot = om_bar / 2 - om_bar x th_bar, to `stm->jac`.
+ */
+static void __apply_jac(
+    double x,
+    const st_t* y,
+    st_t* restrict k,
+    double J[static ODE_JAC_SIZE][ODE_JAC_SIZE],
+    struct ivp_s* ivp
+) {
+    LOG_STATS("__apply_jac", 0, 0, 0);
+    mat_t W;
+    if (ivp->stats != NULL) {
+        ivp->stats->n_fun += k != NULL;
+        ivp->stats->n_jac++;
+    }
+    ivp->stm->jac(x, y, k, J, ivp);
+    vec_cross_mat(y->om_bar, W);
+    for (size_t a = 0; a < 3; a++)
+        for (size_t b = 0; b < 3; b++)
+            J[3 + a][3 + b] -= W[a][b];
+}
+
+/* Multiply state transition matrix
+ * :param double J: Jacobian
+ * :param double Phi: input matrix
+ * :param double K: output matrix, J Phi
+ *
+ * Skips zero entries, `J` is mostly sparse.
+ */
+static void __stm_mul(
+    const double J[static ODE_JAC_SIZE][ODE_JAC_SIZE],
+    const double Phi[static ODE_JAC_SIZE][ODE_JAC_SIZE],
+    double K[static restrict ODE_JAC_SIZE][ODE_JAC_SIZE]
+) {
+    LOG_STATS("__stm_mul", ODE_JAC_SIZE * ODE_JAC_SIZE * ODE_JAC_SIZE, ODE_JAC_SIZE * ODE_JAC_SIZE * ODE_JAC_SIZE, 0);
+    memset(K, 0, ODE_JAC_SIZE * sizeof(K[0]));
+    for (size_t i = 0; i < ODE_JAC_SIZE; i++)
+        for (size_t k = 0; k < ODE_JAC_SIZE; k++) {
+            if (J[i][k] == 0.0)
+                continue;
+            for (size_t j = 0; j < ODE_JAC_SIZE; j++)
+                K[i][j] += J[i][k] * Phi[k][j];
+        }
+}
+
+/* Apply state transition matrix stage
+ * :param size_t N: number of stages
+ * :param double A: weights
+ * :param double delta_x:
+ * :param double Phi0: input matrix
+ * :param double Phi1: output matrix, Phi0 + h * sum(A[i] * K[i])
+ * :param double K: stage derivatives
+ */
+static void __apply_stm(
+    size_t N, const double A[],
+    double delta_x,
+    const double Phi0[static ODE_JAC_SIZE][ODE_JAC_SIZE],
+    double Phi1[static ODE_JAC_SIZE][ODE_JAC_SIZE],
+    const double K[static N][ODE_JAC_SIZE][ODE_JAC_SIZE]
+) {
+    LOG_STATS("__apply_stm", 0, 0, 0);
+    if ((const void*) Phi1 != (const void*) Phi0)
+        memcpy(Phi1, Phi0, ODE_JAC_SIZE * sizeof(Phi1[0]));
+    for (size_t n = 0; n < N; n++) {
+        if (fabs(A[n]) < ABSTOL)
+            continue;
+        LOG_STATS("__apply_stm", ODE_JAC_SIZE * ODE_JAC_SIZE, ODE_JAC_SIZE * ODE_JAC_SIZE, 0);
+        double h = A[n] * delta_x;
+        for (size_t i = 0; i < ODE_JAC_SIZE; i++)
+            for (size_t j = 0; j < ODE_JAC_SIZE; j++)
+                Phi1[i][j] += h * K[n][i][j];
+    }
+}
+
+/* Apply accumulator function (explicit stage)
+ * :param size_t N: number of previous stages
+ * :param double A: stage weights
+ * :param double delta_x:
+ * :param double x:
+ * :param st_t* y: stage state
+ * :param st_t* k: output stage derivative
+ * :param double K: stage derivatives of `Phi` (the `N`-th is output)
+ * :param ode_fun_t fun: accumulator function
+ * :param ivp_s* ivp: propagation context
+ *
+ * With a valid `ivp->stm`, evaluates the derivative together with its
+ * Jacobian J, and K[N] = J (Phi + h * sum(A[i] * K[i])).
+ */
+static void __apply_var(
+    size_t N, const double A[],
+    double delta_x,
+    double x,
+    const st_t* y,
+    st_t* restrict k,
+    double K[static N + 1][ODE_JAC_SIZE][ODE_JAC_SIZE],
+    ode_fun_t fun,
+    struct ivp_s* ivp
+) {
+    LOG_STATS("__apply_var", 0, 0, 0);
+    double J[ODE_JAC_SIZE][ODE_JAC_SIZE], Phi[ODE_JAC_SIZE][ODE_JAC_SIZE];
+    if (!__stm_active(ivp)) {
+        __apply_fun(x, y, k, fun, ivp);
+        return;
+    }
+    __apply_jac(x, y, k, J, ivp);
+    __apply_stm(N, A, delta_x, (void*) ivp->stm->Phi, Phi, (void*) K);
+    __stm_mul((void*) J, (void*) Phi, K[N]);
+}
+
+/* Store state transition matrix
+ * :param size_t N: number of stages
+ * :param double b_bar: output weights
+ * :param double delta_x:
+ * :param double K: stage derivatives of `Phi`
+ * :param ivp_s* ivp: propagation context
+ * Called once the step is accepted.
+ */
+static void __store_stm(
+    size_t N, const double b_bar[static N],
+    double delta_x,
+    const double K[static N][ODE_JAC_SIZE][ODE_JAC_SIZE],
+    struct ivp_s* ivp
+) {
+    LOG_STATS("__store_stm", 0, 0, 0);
+    if (!__stm_active(ivp))
+        return;
+    __apply_stm(N, b_bar, delta_x, (void*) ivp->stm->Phi, ivp->stm->Phi, K);
+}
+
+/* Apply accumulator function (first stage)
+ * Reuses the derivative in `ivp->fsal` when it is valid at `x0` (last
+ * stage of the previous step, or first stage of a rejected attempt),
+ * otherwise evaluates and keeps it for a retry from the same state.
+ * With a valid `ivp->stm` and `K`, evaluates the Jacobian (and the
+ * derivative) regardless, see `__apply_var`.
+ */
+static void __apply_first(
+    double x0,
+    const st_t* y0,
+    st_t* restrict k,
+    double K[][ODE_JAC_SIZE][ODE_JAC_SIZE],
+    ode_fun_t fun,
+    struct ivp_s* ivp
+) {
+    LOG_STATS("__apply_first", 0, 0, 0);
+    struct ode_fsal_s* fsal = ivp->fsal;
+    if (K != NULL && __stm_active(ivp))
+        __apply_var(0, NULL, 0.0, x0, y0, k, K, fun, ivp);
+    else if (fsal != NULL && fsal->valid && fsal->x == x0) {
+        st_pos(&fsal->k, k);
+        return;
+    } else
+        __apply_fun(x0, y0, k, fun, ivp);
+    if (fsal != NULL) {
+        fsal->valid = true;
+        fsal->x = x0;
+        st_pos(k, &fsal->k);
+    }
+}
+
+/* Store dense output
+ * :param ivp_s* ivp: propagation context
+ * :param size_t N: number of stages
+ * :param weight_fun: continuous weights
+ * :param double x0:
+ * :param double x1:
+ * :param st_t* y0: input state
+ * :param st_t* k: stage derivatives
+ */
+static void __store_dense(
+    struct ivp_s* ivp, size_t N,
+    void (*weight_fun)(double, double*),
+    double x0, double x1,
+    const st_t* y0,
+    const st_t k[static N]
+) {
+    LOG_STATS("__store_dense", 0, 0, 0);
+    struct ode_dense_s* dense = ivp->dense;
+    if (dense == NULL)
+        return;
+    assert(N <= ODE_DENSE_SIZE);
+    dense->valid = true;
+    dense->size = N;
+    dense->x0 = x0;
+    dense->x1 = x1;
+    dense->weight_fun = weight_fun;
+    st_pos(y0, &dense->y0);
+    memcpy(dense->k, k, N * sizeof(st_t));
+}
+
+/* Dormand-Prince continuous weights (Shampine)
+ * :param double th: step fraction
+ * :param double* b_bar: output weights
+ */
+static void __dopri_dense(double th, double* b_bar)
+{
+    LOG_STATS("__dopri_dense", 12, 40, 0);
+    double a = th * th * (3.0 - 2.0 * th),
+           c = th * th * (th - 1.0) * (th - 1.0);
+    b_bar[0] = a * 35.0 / 384.0 + th * (th - 1.0) * (th - 1.0)
+             - c * 5.0 * (2558722523.0 - 31403016.0 * th) / 11282082432.0;
+    b_bar[1] = 0.0;
+    b_bar[2] = a * 500.0 / 1113.0
+             + c * 100.0 * (882725551.0 - 15701508.0 * th) / 32700410799.0;
+    b_bar[3] = a * 125.0 / 192.0
+             - c * 25.0 * (443332067.0 - 31403016.0 * th) / 1880347072.0;
+    b_bar[4] = - a * 2187.0 / 6784.0
+             + c * 32805.0 * (23143187.0 - 3489224.0 * th) / 199316789632.0;
+    b_bar[5] = a * 11.0 / 84.0
+             - c * 55.0 * (29972135.0 - 7076736.0 * th) / 822651844.0;
+    b_bar[6] = th * th * (th - 1.0)
+             + c * 10.0 * (7414447.0 - 829305.0 * th) / 29380423.0;
+}
+
+/* Gauss-Legendre (6th-order) continuous weights
+ * :param double th: step fraction
+ * :param double* b_bar: output weights
+ * Integrals of the Lagrange basis on the collocation nodes.
+ */
+static void __vgl6_dense(double th, double* b_bar)
+{
+    LOG_STATS("__vgl6_dense", 9, 18, 0);
+    static const
+    double c_bar[3] = {+0.1127016653792583, +0.5, +0.8872983346207417};
+    for (size_t i = 0; i < 3; i++) {
+        double cj = c_bar[(i+1)%3], ck = c_bar[(i+2)%3];
+        b_bar[i] = th * (th * (th / 3.0 - 0.5 * (cj + ck)) + cj * ck)
+                 / ((c_bar[i] - cj) * (c_bar[i] - ck));
+    }
+}
+
+/* Multistep (Adams) weights
+ * :param size_t N: number of nodes
+ * :param double t: nodes (in units of the step)
+ * :param double w: output weights
+ * Integrals over [0, 1] of the Lagrange basis on the nodes.
+ */
+static void __multi_weights(
+    size_t N, const double t[static N],
+    double w[static N]
+) {
+    LOG_STATS("__multi_weights", N * N * N, N * N * N, 0);
+    assert(N <= ODE_MULTI_SIZE + 1);
+    for (size_t i = 0; i < N; i++) {
+        double c[ODE_MULTI_SIZE + 1] = {1.0}, d = 1.0;
+        size_t n = 0;
+        // c = prod(s - t[j]), j != i
+        for (size_t j = 0; j < N; j++) {
+            if (j == i)
+                continue;
+            n++;
+            for (size_t m = n; m > 0; m--)
+                c[m] = c[m-1] - t[j] * c[m];
+            c[0] *= - t[j];
+            d *= t[i] - t[j];
+        }
+        w[i] = 0.0;
+        for (size_t m = 0; m <= n; m++)
+            w[i] += c[m] / (m + 1);
+        w[i] /= d;
     }
 }
 
@@ -44,15 +409,432 @@ static bool __check_error(
     return done;
 }
 
+/* Count implicit stage iterations
+ * :param ivp_s* ivp: propagation context
+ * :param size_t n: number of sweeps
+ */
+static inline void __count_iter(
+    struct ivp_s* ivp,
+    size_t n
+) {
+    if (ivp->stats != NULL)
+        ivp->stats->n_iter += n;
+}
+
+/* Count Newton fallback
+ * :param ivp_s* ivp: propagation context
+ * :returns bool: `false` (not converged, sweep the fixed point instead)
+ */
+static inline bool __count_fallback(
+    struct ivp_s* ivp
+) {
+    if (ivp->stats != NULL)
+        ivp->stats->n_fallback++;
+    return false;
+}
+
+#define NEWTON_SIZE (3 * ODE_JAC_SIZE)  // largest stage system (`vgl6`)
+
+/* State derivative tangent vector
+ * :param st_t* k: input state derivative
+ * :param double* u: output vector (r_bar, th_bar, v_bar, om_bar)
+ */
+static void __st_tangent(
+    const st_t* k,
+    double* restrict u
+) {
+    LOG_STATS("__st_tangent", 0, 0, 0);
+    vec_pos(k->r_bar, &u[0]);
+    quat_log(k->q, &u[3]);
+    vec_pos(k->v_bar, &u[6]);
+    vec_pos(k->om_bar, &u[9]);
+}
+
+/* LU factorization (partial pivoting)
+ * :param size_t n: dimension
+ * :param double A: input matrix, output factors
+ * :param size_t* p: output row interchanges
+ * :returns bool: non-singular
+ *
+ * Skips zero multipliers, `I - h * (A x J)` is mostly sparse.
+ */
+static bool __lu_factor(
+    size_t n,
+    double A[static n][NEWTON_SIZE],
+    size_t p[static n]
+) {
+    LOG_STATS("__lu_factor", n * n * n / 3, n * n * n / 3, 0);
+    for (size_t j = 0; j < n; j++) {
+        size_t m = j;
+        for (size_t i = j + 1; i < n; i++)
+            if (fabs(A[i][j]) > fabs(A[m][j]))
+                m = i;
+        if (fabs(A[m][j]) < ABSTOL)
+            return false;
+        p[j] = m;
+        if (m != j)
+            for (size_t k = 0; k < n; k++) {
+                double foo = A[j][k];
+                A[j][k] = A[m][k];
+                A[m][k] = foo;
+            }
+        for (size_t i = j + 1; i < n; i++) {
+            if (A[i][j] == 0.0)
+                continue;
+            double s = A[i][j] /= A[j][j];
+            for (size_t k = j + 1; k < n; k++)
+                A[i][k] -= s * A[j][k];
+        }
+    }
+    return true;
+}
+
+/* LU substitution
+ * :param size_t n: dimension
+ * :param double A: factors (see `__lu_factor`)
+ * :param size_t* p: row interchanges
+ * :param double* b: input right-hand side, output solution
+ */
+static void __lu_solve(
+    size_t n,
+    const double A[static n][NEWTON_SIZE],
+    const size_t p[static n],
+    double b[static n]
+) {
+    LOG_STATS("__lu_solve", n * n, n * n, 0);
+    for (size_t i = 0; i < n; i++) {
+        double foo = b[p[i]];
+        b[p[i]] = b[i];
+        for (size_t k = 0; k < i; k++)
+            foo -= A[i][k] * b[k];
+        b[i] = foo;
+    }
+    for (size_t i = n; i-- > 0;) {
+        double foo = b[i];
+        for (size_t k = i + 1; k < n; k++)
+            foo -= A[i][k] * b[k];
+        b[i] = foo / A[i][i];
+    }
+}
+
+/* Predict implicit stages
+ * :param size_t N: number of stages
+ * :param double A: stage weights
+ * :param double c_bar: stage nodes
+ * :param double x0:
+ * :param st_t* y0: input state
+ * :param double delta_x:
+ * :param st_t* k: output stage derivatives (initial guess)
+ * :param ivp_s* ivp: propagation context
+ * :returns bool: warm start
+ *
+ * Evaluates the derivative of the collocation polynomial in `ivp->stage`
+ * (the Lagrange polynomial through its stages) at the new nodes; zero
+ * otherwise. The rotation rates follow from the predicted stage rates,
+ * since the stored ones are relative to the last `y0`.
+ */
+static bool __predict_stage(
+    size_t N, const double A[static N][N], const double c_bar[static N],
+    double x0, const st_t* y0, double delta_x,
+    st_t k[static N],
+    struct ivp_s* ivp
+) {
+    LOG_STATS("__predict_stage", 0, 0, 0);
+    const struct ode_stage_s* stage = ivp->stage;
+    for (size_t i = 0; i < N; i++)
+        st_zero(&k[i]);
+    if (
+        stage == NULL || !stage->valid || stage->size != N
+        || (x0 != stage->x0 && x0 != stage->x1)
+    ) return false;
+    double h = stage->x1 - stage->x0;
+    if (
+        delta_x * ODE_STAGE_RATIO < h
+        || delta_x > h * ODE_STAGE_RATIO
+    ) return false;
+    vec_t w_bar[ODE_STAGE_SIZE], th_bar, temp;
+    for (size_t i = 0; i < N; i++) {
+        LOG_STATS("__predict_stage", 3 * N * N, 3 * N * N, 0);
+        double th = (x0 + c_bar[i] * delta_x - stage->x0) / h;
+        for (size_t j = 0; j < N; j++) {
+            double w = 1.0;
+            for (size_t m = 0; m < N; m++)
+                if (m != j)
+                    w *= (th - c_bar[m]) / (c_bar[j] - c_bar[m]);
+            for (size_t l = 0; l < 3; l++) {
+                k[i].r_bar[l] += w * stage->k[j].r_bar[l];
+                k[i].v_bar[l] += w * stage->k[j].v_bar[l];
+                k[i].om_bar[l] += w * stage->k[j].om_bar[l];
+            }
+        }
+    }
+    // w_bar = (om_bar + h * A * k) / 2
+    for (size_t i = 0; i < N; i++) {
+        vec_pos(y0->om_bar, w_bar[i]);
+        for (size_t j = 0; j < N; j++) {
+            vec_muls(k[j].om_bar, A[i][j] * delta_x, temp);
+            vec_add(w_bar[i], temp, w_bar[i]);
+        }
+        vec_muls(w_bar[i], 0.5, w_bar[i]);
+    }
+    for (size_t i = 0; i < N; i++) {
+        vec_zero(th_bar);
+        for (size_t j = 0; j < N; j++) {
+            vec_muls(w_bar[j], A[i][j] * delta_x, temp);
+            vec_add(th_bar, temp, th_bar);
+        }
+        vec_exp(w_bar[i], k[i].q);
+        __apply_dexpinv(th_bar, &k[i]);
+    }
+    return true;
+}
+
+/* Store implicit stages
+ * :param size_t N: number of stages
+ * :param double x0:
+ * :param double x1:
+ * :param st_t* k: stage derivatives
+ * :param ivp_s* ivp: propagation context
+ */
+static void __store_stage(
+    size_t N,
+    double x0, double x1,
+    const st_t k[static N],
+    struct ivp_s* ivp
+) {
+    LOG_STATS("__store_stage", 0, 0, 0);
+    struct ode_stage_s* stage = ivp->stage;
+    if (stage == NULL)
+        return;
+    assert(N <= ODE_STAGE_SIZE);
+    stage->valid = true;
+    stage->size = N;
+    stage->x0 = x0;
+    stage->x1 = x1;
+    memcpy(stage->k, k, N * sizeof(st_t));
+}
+
+/* Solve implicit stages (simplified Newton)
+ * :param size_t N: number of stages
+ * :param double A: stage weights
+ * :param double c_bar: stage nodes
+ * :param double x0:
+ * :param st_t* y0: input state
+ * :param double delta_x:
+ * :param st_t* k: stage derivatives (initial guess)
+ * :param ode_fun_t fun: accumulator function
+ * :param ivp_s* ivp: propagation context
+ * :returns bool: converged (`k` is restored to the initial guess otherwise)
+ *
+ * Iterates on the tangent vectors of the stage derivatives with the
+ * matrix I - h * (A x J), J = `ivp->jac` at `y0`, factored once.
+ */
+static bool __solve_newton(
+    size_t N, const double A[static N][N], const double c_bar[static N],
+    double x0, const st_t* y0, double delta_x,
+    st_t k[static N],
+    ode_fun_t fun,
+    struct ivp_s* ivp
+) {
+    LOG_STATS("__solve_newton", 0, 0, 0);
+    double J[ODE_JAC_SIZE][ODE_JAC_SIZE], M[NEWTON_SIZE][NEWTON_SIZE],
+           u[NEWTON_SIZE], w[ODE_JAC_SIZE];
+    size_t p[NEWTON_SIZE], n = N * ODE_JAC_SIZE;
+    st_t guess[NEWTON_SIZE / ODE_JAC_SIZE];
+    assert(n <= NEWTON_SIZE);
+    memcpy(guess, k, N * sizeof(st_t));
+    
+    // M = I - h * (A x J), with the rotation chart (see `__apply_dexpinv`)
+    // linearized at the stage angle th_bar = c * h * om_bar / 2
+    ivp->jac(x0, y0, NULL, J, ivp);
+    if (ivp->stats != NULL)
+        ivp->stats->n_jac++;
+    vec_t w_bar, th_bar;
+    mat_t W, T;
+    vec_muls(y0->om_bar, 0.5, w_bar);
+    vec_cross_mat(w_bar, W);
+    for (size_t i = 0; i < N; i++) {
+        double J_i[ODE_JAC_SIZE][ODE_JAC_SIZE];
+        memcpy(J_i, J, sizeof(J));
+        vec_muls(w_bar, c_bar[i] * delta_x, th_bar);
+        vec_cross_mat(th_bar, T);
+        for (size_t a = 0; a < 3; a++)
+            for (size_t b = 0; b < 3; b++) {
+                J_i[3 + a][3 + b] -= W[a][b];
+                J_i[3 + a][9 + b] += 0.5 * T[a][b];
+            }
+        for (size_t j = 0; j < N; j++)
+            for (size_t a = 0; a < ODE_JAC_SIZE; a++)
+                for (size_t b = 0; b < ODE_JAC_SIZE; b++)
+                    M[i * ODE_JAC_SIZE + a][j * ODE_JAC_SIZE + b] = (
+                        (i == j && a == b ? 1.0 : 0.0)
+                        - delta_x * A[i][j] * J_i[a][b]
+                    );
+    }
+    if (!__lu_factor(n, M, p))
+        return false;
+    
+    bool done = false;
+    size_t m;
+    for (m = 0; m < MAXITER && !done; m++) {
+        LOG_STATS("__solve_newton", 0, 0, 0);
+        st_t y, delta_k;
+        // u = f(x0 + c * h, y0 + h * A * k) - k
+        for (size_t i = 0; i < N; i++) {
+            __apply_stage(N, A[i], delta_x, y0, &y, k, th_bar);
+            __apply_fun(x0 + c_bar[i] * delta_x, &y, &delta_k, fun, ivp);
+            __apply_dexpinv(th_bar, &delta_k);
+            __st_tangent(&delta_k, &u[i * ODE_JAC_SIZE]);
+            __st_tangent(&k[i], w);
+            for (size_t j = 0; j < ODE_JAC_SIZE; j++)
+                u[i * ODE_JAC_SIZE + j] -= w[j];
+        }
+        // k += M^-1 * u
+        __lu_solve(n, (void*) M, p, u);
+        done = true;
+        for (size_t i = 0; i < N; i++) {
+            double* v = &u[i * ODE_JAC_SIZE];
+            __st_tangent(&k[i], w);
+            vec_pos(&v[0], delta_k.r_bar);
+            vec_exp(&v[3], delta_k.q);
+            vec_pos(&v[6], delta_k.v_bar);
+            vec_pos(&v[9], delta_k.om_bar);
+            vec_add(k[i].r_bar, &v[0], k[i].r_bar);
+            vec_add(&w[3], &v[3], &w[3]);
+            vec_exp(&w[3], k[i].q);
+            vec_add(k[i].v_bar, &v[6], k[i].v_bar);
+            vec_add(k[i].om_bar, &v[9], k[i].om_bar);
+            done &= __check_error(&delta_k, &k[i]);
+        }
+    }
+    __count_iter(ivp, m);
+    if (!done)
+        memcpy(k, guess, N * sizeof(st_t));
+    return done;
+}
+
+/* Solve state transition matrix stages (fixed point)
+ * :param size_t N: number of stages
+ * :param double A: stage weights
+ * :param double delta_x:
+ * :param double J: stage Jacobians
+ * :param double K: input initial guess, output stage derivatives of `Phi`
+ * :param ivp_s* ivp: propagation context
+ * :returns bool: converged
+ *
+ * Sweeps the stages as the fixed point iteration of the stages themselves,
+ * which contracts at the same rate (its linearization).
+ */
+static bool __solve_stm_fixed(
+    size_t N, const double A[static N][N],
+    double delta_x,
+    const double J[static N][ODE_JAC_SIZE][ODE_JAC_SIZE],
+    double K[static N][ODE_JAC_SIZE][ODE_JAC_SIZE],
+    struct ivp_s* ivp
+) {
+    LOG_STATS("__solve_stm_fixed", 0, 0, 0);
+    double Phi[ODE_JAC_SIZE][ODE_JAC_SIZE], L[ODE_JAC_SIZE][ODE_JAC_SIZE];
+    bool done = false;
+    for (size_t n = 0; n < MAXITER && !done; n++) {
+        done = n > 0;
+        for (size_t i = 0; i < N; i++) {
+            double foo = 0.0, bar = 0.0;
+            __apply_stm(N, A[i], delta_x, (void*) ivp->stm->Phi, Phi, (void*) K);
+            __stm_mul((void*) J[i], (void*) Phi, L);
+            for (size_t a = 0; a < ODE_JAC_SIZE; a++)
+                for (size_t b = 0; b < ODE_JAC_SIZE; b++) {
+                    foo += (L[a][b] - K[i][a][b]) * (L[a][b] - K[i][a][b]);
+                    bar += L[a][b] * L[a][b];
+                }
+            memcpy(K[i], L, ODE_JAC_SIZE * sizeof(L[0]));
+            done &= sqrt(foo) < ABSTOL + RELTOL * sqrt(bar);
+        }
+    }
+    return done;
+}
+
+/* Store state transition matrix (implicit stages)
+ * :param size_t N: number of stages
+ * :param double A: stage weights
+ * :param double b_bar: output weights
+ * :param double c_bar: stage nodes
+ * :param double x0:
+ * :param st_t* y0: input state
+ * :param double delta_x:
+ * :param st_t* k: stage derivatives (converged)
+ * :param ivp_s* ivp: propagation context
+ *
+ * Evaluates the Jacobians J[i] at the stages and solves the (linear)
+ * stage system of the variational equations,
+ * K[i] = J[i] (Phi + h * sum(A[i][j] * K[j])), as the stages were solved:
+ * by fixed point iteration, or (Newton, or no convergence) one column at a
+ * time with the factors of I - h * (A x J). Called once the step is
+ * accepted.
+ */
+static void __store_stm_implicit(
+    size_t N, const double A[static N][N],
+    const double b_bar[static N], const double c_bar[static N],
+    double x0, const st_t* y0, double delta_x,
+    const st_t k[static N],
+    struct ivp_s* ivp
+) {
+    LOG_STATS("__store_stm_implicit", 0, 0, 0);
+    double J[ODE_STAGE_SIZE][ODE_JAC_SIZE][ODE_JAC_SIZE],
+           K[ODE_STAGE_SIZE][ODE_JAC_SIZE][ODE_JAC_SIZE],
+           M[NEWTON_SIZE][NEWTON_SIZE], u[NEWTON_SIZE];
+    size_t p[NEWTON_SIZE], n = N * ODE_JAC_SIZE;
+    st_t y;
+    assert(N <= ODE_STAGE_SIZE);
+    if (!__stm_active(ivp))
+        return;
+    for (size_t i = 0; i < N; i++) {
+        __apply_stage(N, A[i], delta_x, y0, &y, k, NULL);
+        __apply_jac(x0 + c_bar[i] * delta_x, &y, NULL, J[i], ivp);
+        __stm_mul((void*) J[i], (void*) ivp->stm->Phi, K[i]);
+    }
+    if (ivp->jac == NULL && __solve_stm_fixed(N, A, delta_x, (void*) J, K, ivp)) {
+        __apply_stm(N, b_bar, delta_x, (void*) ivp->stm->Phi, ivp->stm->Phi, (void*) K);
+        return;
+    }
+    for (size_t i = 0; i < N; i++) {
+        __stm_mul((void*) J[i], (void*) ivp->stm->Phi, K[i]);
+        for (size_t j = 0; j < N; j++)
+            for (size_t a = 0; a < ODE_JAC_SIZE; a++)
+                for (size_t b = 0; b < ODE_JAC_SIZE; b++)
+                    M[i * ODE_JAC_SIZE + a][j * ODE_JAC_SIZE + b] = (
+                        (i == j && a == b ? 1.0 : 0.0)
+                        - delta_x * A[i][j] * J[i][a][b]
+                    );
+    }
+    if (!__lu_factor(n, M, p)) {
+        __stm_invalid(ivp);
+        return;
+    }
+    for (size_t c = 0; c < ODE_JAC_SIZE; c++) {
+        LOG_STATS("__store_stm_implicit", 0, 0, 0);
+        for (size_t i = 0; i < N; i++)
+            for (size_t a = 0; a < ODE_JAC_SIZE; a++)
+                u[i * ODE_JAC_SIZE + a] = K[i][a][c];
+        __lu_solve(n, (void*) M, p, u);
+        for (size_t i = 0; i < N; i++)
+            for (size_t a = 0; a < ODE_JAC_SIZE; a++)
+                K[i][a][c] = u[i * ODE_JAC_SIZE + a];
+    }
+    __apply_stm(N, b_bar, delta_x, (void*) ivp->stm->Phi, ivp->stm->Phi, (void*) K);
+}
+
 #ifdef ODE_EULER
 FUNCTION_ODE_METHOD(euler) {
     LOG_STATS("ode_euler", 1, 0, 0);
-    double delta_x = x1 - x0;
+    static const
+    double b_bar[1] = {1.0};
+    double delta_x = x1 - x0, K[1][ODE_JAC_SIZE][ODE_JAC_SIZE];
     st_t k;
     // k = f(x0, y0)
-    fun(x0, y0, &k, nargs, vargs);
+    __apply_first(x0, y0, &k, K, fun, ivp);
     // y1 = y0 + h * k
     st_int(delta_x, &k, y0, y1);
+    __store_stm(1, b_bar, delta_x, (void*) K, ivp);
     return true;
 }
 #endif
@@ -61,8 +843,9 @@ FUNCTION_ODE_METHOD(verlet) {
     LOG_STATS("ode_verlet", 1, 2, 0);
     double delta_x = x1 - x0;
     st_t k;
+    __stm_invalid(ivp);
     // k = f(x0, y0)
-    fun(x0, y0, &k, nargs, vargs);
+    __apply_first(x0, y0, &k, NULL, fun, ivp);
     // y1 = y0 + h * k
     vec_t foo;
     quat_t bar, temp;
@@ -83,33 +866,31 @@ FUNCTION_ODE_METHOD(rk4) {
     static const
     double A[3][3] = {
             {0.5          },
-            {0,0, 0.5     },
+            {0.0, 0.5     },
             {0.0, 0.0, 1.0},
         },
         b_bar[4] = {0.16666666666666666, 0.33333333333333333, 0.33333333333333333, 0.16666666666666666},
         c_bar[3] = {0.5, 0.5, 1.0};
     
-    double delta_x = x1 - x0;
+    double delta_x = x1 - x0, K[4][ODE_JAC_SIZE][ODE_JAC_SIZE];
     st_t k[4], y;
+    vec_t th_bar;
     
     // k[0] = f(x0, y0)
-    va_list cargs;
-    va_copy(cargs, *vargs);
-    fun(x0, y0, &k[0], nargs, &cargs);
-    va_end(cargs);
+    __apply_first(x0, y0, &k[0], K, fun, ivp);
     
     // k[1] = f(x0 + h / 2, y0 + h * k[0] / 2)
     // k[2] = f(x0 + h / 2, y0 + h * k[1] / 2)
     // k[3] = f(x0 + h, y0 + h * k[2])
      for (size_t i = 0; i < 3; i++) {
-        __apply_stage(i+1, A[i], delta_x, y0, &y, k);
-        va_copy(cargs, *vargs);
-        fun(x0 + c_bar[i] * delta_x, &y, &k[i+1], nargs, &cargs);
-        va_end(cargs);
+        __apply_stage(i+1, A[i], delta_x, y0, &y, k, th_bar);
+        __apply_var(i+1, A[i], delta_x, x0 + c_bar[i] * delta_x, &y, &k[i+1], K, fun, ivp);
+        __apply_dexpinv(th_bar, &k[i+1]);
     }
     
     // y1 = y0 + h * (k[0] / 6 + k[1] / 3 + k[2] / 3 + k[3] / 6)
-     __apply_stage(4, b_bar, delta_x, y0, y1, k);
+     __apply_stage(4, b_bar, delta_x, y0, y1, k, NULL);
+    __store_stm(4, b_bar, delta_x, (void*) K, ivp);
     return true;
 }
 
@@ -119,24 +900,20 @@ FUNCTION_ODE_METHOD(heuler) {
     assert(step != NULL);
     double delta_x = x1 - x0;
     st_t k, y2, temp;
+    __stm_invalid(ivp);
     
     // k[0] = f(x0, y0)
-    va_list cargs;
-    va_copy(cargs, *vargs);
-    fun(x0, y0, k, nargs, &cargs);
-    va_end(cargs);
+    __apply_first(x0, y0, &k, NULL, fun, ivp);
     st_int(0.5 * delta_x, &k, y0, &temp);
     
     // k[1] = f(x0 + h, y0 + h * k[0])
-    va_copy(cargs, *vargs);
     st_int(delta_x, &k, y0, y1);
-    fun(x1, y1, &k, nargs, &cargs);
-    va_end(cargs);
+    __apply_fun(x1, y1, &k, fun, ivp);
     st_int(0.5 * delta_x, &k, &temp, &y2);
     
     // y2 = y0 + h * (k[0] + k[1]) / 2
     // y1 = y0 + h * k[0]
-    return step(y0, y1, &y2, 1, nargs, vargs);
+    return step(y0, y1, &y2, 1, ivp);
 }
 #endif
 
@@ -155,14 +932,13 @@ FUNCTION_ODE_METHOD(dopri) {
         c_bar[6]  = {+0.2                , +0.3, +0.8               , +0.8888888888888888, +1.0               , +1.0                };
     
     assert(step != NULL);
-    double delta_x = x1 - x0;
-    st_t k[7], y2;
+    double delta_x = x1 - x0, K[6][ODE_JAC_SIZE][ODE_JAC_SIZE];
+    st_t k[7], k_bar, y2;
+    vec_t th_bar;
+    struct ode_fsal_s* fsal = ivp->fsal;
     
-    // k[0] = f(x0, y0)
-    va_list cargs;
-    va_copy(cargs, *vargs);
-    fun(x0, y0, &k[0], nargs, &cargs);
-    va_end(cargs);
+    // k[0] = f(x0, y0), or k[6] of the previous step
+    __apply_first(x0, y0, &k[0], K, fun, ivp);
     
     /* k[1] = f(x0 + h / 5, y0 + h * k[0] / 5)
      * k[2] = f(x0 + 3 * h / 10,
@@ -191,10 +967,14 @@ FUNCTION_ODE_METHOD(dopri) {
      *                    +   11 * k[5] / 84))
      */
      for (size_t i = 0; i < 6; i++) {
-        __apply_stage(i+1, A[i], delta_x, y0, y1, k);
-        va_copy(cargs, *vargs);
-        fun(x0 + c_bar[i] * delta_x, y1, &k[i+1], nargs, &cargs);
-        va_end(cargs);
+        __apply_stage(i+1, A[i], delta_x, y0, y1, k, th_bar);
+        if (i < 5)
+            __apply_var(i+1, A[i], delta_x, x0 + c_bar[i] * delta_x, y1, &k[i+1], K, fun, ivp);
+        else  // y1 has no weight on k[6]
+            __apply_fun(x0 + c_bar[i] * delta_x, y1, &k[i+1], fun, ivp);
+        if (i == 5)  // f(x1, y1) as evaluated, for the next step
+            st_pos(&k[6], &k_bar);
+        __apply_dexpinv(th_bar, &k[i+1]);
     }
     
 
@@ -210,8 +990,63 @@ FUNCTION_ODE_METHOD(dopri) {
      *                +   187 * k[5] / 2100
      *                +         k[6] / 40))
      */
-     __apply_stage(7, b2_bar, delta_x, y0, &y2, k);
-    return step(y0, y1, &y2, 4, nargs, vargs);
+     __apply_stage(7, b2_bar, delta_x, y0, &y2, k, NULL);
+    if (!step(y0, y1, &y2, 4, ivp))
+        return false;
+    __store_stm(6, A[5], delta_x, (void*) K, ivp);
+    // k[6] = f(x1, y1) is the next step's k[0]
+    if (fsal != NULL) {
+        fsal->valid = true;
+        fsal->x = x1;
+        st_pos(&k_bar, &fsal->k);
+    }
+    __store_dense(ivp, 7, __dopri_dense, x0, x1, y0, k);
+    return true;
+}
+
+FUNCTION_ODE_METHOD(dop853) {
+    LOG_STATS("ode_dop853", 12, 11, 0);
+    static const
+    double A[11][11] = {
+            {+0.05260015195876773},
+            {+0.0197250569845379, +0.0591751709536137},
+            {+0.02958758547680685,  0.0, +0.08876275643042054},
+            {+0.2413651341592667,  0.0, -0.8845494793282861, +0.924834003261792},
+            {+0.037037037037037035,  0.0,  0.0, +0.17082860872947386, +0.12546768756682242},
+            {+0.037109375,  0.0,  0.0, +0.17025221101954405, +0.06021653898045596, -0.017578125},
+            {+0.03709200011850479,  0.0,  0.0, +0.17038392571223998, +0.10726203044637328, -0.015319437748624402, +0.008273789163814023},
+            {+0.6241109587160757,  0.0,  0.0, -3.3608926294469414, -0.868219346841726, +27.59209969944671, +20.154067550477894, -43.48988418106996},
+            {+0.47766253643826434,  0.0,  0.0, -2.4881146199716677, -0.590290826836843, +21.230051448181193, +15.279233632882423, -33.28821096898486, -0.020331201708508627},
+            {-0.9371424300859873,  0.0,  0.0, +5.186372428844064, +1.0914373489967295, -8.149787010746927, -18.52006565999696, +22.739487099350505, +2.4936055526796523, -3.0467644718982196},
+            {+2.273310147516538,  0.0,  0.0, -10.53449546673725, -2.0008720582248625, -17.9589318631188, +27.94888452941996, -2.8589982771350235, -8.87285693353063, +12.360567175794303, +0.6433927460157636}
+        },
+        b1_bar[12] = {+0.054293734116568765,  0.0,  0.0,  0.0,  0.0, +4.450312892752409, +1.8915178993145003, -5.801203960010585, +0.3111643669578199, -0.1521609496625161, +0.20136540080403034, +0.04471061572777259},
+        b2_bar[12] = {+0.04117368912237389,  0.0,  0.0,  0.0,  0.0, +5.675469339128614, +2.3872768489717506, -7.465581142465571, +0.6614932157077935, -0.48634006837553356, +0.11944219431891463, +0.06706592359165889},
+        c_bar[11]  = {+0.05260015195876773, +0.0789002279381516, +0.1183503419072274, +0.2816496580927726, +0.3333333333333333, +0.25, +0.3076923076923077, +0.6512820512820513, +0.6, +0.8571428571428571, +1.0};
+    
+    assert(step != NULL);
+    double delta_x = x1 - x0, K[12][ODE_JAC_SIZE][ODE_JAC_SIZE];
+    st_t k[12], y2;
+    vec_t th_bar;
+    
+    // k[0] = f(x0, y0)
+    __apply_first(x0, y0, &k[0], K, fun, ivp);
+    
+    // k[i+1] = f(x0 + c[i] * h, y0 + h * sum_j A[i][j] * k[j])
+    for (size_t i = 0; i < 11; i++) {
+        __apply_stage(i+1, A[i], delta_x, y0, y1, k, th_bar);
+        __apply_var(i+1, A[i], delta_x, x0 + c_bar[i] * delta_x, y1, &k[i+1], K, fun, ivp);
+        __apply_dexpinv(th_bar, &k[i+1]);
+    }
+    
+    // y1 = y0 + h * sum_i b1[i] * k[i] (8th-order)
+    // y2 = y0 + h * sum_i b2[i] * k[i] (5th-order, embedded)
+    __apply_stage(12, b1_bar, delta_x, y0, y1, k, NULL);
+    __apply_stage(12, b2_bar, delta_x, y0, &y2, k, NULL);
+    if (!step(y0, y1, &y2, 5, ivp))
+        return false;
+    __store_stm(12, b1_bar, delta_x, (void*) K, ivp);
+    return true;
 }
 
 #ifdef ODE_EULER
@@ -221,14 +1056,12 @@ FUNCTION_ODE_METHOD(beuler) {
     st_t k, delta_k;
     st_zero(&k);
     st_zero(&delta_k);
+    __stm_invalid(ivp);
     
-    va_list cargs;
     bool done = false;
     for (size_t n = 0; n < MAXITER; n++) {
         LOG_STATS("ode_beuler", 13, 13, 0);
-        va_copy(cargs, *vargs);
-        fun(x1, y1, &delta_k, nargs, &cargs);
-        va_end(cargs);
+        __apply_fun(x1, y1, &delta_k, fun, ivp);
         st_sub(&delta_k, &k, &delta_k);
         st_add(&k, &delta_k, &k);
         done = __check_error(&delta_k, &k);
@@ -243,28 +1076,41 @@ FUNCTION_ODE_METHOD(beuler) {
 
 FUNCTION_ODE_METHOD(midp) {
     LOG_STATS("ode_midp", 1, 0, 0);
+    static const
+    double A[1][1] = {{0.5}},
+        b_bar[1] = {1.0},
+        c_bar[1] = {0.5};
+    
     double delta_x = x1 - x0, x;
     st_t k, delta_k, y;
     st_zero(&k);
     st_zero(&delta_k);
     
-    va_list cargs;
     bool done = false;
-    for (size_t n = 0; n < MAXITER; n++) {
-        LOG_STATS("ode_midp", 14, 14, 0);
-        va_copy(cargs, *vargs);
-        x = 0.5 * (x1 + x0);
-        st_interp(x0, y0, x1, y1, x, &y);
-        fun(x, &y, &delta_k, nargs, &cargs);
-        va_end(cargs);
-        st_sub(&delta_k, &k, &delta_k);
-        st_add(&k, &delta_k, &k);
-        done = __check_error(&delta_k, &k);
-        st_int(delta_x, &k, y0, y1);
-        if (n < 2) continue;
-        else if (done) break;
+    if (ivp->jac != NULL)
+        done = (
+            __solve_newton(1, A, c_bar, x0, y0, delta_x, &k, fun, ivp)
+            || __count_fallback(ivp)
+        );
+    if (!done) {
+        size_t n;
+        for (n = 0; n < MAXITER; n++) {
+            LOG_STATS("ode_midp", 14, 14, 0);
+            x = 0.5 * (x1 + x0);
+            st_interp(x0, y0, x1, y1, x, &y);
+            __apply_fun(x, &y, &delta_k, fun, ivp);
+            st_sub(&delta_k, &k, &delta_k);
+            st_add(&k, &delta_k, &k);
+            done = __check_error(&delta_k, &k);
+            st_int(delta_x, &k, y0, y1);
+            if (n < 2) continue;
+            else if (done) break;
+        }
+        __count_iter(ivp, MIN(n + 1, MAXITER));
     }
     assert(done);
+    st_int(delta_x, &k, y0, y1);
+    __store_stm_implicit(1, A, b_bar, c_bar, x0, y0, delta_x, &k, ivp);
     return true;
 }
 
@@ -281,33 +1127,44 @@ FUNCTION_ODE_METHOD(vgl4) {
     
     double delta_x = x1 - x0;
     st_t k[2], delta_k, y2;
-    for (size_t i = 0; i < 2; i++)
-        st_zero(&k[i]);
+    vec_t th_bar;
+    bool warm = __predict_stage(2, A, c_bar, x0, y0, delta_x, k, ivp);
     st_zero(&delta_k);
     
-    va_list cargs;
     bool done = false;
-    for (size_t n = 0; n < MAXITER; n++) {
-        LOG_STATS("ode_vgl4", 27, 27, 0);
-        done = true;
-        for (size_t i = 0; i < 2; i++) {
-            __apply_stage(2, A[i], delta_x, y0, &y2, k);
-            va_copy(cargs, *vargs);
-            fun(x0 + c_bar[i] * delta_x, &y2, &delta_k, nargs, &cargs);
-            va_end(cargs);
-            st_sub(&delta_k, &k[i], &delta_k);
-            st_add(&k[i], &delta_k, &k[i]);
-            done &= __check_error(&delta_k, &k[i]);
+    if (ivp->jac != NULL)
+        done = (
+            __solve_newton(2, A, c_bar, x0, y0, delta_x, k, fun, ivp)
+            || __count_fallback(ivp)
+        );
+    if (!done) {
+        size_t n;
+        for (n = 0; n < MAXITER; n++) {
+            LOG_STATS("ode_vgl4", 27, 27, 0);
+            done = true;
+            for (size_t i = 0; i < 2; i++) {
+                __apply_stage(2, A[i], delta_x, y0, &y2, k, th_bar);
+                __apply_fun(x0 + c_bar[i] * delta_x, &y2, &delta_k, fun, ivp);
+                __apply_dexpinv(th_bar, &delta_k);
+                st_sub(&delta_k, &k[i], &delta_k);
+                st_add(&k[i], &delta_k, &k[i]);
+                done &= __check_error(&delta_k, &k[i]);
+            }
+            if (n < (warm ? 1 : 2)) continue;
+            else if (done) break;
         }
-        if (n < 2) continue;
-        else if (done) break;
+        __count_iter(ivp, MIN(n + 1, MAXITER));
     }
     assert(done);
-    __apply_stage(2, b1_bar, delta_x, y0, y1, k);
-    if (step == NULL)
-        return true;
-    __apply_stage(2, b2_bar, delta_x, y0, &y2, k);
-    return step(y0, y1, &y2, 4, nargs, vargs);
+    __store_stage(2, x0, x1, k, ivp);
+    __apply_stage(2, b1_bar, delta_x, y0, y1, k, NULL);
+    if (step != NULL) {
+        __apply_stage(2, b2_bar, delta_x, y0, &y2, k, NULL);
+        if (!step(y0, y1, &y2, 4, ivp))
+            return false;
+    }
+    __store_stm_implicit(2, A, b1_bar, c_bar, x0, y0, delta_x, k, ivp);
+    return true;
 }
 
 FUNCTION_ODE_METHOD(vgl6) {
@@ -324,33 +1181,134 @@ FUNCTION_ODE_METHOD(vgl6) {
     
     double delta_x = x1 - x0;
     st_t k[3], delta_k, y2;
-    for (size_t i = 0; i < 3; i++)
-        st_zero(&k[i]);
+    vec_t th_bar;
+    bool warm = __predict_stage(3, A, c_bar, x0, y0, delta_x, k, ivp);
     st_zero(&delta_k);
     
-    va_list cargs;
     bool done = false;
-    for (size_t n = 0; n < MAXITER; n++) {
-        LOG_STATS("ode_vgl6", 40, 40, 0);
-        done = true;
-        for (size_t i = 0; i < 3; ++i) {
-            __apply_stage(3, A[i], delta_x, y0, &y2, k);
-            va_copy(cargs, *vargs);
-            fun(x0 + c_bar[i] * delta_x, &y2, &delta_k, nargs, &cargs);
-            va_end(cargs);
-            st_sub(&delta_k, &k[i], &delta_k);
-            st_add(&k[i], &delta_k, &k[i]);
-            done &= __check_error(&delta_k, &k[i]);
+    if (ivp->jac != NULL)
+        done = (
+            __solve_newton(3, A, c_bar, x0, y0, delta_x, k, fun, ivp)
+            || __count_fallback(ivp)
+        );
+    if (!done) {
+        size_t n;
+        for (n = 0; n < MAXITER; n++) {
+            LOG_STATS("ode_vgl6", 40, 40, 0);
+            done = true;
+            for (size_t i = 0; i < 3; ++i) {
+                __apply_stage(3, A[i], delta_x, y0, &y2, k, th_bar);
+                __apply_fun(x0 + c_bar[i] * delta_x, &y2, &delta_k, fun, ivp);
+                __apply_dexpinv(th_bar, &delta_k);
+                st_sub(&delta_k, &k[i], &delta_k);
+                st_add(&k[i], &delta_k, &k[i]);
+                done &= __check_error(&delta_k, &k[i]);
+            }
+            if (n < (warm ? 1 : 2)) continue;
+            else if (done) break;
         }
-        if (n < 2) continue;
-        else if (done) break;
+        __count_iter(ivp, MIN(n + 1, MAXITER));
     }
     assert(done);
-    __apply_stage(3, b1_bar, delta_x, y0, y1, k);
+    __store_stage(3, x0, x1, k, ivp);
+    __apply_stage(3, b1_bar, delta_x, y0, y1, k, NULL);
+    if (step != NULL) {
+        __apply_stage(3, b2_bar, delta_x, y0, &y2, k, NULL);
+        if (!step(y0, y1, &y2, 6, ivp))
+            return false;
+    }
+    __store_stm_implicit(3, A, b1_bar, c_bar, x0, y0, delta_x, k, ivp);
+    __store_dense(ivp, 3, __vgl6_dense, x0, x1, y0, k);
+    return true;
+}
+
+FUNCTION_ODE_METHOD(abm) {
+    LOG_STATS("ode_abm", 2 * ODE_MULTI_SIZE, 0, 0);
+    double delta_x = x1 - x0, t[ODE_MULTI_SIZE], w[ODE_MULTI_SIZE];
+    st_t k[ODE_MULTI_SIZE], y2;
+    vec_t th_bar;
+    struct ode_multi_s* multi = ivp->multi;
+    assert(multi != NULL);
+    __stm_invalid(ivp);
+    
+    // k[0] = f(x0, y0), kept across rejected attempts
+    if (multi->size == 0 || multi->x[0] != x0) {
+        size_t N = MIN(multi->size, ODE_MULTI_SIZE - 1);
+        memmove(&multi->x[1], &multi->x[0], N * sizeof(double));
+        memmove(&multi->q[1], &multi->q[0], N * sizeof(quat_t));
+        memmove(&multi->k[1], &multi->k[0], N * sizeof(st_t));
+        multi->size = N + 1;
+        multi->x[0] = x0;
+        quat_pos(y0->q, multi->q[0]);
+        __apply_first(x0, y0, &multi->k[0], NULL, fun, ivp);
+    }
+    // start up (or restart) with a single-step method
+    if (multi->size < ODE_MULTI_SIZE)
+        return (step != NULL ? ODE_METHOD_NAME(dopri) : ODE_METHOD_NAME(rk4))
+            (x0, y0, x1, y1, fun, step, ivp);
+    
+    // rotation rates of the increments from y0 (see `__apply_dexpinv`)
+    memcpy(k, multi->k, ODE_MULTI_SIZE * sizeof(st_t));
+    for (size_t i = 1; i < ODE_MULTI_SIZE; i++) {
+        quat_t foo, bar;
+        quat_conj(y0->q, foo);
+        quat_mul(foo, multi->q[i], bar);
+        quat_log(bar, th_bar);
+        __apply_dexpinv(th_bar, &k[i]);
+    }
+    
+    // y2 = y0 + h * sum(b[i] * k[i]), Adams-Bashforth predictor
+    for (size_t i = 0; i < ODE_MULTI_SIZE; i++)
+        t[i] = (multi->x[i] - x0) / delta_x;
+    __multi_weights(ODE_MULTI_SIZE, t, w);
+    __apply_stage(ODE_MULTI_SIZE, w, delta_x, y0, &y2, k, th_bar);
+    
+    // y1 = y0 + h * (b[0] * f(x1, y2) + sum(b[i] * k[i-1])), Adams-Moulton corrector
+    t[0] = 1.0;
+    for (size_t i = 1; i < ODE_MULTI_SIZE; i++)
+        t[i] = (multi->x[i-1] - x0) / delta_x;
+    __multi_weights(ODE_MULTI_SIZE, t, w);
+    memmove(&k[1], &k[0], (ODE_MULTI_SIZE - 1) * sizeof(st_t));
+    __apply_fun(x1, &y2, &k[0], fun, ivp);
+    __apply_dexpinv(th_bar, &k[0]);
+    __apply_stage(ODE_MULTI_SIZE, w, delta_x, y0, y1, k, NULL);
+    
+    // the next step evaluates (or takes from `ivp->fsal`) f(x1, y1)
     if (step == NULL)
         return true;
-    __apply_stage(3, b2_bar, delta_x, y0, &y2, k);
-    return step(y0, y1, &y2, 6, nargs, vargs);
+    return step(y0, y1, &y2, ODE_MULTI_SIZE, ivp);
+}
+
+bool
+ode_dense_eval(
+    const struct ode_dense_s* dense,
+    double x,
+    st_t* restrict y
+) {
+    LOG_STATS("ode_dense_eval", 0, 0, 0);
+    double b_bar[ODE_DENSE_SIZE], delta_x = dense->x1 - dense->x0;
+    if (!dense->valid || x < MIN(dense->x0, dense->x1) || x > MAX(dense->x0, dense->x1))
+        return false;
+    dense->weight_fun((x - dense->x0) / delta_x, b_bar);
+    __apply_stage(dense->size, b_bar, delta_x, &dense->y0, y, dense->k, NULL);
+    return true;
+}
+
+bool
+solve_ivp_ctx(
+    double x0, const st_t* y0,
+    double x1, st_t* restrict y1,
+    ode_meth_t meth, ode_fun_t fun, ode_step_t step,
+    struct ivp_s* ivp
+) {
+    LOG_STATS("solve_ivp_ctx", 0, 0, 0);
+    if (meth == NULL) meth = ode_default_meth;
+    bool flag = meth(x0, y0, x1, y1, fun, step, ivp);
+    if (ivp->stats != NULL) {
+        if (flag) ivp->stats->n_accept++;
+        else      ivp->stats->n_reject++;
+    }
+    return flag;
 }
 
 bool
@@ -361,11 +1319,26 @@ solve_ivp(
     size_t nargs, ...
 ) {
     LOG_STATS("solve_ivp", 0, 0, 0);
-    if (meth == NULL) meth = ode_default_meth;
+    assert(nargs >= 9);
+    struct ivp_s ivp;
     va_list vargs;
     va_start(vargs, nargs);
-    bool done = meth(x0, y0, x1, y1, fun, step, nargs, &vargs);
+    ivp.size        = va_arg(vargs, size_t);
+    ivp.cfg         = va_arg(vargs, void*);
+    ivp.prev        = va_arg(vargs, void*);
+    ivp.next        = va_arg(vargs, void*);
+    ivp.curr        = va_arg(vargs, void*);
+    ivp.in          = va_arg(vargs, void*);
+    ivp.out         = va_arg(vargs, void*);
+    ivp.em          = va_arg(vargs, void*);
+    ivp.force_model = va_arg(vargs, void*);
+    ivp.fsal        = NULL;
+    ivp.stats       = NULL;
+    ivp.dense       = NULL;
+    ivp.multi       = NULL;
+    ivp.stage       = NULL;
+    ivp.jac         = NULL;
+    ivp.stm         = NULL;
     va_end(vargs);
-    return done;
+    return solve_ivp_ctx(x0, y0, x1, y1, meth, fun, step, &ivp);
 }
-
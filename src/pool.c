@@ -0,0 +1,144 @@
+
+#include "pool.h"
+#include "util.h"
+#include "log.h"
+
+static bool __take_task(
+    struct pool_task_s* task,
+    bool steal,
+    size_t* idx
+) {
+    bool found = false;
+    pthread_mutex_lock(&task->lock);
+    if (task->lo < task->hi) {
+        // owner takes from the head, thieves from the tail
+        *idx = steal ? --task->hi : task->lo++;
+        found = true;
+    }
+    pthread_mutex_unlock(&task->lock);
+    return found;
+}
+
+static void* __run_worker(void* arg)
+{
+    struct pool_task_s* task = arg;
+    struct pool_s* pool = task->pool;
+    size_t self = task - pool->task_lst;
+    unsigned long gen = 0;
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (pool->gen == gen && !pool->quit)
+            pthread_cond_wait(&pool->start, &pool->lock);
+        if (pool->quit)
+            break;
+        gen = pool->gen;
+        pthread_mutex_unlock(&pool->lock);
+        for (;;) {
+            size_t idx;
+            bool found = __take_task(task, false, &idx);
+            for (size_t i = 1; !found && i < pool->size; i++)
+                found = __take_task(&pool->task_lst[(self + i) % pool->size], true, &idx);
+            if (!found)
+                break;
+            pool->job.vehicle_model[idx].ch.clk.t = pool->job.t;
+            solve_vehicle_model(
+                &pool->job.vehicle_model[idx],
+                &pool->job.batch[idx],
+                pool->job.meth,
+                pool->job.force_model
+            );
+        }
+        pthread_mutex_lock(&pool->lock);
+#ifdef __DEBUG__
+        // hand the (per thread) operation counts over to `pool_solve`
+        pool->stats[0] += stats_total_add;
+        pool->stats[1] += stats_total_mul;
+        pool->stats[2] += stats_total_pow;
+        stats_total_add = stats_total_mul = stats_total_pow = 0;
+#endif
+        if (--pool->busy == 0)
+            pthread_cond_signal(&pool->done);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+bool pool_init(
+    struct pool_s* restrict pool,
+    size_t size
+) {
+    LOG_STATS("pool_init", 0, 0, 0);
+    pool->size = MAX(1, MIN(size, MAX_THREAD_COUNT));
+    pool->gen = 0;
+    pool->busy = 0;
+    pool->quit = false;
+    pool->stats[0] = pool->stats[1] = pool->stats[2] = 0;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    for (size_t i = 0; i < pool->size; i++) {
+        pool->task_lst[i].pool = pool;
+        pool->task_lst[i].lo = pool->task_lst[i].hi = 0;
+        pthread_mutex_init(&pool->task_lst[i].lock, NULL);
+    }
+    for (size_t i = 0; i < pool->size; i++)
+        if (pthread_create(&pool->thread_lst[i], NULL, __run_worker, &pool->task_lst[i]) != 0) {
+            LOG_ERROR("pthread_create: `%zu`", i);
+            for (size_t j = i; j < pool->size; j++)
+                pthread_mutex_destroy(&pool->task_lst[j].lock);
+            pool->size = i;
+            pool_free(pool);
+            return false;
+        }
+    return true;
+}
+
+void pool_free(
+    struct pool_s* restrict pool
+) {
+    LOG_STATS("pool_free", 0, 0, 0);
+    pthread_mutex_lock(&pool->lock);
+    pool->quit = true;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+    for (size_t i = 0; i < pool->size; i++)
+        pthread_join(pool->thread_lst[i], NULL);
+    for (size_t i = 0; i < pool->size; i++)
+        pthread_mutex_destroy(&pool->task_lst[i].lock);
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->start);
+    pthread_mutex_destroy(&pool->lock);
+}
+
+void pool_solve(
+    struct pool_s* restrict pool,
+    size_t N, double t,
+    struct vehicle_model_s vehicle_model[static N],
+    struct batch_s batch[static N],
+    ode_meth_t meth,
+    const struct force_model_s* force_model
+) {
+    LOG_STATS("pool_solve", 0, 0, 0);
+    pool->job.t = t;
+    pool->job.vehicle_model = vehicle_model;
+    pool->job.batch = batch;
+    pool->job.meth = meth;
+    pool->job.force_model = force_model;
+    for (size_t i = 0; i < pool->size; i++) {
+        pool->task_lst[i].lo = N * i / pool->size;
+        pool->task_lst[i].hi = N * (i + 1) / pool->size;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->busy = pool->size;
+    pool->gen++;
+    pthread_cond_broadcast(&pool->start);
+    while (pool->busy > 0)
+        pthread_cond_wait(&pool->done, &pool->lock);
+#ifdef __DEBUG__
+    stats_total_add += pool->stats[0];
+    stats_total_mul += pool->stats[1];
+    stats_total_pow += pool->stats[2];
+    pool->stats[0] = pool->stats[1] = pool->stats[2] = 0;
+#endif
+    pthread_mutex_unlock(&pool->lock);
+}
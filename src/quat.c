@@ -4,6 +4,13 @@
 #include "quat.h"
 #include "log.h"
 
+extern inline void quat_add(const quat_t, const quat_t, quat_t);
+extern inline void quat_sub(const quat_t, const quat_t, quat_t);
+extern inline void quat_muls(const quat_t, double, quat_t);
+extern inline void quat_mul(const quat_t, const quat_t, quat_t);
+extern inline void vec_rot(const quat_t, const vec_t, vec_t);
+extern inline void vec_irot(const quat_t, const vec_t, vec_t);
+
 void quat_one(quat_t q) 
 {
     LOG_STATS("quat_one", 0, 0, 0);
@@ -58,27 +65,6 @@ bool quat_unit(const quat_t p, quat_t q)
     return true;
 }
 
-void quat_add(const quat_t p, const quat_t q, quat_t r)
-{
-    LOG_STATS("quat_add", 4, 0, 0);
-    for (size_t i = 0; i < 4; i++)
-        r[i] = p[i] + q[i];
-}
-
-void quat_sub(const quat_t p, const quat_t q, quat_t r)
-{
-    LOG_STATS("quat_sub", 4, 0, 0);
-    for (size_t i = 0; i < 4; i++)
-        r[i] = p[i] - q[i];
-}
-
-void quat_muls(const quat_t p, double s, quat_t q)
-{
-    LOG_STATS("quat_muls", 0, 4, 0);
-    for (size_t i = 0; i < 4; i++)
-        q[i] = p[i] * s;
-}
-
 void quat_mulv(const quat_t p, const vec_t v_bar, quat_t q)
 {
     LOG_STATS("quat_mulv", 9, 12, 0);
@@ -113,27 +99,6 @@ void quat_vmul(const vec_t v_bar, const quat_t p, quat_t q)
          + v_bar[0] * p[2];
 }
 
-void quat_mul(const quat_t p, const quat_t q, quat_t r)
-{
-    LOG_STATS("quat_mul", 12, 16, 0);
-    r[0] = p[0] * q[0]
-         - p[1] * q[1]
-         - p[2] * q[2]
-         - p[3] * q[3];
-    r[1] = p[0] * q[1]
-         + p[1] * q[0]
-         + p[2] * q[3]
-         - p[3] * q[2];
-    r[2] = p[0] * q[2]
-         - p[1] * q[3]
-         + p[2] * q[0]
-         + p[3] * q[1];
-    r[3] = p[0] * q[3]
-         + p[1] * q[2]
-         - p[2] * q[1]
-         + p[3] * q[0];
-}
-
 void quat_pow(const quat_t q, double t, quat_t q__t)
 {
     LOG_STATS("quat_pow", 0, 2, 3);
@@ -173,49 +138,58 @@ void quat_log(const quat_t q, vec_t v_bar)
     }
 }
 
-void vec_rot(const quat_t q, const vec_t u_bar, vec_t v_bar)
+void vec_rot_n(const quat_t q, size_t n, const vec_t u_bar[], vec_t v_bar[])
 {
-    LOG_STATS("vec_rot", 0, 0, 0);
-    assert(quat_isunit(q));
-    quat_t foo, bar;
-    quat_conj(q, foo);
-    quat_vmul(u_bar, foo, bar);
-    quat_mul(q, bar, foo);
-    assert(fabs(foo[0]) < ABSTOL);
-    vec_pos(&foo[1], v_bar);
+    LOG_STATS("vec_rot_n", 0, 0, 0);
+    mat_t R;
+    quat_rot_mat(q, R);
+    for (size_t i = 0; i < n; i++)
+        mat_mulv((void*) R, u_bar[i], v_bar[i]);
 }
 
-void vec_irot(const quat_t q, const vec_t u_bar, vec_t v_bar)
+void vec_irot_n(const quat_t q, size_t n, const vec_t u_bar[], vec_t v_bar[])
 {
-    LOG_STATS("vec_irot", 0, 0, 0);
-    assert(quat_isunit(q));
-    quat_t foo, bar;
-    quat_conj(q, foo);
-    quat_mulv(foo, u_bar, bar);
-    quat_mul(bar, q, foo);
-    assert(fabs(foo[0]) < ABSTOL);
-    vec_pos(&foo[1], v_bar);
+    LOG_STATS("vec_irot_n", 0, 0, 0);
+    mat_t R;
+    quat_irot_mat(q, R);
+    for (size_t i = 0; i < n; i++)
+        mat_mulv((void*) R, u_bar[i], v_bar[i]);
 }
 
 void quat_rot_mat(const quat_t q, mat_t R)
 {
-    LOG_STATS("quat_rot_mat", 12, 27, 0);
+    LOG_STATS("quat_rot_mat", 15, 9, 0);
     assert(quat_isunit(q));
-    for (size_t i = 0; i < 3; i++) {
-        R[i][i] = 1.0 - 2.0 * (q[1+(i+2)%3] * q[1+(i+2)%3] + q[1+(i+1)%3] * q[1+(i+1)%3]);
-        R[(i+2)%3][(i+1)%3] = 2.0 * (q[1+(i+2)%3] * q[1+(i+1)%3] + q[1+i] * q[0]);
-        R[(i+1)%3][(i+2)%3] = 2.0 * (q[1+(i+1)%3] * q[1+(i+2)%3] - q[1+i] * q[0]);
-    }
+    double x2 = q[1] + q[1], y2 = q[2] + q[2], z2 = q[3] + q[3],
+           xx = q[1] * x2, yy = q[2] * y2, zz = q[3] * z2,
+           xy = q[1] * y2, xz = q[1] * z2, yz = q[2] * z2,
+           wx = q[0] * x2, wy = q[0] * y2, wz = q[0] * z2;
+    R[0][0] = 1.0 - (yy + zz);
+    R[0][1] = xy - wz;
+    R[0][2] = xz + wy;
+    R[1][0] = xy + wz;
+    R[1][1] = 1.0 - (zz + xx);
+    R[1][2] = yz - wx;
+    R[2][0] = xz - wy;
+    R[2][1] = yz + wx;
+    R[2][2] = 1.0 - (xx + yy);
 }
 
 void quat_irot_mat(const quat_t q, mat_t R)
 {
-    LOG_STATS("quat_irot_mat", 12, 27, 0);
+    LOG_STATS("quat_irot_mat", 15, 9, 0);
     assert(quat_isunit(q));
-    for (size_t i = 0; i < 3; i++) {
-        R[i][i] = 1.0 - 2.0 * (q[1+(i+2)%3] * q[1+(i+2)%3] + q[1+(i+1)%3] * q[1+(i+1)%3]);
-        R[(i+2)%3][(i+1)%3] = 2.0 * (q[1+(i+2)%3] * q[1+(i+1)%3] - q[1+i] * q[0]);
-        R[(i+1)%3][(i+2)%3] = 2.0 * (q[1+(i+1)%3] * q[1+(i+2)%3] + q[1+i] * q[0]);
-    }
+    double x2 = q[1] + q[1], y2 = q[2] + q[2], z2 = q[3] + q[3],
+           xx = q[1] * x2, yy = q[2] * y2, zz = q[3] * z2,
+           xy = q[1] * y2, xz = q[1] * z2, yz = q[2] * z2,
+           wx = q[0] * x2, wy = q[0] * y2, wz = q[0] * z2;
+    R[0][0] = 1.0 - (yy + zz);
+    R[0][1] = xy + wz;
+    R[0][2] = xz - wy;
+    R[1][0] = xy - wz;
+    R[1][1] = 1.0 - (zz + xx);
+    R[1][2] = yz + wx;
+    R[2][0] = xz + wy;
+    R[2][1] = yz - wx;
+    R[2][2] = 1.0 - (xx + yy);
 }
-
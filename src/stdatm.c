@@ -1,6 +1,9 @@
 #include <math.h>
+#include <string.h>
 #include "stdatm.h"
 #include "gee.h"
+#include "force_model.h"
+#include "mat.h"
 #include "util.h"
 #include "log.h"
 
@@ -83,14 +86,67 @@ static void uasa20_init(struct uasa20_s* restrict pt) {
     }
 }
 
+static struct stdatm_cell_s __stdatm_lst[A_TABLE_SIZE];
+
+/* Fit table cell
+ * :param double w: cell width
+ * :param size_t i: cell index
+ *
+ * Interpolates the model at four equally spaced points of the cell
+ * (width `w`, up to `A_STEP`), so cubics (`uasa20`) are reproduced and the
+ * cells join continuously. The cubics are taken about the midpoint of a
+ * full cell, where the log values are exponentiated.
+ */
+static void stdatm_fit(double w, size_t i) {
+    struct stdatm_cell_s* cell = &__stdatm_lst[i];
+    double f[3][4], c = (i < A_LOWER_SIZE) ? A_STEP * i : 86e3 + A_STEP * (i - A_LOWER_SIZE);
+    for (size_t k = 0; k < 4; k++) {
+        struct atm_s atm;
+        double z = c + w * k / 3.0;
+        // (below 86km, the model is discontinuous there)
+        if (i < A_LOWER_SIZE)
+            z = MIN(G_RMIN * z / (G_RMIN - z), nextafter(86e3, 0.0));
+        stdatm_model(z, &atm);
+        f[0][k] = atm.th;
+        f[1][k] = log(atm.p);
+        f[2][k] = log(atm.rho);
+    }
+    double* lst[3] = {cell->th, cell->p, cell->rho};
+    for (size_t j = 0; j < 3; j++) {
+        // forward differences, then powers of x = (c - c0) / A_STEP
+        double d1 = f[j][1] - f[j][0],
+               d2 = f[j][2] - 2.0 * f[j][1] + f[j][0],
+               d3 = f[j][3] - 3.0 * f[j][2] + 3.0 * f[j][1] - f[j][0],
+               a = 3.0 * A_STEP / w,
+               a0 = f[j][0],
+               a1 = a * (d1 - d2 / 2.0 + d3 / 3.0),
+               a2 = a * a * (d2 - d3) / 2.0,
+               a3 = a * a * a * d3 / 6.0;
+        // then of y = x - 1/2
+        lst[j][0] = a0 + 0.5 * (a1 + 0.5 * (a2 + 0.5 * a3));
+        lst[j][1] = a1 + a2 + 0.75 * a3;
+        lst[j][2] = a2 + 1.5 * a3;
+        lst[j][3] = a3;
+    }
+    cell->p[0] = exp(cell->p[0]);
+    cell->rho[0] = exp(cell->rho[0]);
+}
+
 void stdatm_init() {
     uasa20_init(__uasa20_p);
     uasa20_init(__uasa20_rho);
+    for (size_t i = 0; i < A_TABLE_SIZE; i++) {
+        // the last cell below 86km ends short
+        double w = (i + 1 == A_LOWER_SIZE)
+                 ? G_RMIN * 86e3 / (G_RMIN + 86e3) - A_STEP * i
+                 : A_STEP;
+        stdatm_fit(w, i);
+    }
 }
 
-bool stdatm_eval(double z, struct atm_s* restrict atm) {
+bool stdatm_model(double z, struct atm_s* restrict atm) {
     if (z < 86e3) {
-        LOG_STATS("stdatm_eval", 15, 30, 7);
+        LOG_STATS("stdatm_model", 17, 36, 7);
         static double R = A_RSTAR / A_M0, C = A_G0 * A_M0 / A_RSTAR,
                hmax = G_RMIN * 86e3 / (G_RMIN + 86e3);
         double h = G_RMIN * z / (G_RMIN + z), delta_th;
@@ -134,28 +190,43 @@ bool stdatm_eval(double z, struct atm_s* restrict atm) {
         }
         // p = rho * (R* / M0) * th
         atm->rho = atm->p / (R * atm->th);
+        // d(ln rho) / dh = - (C + L) / th, L the lapse rate at h
+        double L = (h < 11e3) ? -6.5e-3
+                 : (h < 20e3) ? 0.0
+                 : (h < 32e3) ? +1.0e-3
+                 : (h < 47e3) ? +2.8e-3
+                 : (h < 51e3) ? 0.0
+                 : (h < 71e3) ? -2.8e-3
+                 : -2.0e-3;
+        atm->rho_z = (z > 0) ? (
+            - atm->rho * (C + L) / atm->th
+            * (G_RMIN / (G_RMIN + z)) * (G_RMIN / (G_RMIN + z))
+        ) : 0.0;
         // if z > 80e3:
         //     th *= M(z) / M0
     } else {
         if (z < 91e3) {
             atm->th = 186.8673;
         } else if (z < 110e3) {
-            LOG_STATS("stdatm_eval", 3, 2, 2);
+            LOG_STATS("stdatm_model", 3, 2, 2);
             atm->th = 263.1905 - 76.3232 * sqrt(1 - pow((z - 91e3) / -19.9429e3, 2.0));
         } else if (z < 120e3) {
-            LOG_STATS("stdatm_eval", 2, 1, 0);
+            LOG_STATS("stdatm_model", 2, 1, 0);
             atm->th = 240.0 + 12e-3 * (z - 110e3);
         } else if (z <= 1000e3) {
-            LOG_STATS("stdatm_eval", 4, 4, 1);
+            LOG_STATS("stdatm_model", 4, 4, 1);
             atm->th = 1000.0 - 640.0 * exp(-0.01875e-3 * (z - 120e3) * (G_RMIN + 120e3) / (G_RMIN + z));
         } else {
             return false;
         }
-            LOG_STATS("stdatm_eval", 0, 0, 2);
+            LOG_STATS("stdatm_model", 0, 0, 2);
         for (size_t i = 0; i < 15; i++) {
             if ((__uasa20_p[i].z <= z) && (z <= __uasa20_p[i+1].z)) {
                 atm->p = exp(poly_eval(&__uasa20_p[i].p, z));
                 atm->rho = exp(poly_eval(&__uasa20_rho[i].p, z));
+                struct poly_s P = {.deg=POLY_DEG};
+                poly_diff(&__uasa20_rho[i].p, &P);
+                atm->rho_z = atm->rho * poly_eval(&P, z);
                 break;
             }
         }
@@ -163,53 +234,245 @@ bool stdatm_eval(double z, struct atm_s* restrict atm) {
     return true;
 }
 
+/* Exponential, of the log offsets within a cell
+ * :param double x: input (|x| < ~0.1)
+ * :returns double:
+ *
+ * Taylor series, the truncation error is below 3e-15 for |x| < 0.1.
+ */
+static inline double __stdatm_exp(double x) {
+    LOG_STATS("__stdatm_exp", 8, 8, 0);
+    return 1.0 + x * (1.0 + x * (1.0 / 2.0 + x * (1.0 / 6.0 + x * (1.0 / 24.0
+         + x * (1.0 / 120.0 + x * (1.0 / 720.0 + x * (1.0 / 5040.0
+         + x * (1.0 / 40320.0))))))));
+}
+
+/* Evaluate table
+ * :param double z: geometric altitude (up to 1000km)
+ * :param atm_s* atm: output conditions
+ */
+static inline void __stdatm_eval(double z, struct atm_s* restrict atm) {
+    LOG_STATS("stdatm_eval", 12, 14, 0);
+    double x, x_z;  // cell coordinate, and its gradient
+    if (z < 86e3) {
+        double foo = G_RMIN / (G_RMIN + z);
+        x = foo * z / A_STEP;
+        x_z = foo * foo / A_STEP;
+    } else {
+        x = A_LOWER_SIZE + (z - 86e3) / A_STEP;
+        x_z = 1.0 / A_STEP;
+    }
+    size_t i = MIN((size_t) x, A_TABLE_SIZE - 1);
+    const struct stdatm_cell_s* cell = &__stdatm_lst[i];
+    double y = x - i - 0.5;
+    atm->th = cell->th[0] + y * (cell->th[1] + y * (cell->th[2] + y * cell->th[3]));
+    atm->p = cell->p[0] * __stdatm_exp(y * (cell->p[1] + y * (cell->p[2] + y * cell->p[3])));
+    atm->rho = cell->rho[0] * __stdatm_exp(y * (cell->rho[1] + y * (cell->rho[2] + y * cell->rho[3])));
+    atm->rho_z = atm->rho * x_z * (
+        cell->rho[1] + y * (2.0 * cell->rho[2] + y * (3.0 * cell->rho[3]))
+    );
+}
+
+bool stdatm_eval(double z, struct atm_s* restrict atm) {
+    LOG_STATS("stdatm_eval", 0, 0, 0);
+    if (z <= 0.0)
+        return stdatm_model(z, atm);
+    if (z > 1000e3)
+        return false;
+    __stdatm_eval(z, atm);
+    return true;
+}
+
+/* Evaluate table or model, zeroed outside of the model range */
+static inline bool __stdatm_eval_1(double z, struct atm_s* restrict atm) {
+    if (0.0 < z && z <= 1000e3) {
+        __stdatm_eval(z, atm);
+    } else if (!stdatm_model(z, atm)) {
+        memset(atm, 0, sizeof(struct atm_s));
+        return false;
+    }
+    return true;
+}
+
+bool stdatm_eval_n(size_t n, const double z[], struct atm_s atm[]) {
+    LOG_STATS("stdatm_eval_n", 0, 0, 0);
+    bool done = true;
+    size_t i = 0;
+#if defined SIMD_SSE2
+    // pairs of altitudes within the table, cells gathered per lane
+    const __m128d one = _mm_set1_pd(1.0);
+    for (; i + 1 < n; i += 2) {
+        LOG_STATS("stdatm_eval_n", 26, 36, 1);
+        __m128d z_ = _mm_loadu_pd(&z[i]);
+        if (_mm_movemask_pd(_mm_and_pd(
+                _mm_cmpgt_pd(z_, _mm_setzero_pd()), _mm_cmple_pd(z_, _mm_set1_pd(1000e3))
+            )) != 3) {
+            for (size_t k = i; k < i + 2; k++)
+                done &= __stdatm_eval_1(z[k], &atm[k]);
+            continue;
+        }
+        __m128d lower = _mm_cmplt_pd(z_, _mm_set1_pd(86e3)),
+                foo = _mm_div_pd(_mm_set1_pd(G_RMIN), _mm_add_pd(_mm_set1_pd(G_RMIN), z_)),
+                step = _mm_set1_pd(A_STEP),
+                x = _mm_or_pd(
+                    _mm_and_pd(lower, _mm_div_pd(_mm_mul_pd(foo, z_), step)),
+                    _mm_andnot_pd(lower, _mm_add_pd(
+                        _mm_set1_pd(A_LOWER_SIZE), _mm_div_pd(_mm_sub_pd(z_, _mm_set1_pd(86e3)), step)
+                    ))
+                ),
+                x_z = _mm_div_pd(
+                    _mm_or_pd(_mm_and_pd(lower, _mm_mul_pd(foo, foo)), _mm_andnot_pd(lower, one)),
+                    step
+                );
+        double x_lst[2];
+        _mm_storeu_pd(x_lst, x);
+        size_t j0 = MIN((size_t) x_lst[0], A_TABLE_SIZE - 1),
+               j1 = MIN((size_t) x_lst[1], A_TABLE_SIZE - 1);
+        const struct stdatm_cell_s *c0 = &__stdatm_lst[j0], *c1 = &__stdatm_lst[j1];
+        __m128d y = _mm_sub_pd(x, _mm_set_pd(j1 + 0.5, j0 + 0.5)),
+                th = _mm_set_pd(c1->th[3], c0->th[3]),
+                p = _mm_set_pd(c1->p[3], c0->p[3]),
+                rho = _mm_set_pd(c1->rho[3], c0->rho[3]),
+                rho_z = _mm_mul_pd(_mm_set1_pd(3.0), rho);
+        for (size_t k = 3; k-- > 1;) {
+            th = _mm_add_pd(_mm_set_pd(c1->th[k], c0->th[k]), _mm_mul_pd(y, th));
+            p = _mm_add_pd(_mm_set_pd(c1->p[k], c0->p[k]), _mm_mul_pd(y, p));
+            rho = _mm_add_pd(_mm_set_pd(c1->rho[k], c0->rho[k]), _mm_mul_pd(y, rho));
+        }
+        rho_z = _mm_add_pd(
+            _mm_set_pd(c1->rho[1], c0->rho[1]),
+            _mm_mul_pd(y, _mm_add_pd(_mm_set_pd(2.0 * c1->rho[2], 2.0 * c0->rho[2]), _mm_mul_pd(y, rho_z)))
+        );
+        th = _mm_add_pd(_mm_set_pd(c1->th[0], c0->th[0]), _mm_mul_pd(y, th));
+        p = _mm_mul_pd(y, p);
+        rho = _mm_mul_pd(y, rho);
+        // `__stdatm_exp` on both log offsets
+        __m128d exp_p = _mm_set1_pd(1.0 / 40320.0), exp_rho = exp_p;
+        static const double inv_fact[8] = {
+            1.0, 1.0, 1.0 / 2.0, 1.0 / 6.0, 1.0 / 24.0, 1.0 / 120.0, 1.0 / 720.0, 1.0 / 5040.0
+        };
+        for (size_t k = 8; k-- > 0;) {
+            exp_p = _mm_add_pd(_mm_set1_pd(inv_fact[k]), _mm_mul_pd(p, exp_p));
+            exp_rho = _mm_add_pd(_mm_set1_pd(inv_fact[k]), _mm_mul_pd(rho, exp_rho));
+        }
+        p = _mm_mul_pd(_mm_set_pd(c1->p[0], c0->p[0]), exp_p);
+        rho = _mm_mul_pd(_mm_set_pd(c1->rho[0], c0->rho[0]), exp_rho);
+        rho_z = _mm_mul_pd(_mm_mul_pd(rho, x_z), rho_z);
+        _mm_storel_pd(&atm[i].th, th);
+        _mm_storeh_pd(&atm[i+1].th, th);
+        _mm_storel_pd(&atm[i].p, p);
+        _mm_storeh_pd(&atm[i+1].p, p);
+        _mm_storel_pd(&atm[i].rho, rho);
+        _mm_storeh_pd(&atm[i+1].rho, rho);
+        _mm_storel_pd(&atm[i].rho_z, rho_z);
+        _mm_storeh_pd(&atm[i+1].rho_z, rho_z);
+    }
+#endif
+    for (; i < n; i++)
+        done &= __stdatm_eval_1(z[i], &atm[i]);
+    return done;
+}
+
 bool stdatm(
     size_t size,
     const struct cfg_s* cfg,
     const struct st_s* st,
     struct in_s* restrict in,
-    const struct out_s* out __attribute__((unused)),
+    const struct out_s* out,
     struct em_s* restrict em __attribute__((unused))
 ) {
-    LOG_STATS("stdatm", 0, 0, 0);
-    double v = vec_norm(st->sys.v_bar), z, A, F;
+    LOG_STATS("stdatm", 15, 20, 0);
+    double v = vec_norm(st->sys.v_bar);
     vec_t v_bar, foo, bar;
+    mat_t temp[2];
     struct atm_s atm;
-    gee_f2d(st->sys.r_bar, NULL, NULL, &z);
-    if (!stdatm_eval(z, &atm))
+    if (!stdatm_eval(gee_env(st, out, in, ENV_ALT)->alt, &atm))
         return true;
     vec_irot(st->sys.q, st->sys.v_bar, v_bar);
-    vec_zero(foo);
-    for (size_t idx = 0; idx < size; idx++) {
-        LOG_STATS("stdatm", 3, 12, 0);
-        vec_t temp;
-        // x-axis
-        vec_rot(cfg->obj_lst[idx].q, i_hat, temp);
-        A = cfg->obj_lst[idx].bbox[1] * cfg->obj_lst[idx].bbox[2];
-        F = atm.rho * v * vec_dot(v_bar, temp) * A;
-        vec_muls(temp, - F, temp);
-        vec_add(foo, temp, foo);
-        vec_cross(cfg->obj_lst[idx].r_bar, temp, bar);
-        vec_add(in->sys.M_bar, bar, in->sys.M_bar);
-        // y-axis
-        vec_rot(cfg->obj_lst[idx].q, j_hat, temp);
-        A = cfg->obj_lst[idx].bbox[2] * cfg->obj_lst[idx].bbox[0];
-        F = atm.rho * v * vec_dot(v_bar, temp) * A;
-        vec_muls(temp, - F, temp);
-        vec_add(foo, temp, foo);
-        vec_cross(cfg->obj_lst[idx].r_bar, temp, bar);
-        vec_add(in->sys.M_bar, bar, in->sys.M_bar);
-        // z-axis
-        vec_rot(cfg->obj_lst[idx].q, k_hat, temp);
-        A = cfg->obj_lst[idx].bbox[0] * cfg->obj_lst[idx].bbox[1];
-        F = atm.rho * v * vec_dot(v_bar, temp) * A;
-        vec_muls(temp, - F, temp);
-        vec_add(foo, temp, foo);
-        vec_cross(cfg->obj_lst[idx].r_bar, temp, bar);
-        vec_add(in->sys.M_bar, bar, in->sys.M_bar);
+    // drag sums of `solve_cfg`, unless the configuration changed since
+    const double (*K)[3] = cfg->drv.K, (*L)[3] = cfg->drv.L;
+    if (!match_cfg(size, cfg)) {
+        solve_drag(size, cfg, temp[0], temp[1]);
+        K = (void*) temp[0];
+        L = (void*) temp[1];
     }
+    mat_mulv(K, v_bar, foo);
+    vec_muls(foo, - atm.rho * v, foo);
+    mat_mulv(L, v_bar, bar);
+    vec_muls(bar, - atm.rho * v, bar);
+    vec_add(in->sys.M_bar, bar, in->sys.M_bar);
     vec_rot(st->sys.q, foo, bar);
     vec_add(in->sys.F_bar, bar, in->sys.F_bar);
     return true;
 }
 
+bool stdatm_jac(
+    size_t size,
+    const struct cfg_s* cfg,
+    const struct st_s* st,
+    struct jac_s* restrict jac,
+    const struct out_s* out,
+    const struct em_s* em __attribute__((unused))
+) {
+    LOG_STATS("stdatm_jac", 0, 0, 0);
+    double v = vec_norm(st->sys.v_bar), z;
+    vec_t v_bar, r_bar, F_bar, foo, bar;
+    mat_t D, E, R, T, C, B;
+    struct atm_s atm;
+    // altitude at the center of mass, as `stdatm`
+    vec_rot(st->sys.q, out->sys.c_bar, r_bar);
+    vec_add(st->sys.r_bar, r_bar, r_bar);
+    gee_f2d(r_bar, NULL, NULL, &z);
+    if (!stdatm_eval(z, &atm) || v < ABSTOL || !vec_unit(st->sys.r_bar, r_bar))
+        return true;
+    vec_irot(st->sys.q, st->sys.v_bar, v_bar);
+    // body force and torque, and their partials in v_bar (body)
+    const double (*K)[3] = cfg->drv.K, (*L)[3] = cfg->drv.L;
+    if (!match_cfg(size, cfg)) {
+        solve_drag(size, cfg, C, R);
+        K = (void*) C;
+        L = (void*) R;
+    }
+    mat_mulv(K, v_bar, foo);
+    mat_mulv(L, v_bar, bar);
+    // - rho (v K + K v_bar v_bar^T / v), and as much for L
+    vec_omul(foo, v_bar, T);
+    mat_muls((void*) T, 1.0 / v, T);
+    mat_muls(K, v, D);
+    mat_add((void*) D, (void*) T, D);
+    mat_muls((void*) D, - atm.rho, D);
+    vec_omul(bar, v_bar, T);
+    mat_muls((void*) T, 1.0 / v, T);
+    mat_muls(L, v, E);
+    mat_add((void*) E, (void*) T, E);
+    mat_muls((void*) E, - atm.rho, E);
+    vec_muls(foo, - atm.rho * v, foo);
+    vec_muls(bar, - atm.rho * v, bar);
+    // d rho / d r_bar = rho_z r_hat
+    quat_rot_mat(st->sys.q, R);
+    vec_rot(st->sys.q, foo, F_bar);
+    vec_omul(F_bar, r_bar, T);
+    mat_muls((void*) T, atm.rho_z / atm.rho, T);
+    jac_add(jac->F_bar, 0, (void*) T);
+    vec_omul(bar, r_bar, T);
+    mat_muls((void*) T, atm.rho_z / atm.rho, T);
+    jac_add(jac->M_bar, 0, (void*) T);
+    // F_bar = R foo(R^T v_bar), d(R^T u) / d th = 2 [R^T u]x
+    mat_mul((void*) R, (void*) D, B);
+    mat__T((void*) R, C);
+    mat_mul((void*) B, (void*) C, T);
+    jac_add(jac->F_bar, 6, (void*) T);
+    mat_mul((void*) E, (void*) C, T);
+    jac_add(jac->M_bar, 6, (void*) T);
+    vec_cross_mat(v_bar, C);
+    mat_muls((void*) C, 2.0, C);
+    mat_mul((void*) B, (void*) C, T);
+    vec_cross_mat(foo, D);
+    mat_mul((void*) R, (void*) D, B);
+    mat_muls((void*) B, -2.0, B);
+    mat_add((void*) T, (void*) B, T);
+    jac_add(jac->F_bar, 3, (void*) T);
+    mat_mul((void*) E, (void*) C, T);
+    jac_add(jac->M_bar, 3, (void*) T);
+    return true;
+}
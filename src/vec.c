@@ -32,41 +32,8 @@ bool vec_unit(const vec_t v_bar, vec_t v_hat)
     return true;
 }
 
-void vec_add(const vec_t u_bar, const vec_t v_bar, vec_t w_bar)
-{
-    LOG_STATS("vec_add", 3, 0, 0);
-    for (size_t i = 0; i < 3; i++)
-        w_bar[i] = u_bar[i] + v_bar[i];
-}
-
-void vec_sub(const vec_t u_bar, const vec_t v_bar, vec_t w_bar)
-{
-    LOG_STATS("vec_sub", 3, 0, 0);
-    for (size_t i = 0; i < 3; i++)
-        w_bar[i] = u_bar[i] - v_bar[i];
-}
-
-void vec_muls(const vec_t u_bar, double s, vec_t v_bar)
-{
-    LOG_STATS("vec_muls", 0, 3, 0);
-    for (size_t i = 0; i < 3; i++)
-        v_bar[i] = u_bar[i] * s;
-}
-
-double vec_dot(const vec_t u_bar, const vec_t v_bar)
-{
-    LOG_STATS("vec_dot", 3, 3, 0);
-    double s = 0.0;
-    for (size_t i = 0; i < 3; i++)
-        s += u_bar[i] * v_bar[i];
-    return s;
-}
-
-void vec_cross(const vec_t u_bar, const vec_t v_bar, vec_t w_bar)
-{
-    LOG_STATS("vec_cross", 3, 6, 0);
-    for (size_t i = 0; i < 3; i++)
-        w_bar[i] = u_bar[(i+1)%3] * v_bar[(i+2)%3]
-                 - u_bar[(i+2)%3] * v_bar[(i+1)%3];
-}
-
+extern inline void vec_add(const vec_t, const vec_t, vec_t);
+extern inline void vec_sub(const vec_t, const vec_t, vec_t);
+extern inline void vec_muls(const vec_t, double, vec_t);
+extern inline double vec_dot(const vec_t, const vec_t);
+extern inline void vec_cross(const vec_t, const vec_t, vec_t);
@@ -0,0 +1,396 @@
+# built-in libraries
+import ctypes
+import math
+
+# external libraries
+import numpy
+import numpy.ctypeslib
+import pytest
+
+# internal libraries
+from epicycle import libcore, libgee
+from epicycle import vec, quat
+from epicycle.gee import G_MU
+from epicycle.vehicle_model import vehicle_model_t, ch_t
+from epicycle.force_model import force_model_t
+from epicycle.batch import batch_t, batch_init, solve_batch
+from epicycle.ode import ODE_MULTI_SIZE
+
+
+def vehicle_model_lst(N):
+    vehicle_model = (vehicle_model_t * N)()
+    for idx in range(N):
+        vehicle_model[idx].size = 1
+        vehicle_model[idx].cfg.clk.delta_t = 1.0
+        vehicle_model[idx].cfg.obj_lst[0].q = numpy.ctypeslib.as_ctypes(
+            quat.one()
+        )
+        vehicle_model[idx].st.obj_lst[0].m = 1.0
+        vehicle_model[idx].st.obj_lst[0].I_cm = numpy.ctypeslib.as_ctypes(
+            numpy.array([1.0 / 12.0, 1.0 / 12.0, 1.0 / 12.0])
+        )
+        vehicle_model[idx].st.sys.r_bar = numpy.ctypeslib.as_ctypes(
+            numpy.array([7000.0e3, 0.0, 0.0])
+        )
+        vehicle_model[idx].st.sys.q = numpy.ctypeslib.as_ctypes(quat.one())
+        vehicle_model[idx].st.sys.v_bar = numpy.ctypeslib.as_ctypes(
+            numpy.array([0.0, 7.0e3, 0.0])
+        )
+        vehicle_model[idx].in_.obj_lst[0].M_bar = numpy.ctypeslib.as_ctypes(
+            numpy.array([1.0, 1.0, 1.0]) * math.pi / 18.0 / math.sqrt(3.0)
+        )
+    return vehicle_model
+
+
+def test_solve_batch():
+    N = 4
+    vehicle_model = vehicle_model_lst(N)
+    batch = (batch_t * N)()
+    force_model = force_model_t(
+        1,
+        ctypes.cast(libcore.apply_force_model, ctypes.c_void_p),
+        fun_lst=(ctypes.cast(libgee.gee_fast, ctypes.c_void_p),)
+    )
+    batch_init(vehicle_model, batch)
+    solve_batch(1.0, vehicle_model, batch, None, force_model)
+    for idx in range(N):
+        st = vehicle_model[idx].st
+        r_bar = numpy.ctypeslib.as_array(st.sys.r_bar)
+        q = numpy.ctypeslib.as_array(st.sys.q)
+        v_bar = numpy.ctypeslib.as_array(st.sys.v_bar)
+        om_bar = numpy.ctypeslib.as_array(st.sys.om_bar)
+        assert st.clk.t == 1.0
+        assert math.isclose(r_bar[0], 7000.0e3 - 0.5 * G_MU / 7000.0e3 ** 2, rel_tol=1.22e-4)
+        assert math.isclose(r_bar[1], 7.0e3, rel_tol=1.22e-4)
+        assert math.isclose(q[0], 0.5 * math.sqrt(3.0), rel_tol=1.22e-4)
+        assert math.isclose(q[1], 0.5 / math.sqrt(3.0), rel_tol=1.22e-4)
+        assert math.isclose(v_bar[0], - G_MU / 7000.0e3 ** 2, rel_tol=1.22e-4)
+        assert math.isclose(v_bar[1], 7.0e3, rel_tol=1.22e-4)
+        assert math.isclose(om_bar[0], math.pi / 1.5 / math.sqrt(3.0))
+        assert bytes(st) == bytes(vehicle_model[0].st)
+
+
+def test_solve_batch_fused():
+    N = 1
+    libgee.select_force_model.restype = ctypes.c_void_p
+    fun_lst = (
+        ctypes.cast(libgee.gee_fast, ctypes.c_void_p),
+        None,
+        ctypes.cast(libgee.stdatm, ctypes.c_void_p),
+    )
+    force_model = force_model_t(3, fun_lst=fun_lst)
+    accum_fun = libgee.select_force_model(ctypes.byref(force_model))
+    assert accum_fun == ctypes.cast(
+        libgee._force_model_gee_fast_stdatm, ctypes.c_void_p
+    ).value
+    force_model.size = 1
+    assert libgee.select_force_model(ctypes.byref(force_model)) == ctypes.cast(
+        libgee._force_model_gee_fast, ctypes.c_void_p
+    ).value
+    force_model.fun_lst[0] = None
+    assert libgee.select_force_model(ctypes.byref(force_model)) == ctypes.cast(
+        libcore.apply_force_model, ctypes.c_void_p
+    ).value
+    # fused and generic accumulators agree
+    st_lst = []
+    for accum_fun in (libcore.apply_force_model, libgee._force_model_gee_fast_stdatm):
+        vehicle_model = vehicle_model_lst(N)
+        batch = (batch_t * N)()
+        force_model = force_model_t(
+            3, ctypes.cast(accum_fun, ctypes.c_void_p), fun_lst=fun_lst
+        )
+        batch_init(vehicle_model, batch)
+        solve_batch(1.0, vehicle_model, batch, None, force_model)
+        st_lst.append(bytes(vehicle_model[0].st))
+    assert st_lst[0] == st_lst[1]
+
+
+def test_solve_batch_fsal():
+    N = 1
+    vehicle_model = vehicle_model_lst(N)
+    batch = (batch_t * N)()
+    force_model = force_model_t(
+        1,
+        ctypes.cast(libcore.apply_force_model, ctypes.c_void_p),
+        ctypes.cast(libcore.adjust_time_step, ctypes.c_void_p),
+        fun_lst=(ctypes.cast(libgee.gee_fast, ctypes.c_void_p),)
+    )
+    dopri = ctypes.cast(libcore._ode_dopri, ctypes.c_void_p)
+    batch_init(vehicle_model, batch)
+    assert not batch[0].fsal.valid
+    solve_batch(10.0, vehicle_model, batch, dopri, force_model)
+    # last stage of the accepted step is kept for the next one
+    assert batch[0].fsal.valid
+    assert batch[0].fsal.x == batch[0].next.contents.clk.t
+    assert batch[0].next.contents.clk.n > 1
+    # one evaluation for the first k[0], six per attempt afterwards
+    stats = batch[0].stats
+    assert stats.n_accept == batch[0].next.contents.clk.n
+    assert stats.n_fun == 1 + 6 * (stats.n_accept + stats.n_reject)
+    st = vehicle_model[0].st
+    r_bar = numpy.ctypeslib.as_array(st.sys.r_bar)
+    v_bar = numpy.ctypeslib.as_array(st.sys.v_bar)
+    g = G_MU / 7000.0e3 ** 2
+    assert math.isclose(r_bar[0], 7000.0e3 - 50.0 * g, rel_tol=1e-6)
+    assert math.isclose(r_bar[1], 70.0e3, rel_tol=1e-4)
+    assert math.isclose(v_bar[0], - 10.0 * g, rel_tol=1e-3)
+
+
+def test_solve_batch_abm():
+    force_model = force_model_t(
+        1,
+        ctypes.cast(libcore.apply_force_model, ctypes.c_void_p),
+        fun_lst=(ctypes.cast(libgee.gee_fast, ctypes.c_void_p),)
+    )
+    meth_lst = (
+        ctypes.cast(libcore._ode_abm, ctypes.c_void_p),
+        ctypes.cast(libcore._ode_rk4, ctypes.c_void_p),
+    )
+    vehicle_model_lst_lst = [vehicle_model_lst(1) for meth in meth_lst]
+    batch_lst = [(batch_t * 1)() for meth in meth_lst]
+    def solve(t):
+        for vehicle_model, batch, meth in zip(vehicle_model_lst_lst, batch_lst, meth_lst):
+            solve_batch(t, vehicle_model, batch, meth, force_model)
+    for vehicle_model, batch in zip(vehicle_model_lst_lst, batch_lst):
+        # keep the rotation per step well below `pi` (see `quat_log`)
+        vehicle_model[0].in_.obj_lst[0].M_bar = numpy.ctypeslib.as_ctypes(
+            numpy.array([1.0, 1.0, 1.0]) * 1e-2 * math.pi / 18.0 / math.sqrt(3.0)
+        )
+        batch_init(vehicle_model, batch)
+    solve(20.0)
+    # `rk4` start up (four evaluations per step), then two per step
+    multi, stats = batch_lst[0][0].multi, batch_lst[0][0].stats
+    assert multi.size == ODE_MULTI_SIZE
+    assert stats.n_fun == 4 * (ODE_MULTI_SIZE - 1) + 2 * (20 - ODE_MULTI_SIZE + 1)
+    # a discontinuous change restarts the history
+    for vehicle_model in vehicle_model_lst_lst:
+        vehicle_model[0].ch.obj_lst[0].T = ch_t.obj_t._T.E_IN.value
+    solve(20.0)
+    assert multi.size == 0
+    n_fun = stats.n_fun
+    solve(30.0)
+    assert multi.size == ODE_MULTI_SIZE
+    assert stats.n_fun - n_fun == 4 * (ODE_MULTI_SIZE - 1) + 2 * (10 - ODE_MULTI_SIZE + 1)
+    st_lst = [vehicle_model[0].st for vehicle_model in vehicle_model_lst_lst]
+    assert numpy.allclose(
+        numpy.ctypeslib.as_array(st_lst[0].sys.r_bar),
+        numpy.ctypeslib.as_array(st_lst[1].sys.r_bar),
+        rtol=0.0, atol=1e-6,
+    )
+    assert numpy.allclose(
+        numpy.ctypeslib.as_array(st_lst[0].sys.q),
+        numpy.ctypeslib.as_array(st_lst[1].sys.q),
+        rtol=0.0, atol=1e-9,
+    )
+
+
+def test_solve_batch_attitude():
+    # torque-free asymmetric body, against a short-step reference
+    def solve(meth, delta_t):
+        vehicle_model = vehicle_model_lst(1)
+        vehicle_model[0].cfg.clk.delta_t = delta_t
+        vehicle_model[0].st.obj_lst[0].I_cm = numpy.ctypeslib.as_ctypes(
+            numpy.array([0.1, 0.2, 0.3])
+        )
+        vehicle_model[0].st.sys.om_bar = numpy.ctypeslib.as_ctypes(
+            numpy.array([0.3, 0.05, 0.2])
+        )
+        vehicle_model[0].in_.obj_lst[0].M_bar = numpy.ctypeslib.as_ctypes(
+            numpy.zeros((3))
+        )
+        batch = (batch_t * 1)()
+        force_model = force_model_t(
+            1,
+            ctypes.cast(libcore.apply_force_model, ctypes.c_void_p),
+            fun_lst=(ctypes.cast(libgee.gee_fast, ctypes.c_void_p),)
+        )
+        batch_init(vehicle_model, batch)
+        solve_batch(
+            20.0, vehicle_model, batch,
+            ctypes.cast(getattr(libcore, meth), ctypes.c_void_p), force_model
+        )
+        return numpy.ctypeslib.as_array(vehicle_model[0].st.sys.q).copy()
+    q_ref = solve("_ode_rk4", 0.01)
+    err_lst = [
+        numpy.linalg.norm(solve("_ode_rk4", delta_t) - q_ref)
+        for delta_t in (1.0, 0.5)
+    ]
+    # fourth order, as the translational part
+    assert err_lst[0] < 1e-4
+    assert err_lst[0] / err_lst[1] > 12.0
+
+
+@pytest.mark.parametrize("meth", ["_ode_midp", "_ode_vgl4", "_ode_vgl6"])
+def test_solve_batch_newton(meth):
+    # simplified Newton vs. fixed-point stage iteration
+    def solve(jac_fun):
+        vehicle_model = vehicle_model_lst(1)
+        vehicle_model[0].cfg.clk.delta_t = 2.0
+        vehicle_model[0].st.obj_lst[0].I_cm = numpy.ctypeslib.as_ctypes(
+            numpy.array([0.1, 0.2, 0.3])
+        )
+        vehicle_model[0].st.sys.om_bar = numpy.ctypeslib.as_ctypes(
+            numpy.array([0.3, 0.05, 0.2])
+        )
+        vehicle_model[0].in_.obj_lst[0].M_bar = numpy.ctypeslib.as_ctypes(
+            numpy.zeros((3))
+        )
+        batch = (batch_t * 1)()
+        force_model = force_model_t(
+            1,
+            ctypes.cast(libcore.apply_force_model, ctypes.c_void_p),
+            jac_fun=jac_fun,
+            fun_lst=(ctypes.cast(libgee.gee_fast, ctypes.c_void_p),)
+        )
+        batch_init(vehicle_model, batch)
+        solve_batch(
+            60.0, vehicle_model, batch,
+            ctypes.cast(getattr(libcore, meth), ctypes.c_void_p), force_model
+        )
+        st = vehicle_model[0].st.sys
+        return (
+            numpy.ctypeslib.as_array(st.r_bar).copy(),
+            numpy.ctypeslib.as_array(st.q).copy(),
+            batch[0].stats
+        )
+    r0, q0, stats0 = solve(None)
+    r1, q1, stats1 = solve(
+        ctypes.cast(libcore.jacobian_force_model, ctypes.c_void_p)
+    )
+    assert numpy.linalg.norm(r1 - r0) < 1e-3
+    assert numpy.linalg.norm(q1 - q0) < 1e-4
+    assert stats0.n_jac == 0
+    assert stats1.n_jac == stats1.n_accept
+    assert stats1.n_iter <= 4 * stats1.n_accept
+    assert stats1.n_iter < stats0.n_iter
+
+
+@pytest.mark.parametrize("meth", ["_ode_vgl4", "_ode_vgl6"])
+def test_solve_batch_warm(meth):
+    # stages extrapolated from the last step vs. cold starts
+    def solve(warm):
+        vehicle_model = vehicle_model_lst(1)
+        vehicle_model[0].cfg.clk.delta_t = 1.0
+        vehicle_model[0].st.obj_lst[0].I_cm = numpy.ctypeslib.as_ctypes(
+            numpy.array([0.1, 0.2, 0.3])
+        )
+        vehicle_model[0].st.sys.om_bar = numpy.ctypeslib.as_ctypes(
+            numpy.array([0.3, 0.05, 0.2])
+        )
+        vehicle_model[0].in_.obj_lst[0].M_bar = numpy.ctypeslib.as_ctypes(
+            numpy.zeros((3))
+        )
+        batch = (batch_t * 1)()
+        force_model = force_model_t(
+            1,
+            ctypes.cast(libcore.apply_force_model, ctypes.c_void_p),
+            fun_lst=(ctypes.cast(libgee.gee_fast, ctypes.c_void_p),)
+        )
+        batch_init(vehicle_model, batch)
+        for t in range(1, 61):
+            batch[0].stage.valid &= warm
+            solve_batch(
+                float(t), vehicle_model, batch,
+                ctypes.cast(getattr(libcore, meth), ctypes.c_void_p),
+                force_model
+            )
+        st = vehicle_model[0].st.sys
+        return (
+            numpy.ctypeslib.as_array(st.r_bar).copy(),
+            numpy.ctypeslib.as_array(st.q).copy(),
+            batch[0].stats
+        )
+    r0, q0, stats0 = solve(False)
+    r1, q1, stats1 = solve(True)
+    assert numpy.linalg.norm(r1 - r0) < 1e-6
+    assert numpy.linalg.norm(q1 - q0) < 1e-4
+    assert stats1.n_fun < 0.85 * stats0.n_fun
+
+
+@pytest.mark.parametrize("meth,tol,newton", [
+    ("_ode_rk4", 1e-4, False), ("_ode_dopri", 1e-4, False),
+    ("_ode_dop853", 1e-4, False), ("_ode_midp", 1e-2, False),
+    ("_ode_vgl4", 1e-3, False), ("_ode_vgl6", 1e-4, False),
+    ("_ode_vgl6", 1e-4, True),
+])
+def test_solve_batch_stm(meth, tol, newton):
+    # variational equations vs. central differences of whole propagations,
+    # fixed steps (the embedded methods accept every step); the implicit
+    # stages converge to `RELTOL`, hence the absolute tolerance (`newton`
+    # solves the stages, and those of `Phi`, by factorization)
+    accept = ctypes.CFUNCTYPE(
+        ctypes.c_bool,
+        ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p,
+        ctypes.c_int, ctypes.c_void_p
+    )(lambda *args: True)
+
+    def solve(j, h, stm):
+        vehicle_model = vehicle_model_lst(1)
+        vehicle_model[0].cfg.clk.delta_t = 0.5
+        vehicle_model[0].st.obj_lst[0].I_cm = numpy.ctypeslib.as_ctypes(
+            numpy.array([0.1, 0.2, 0.3])
+        )
+        vehicle_model[0].st.sys.om_bar = numpy.ctypeslib.as_ctypes(
+            numpy.array([0.3, 0.05, 0.2])
+        )
+        vehicle_model[0].in_.obj_lst[0].M_bar = numpy.ctypeslib.as_ctypes(
+            numpy.zeros((3))
+        )
+        # tangent space step (r_bar, th, v_bar, om_bar)
+        y = vehicle_model[0].st.sys
+        delta = numpy.zeros((3,))
+        delta[j % 3] = h
+        if j < 3:
+            y.r_bar = numpy.ctypeslib.as_ctypes(numpy.array(y.r_bar) + delta)
+        elif j < 6:
+            y.q = numpy.ctypeslib.as_ctypes(quat.mul(numpy.array(y.q), vec.exp(delta)))
+        elif j < 9:
+            y.v_bar = numpy.ctypeslib.as_ctypes(numpy.array(y.v_bar) + delta)
+        else:
+            y.om_bar = numpy.ctypeslib.as_ctypes(numpy.array(y.om_bar) + delta)
+        vehicle_model[0].stm.valid = stm
+        vehicle_model[0].stm.Phi = numpy.ctypeslib.as_ctypes(numpy.eye(12))
+        batch = (batch_t * 1)()
+        force_model = force_model_t(
+            1,
+            ctypes.cast(libcore.apply_force_model, ctypes.c_void_p),
+            ctypes.cast(accept, ctypes.c_void_p)
+            if meth in ("_ode_dopri", "_ode_dop853") else None,
+            ctypes.cast(libcore.jacobian_force_model, ctypes.c_void_p)
+            if newton else None,
+            fun_lst=(ctypes.cast(libgee.gee_fast, ctypes.c_void_p),),
+            jac_lst=(ctypes.cast(libgee.gee_fast_jac, ctypes.c_void_p),)
+        )
+        batch_init(vehicle_model, batch)
+        solve_batch(
+            10.0, vehicle_model, batch,
+            ctypes.cast(getattr(libcore, meth), ctypes.c_void_p), force_model
+        )
+        return vehicle_model[0], batch[0]
+    vehicle_model, batch = solve(0, 0.0, True)
+    st = vehicle_model.st.sys
+    assert vehicle_model.stm.valid
+    assert vehicle_model.stm.t == 10.0
+    assert batch.stats.n_jac > 0
+    Phi = numpy.ctypeslib.as_array(vehicle_model.stm.Phi)
+    q_inv = quat.conj(numpy.array(st.q))
+
+    def tangent(st_):
+        return numpy.concatenate((
+            numpy.array(st_.r_bar) - numpy.array(st.r_bar),
+            quat.log(quat.mul(q_inv, numpy.array(st_.q))),
+            numpy.array(st_.v_bar) - numpy.array(st.v_bar),
+            numpy.array(st_.om_bar) - numpy.array(st.om_bar),
+        ))
+
+    for j in range(12):
+        h = (1.0, 1e-5, 1e-3, 1e-5)[j // 3]
+        D = (
+            tangent(solve(j, h, False)[0].st.sys)
+            - tangent(solve(j, -h, False)[0].st.sys)
+        ) / (2.0 * h)
+        for i in range(0, 12, 3):
+            # block-wise, the columns mix units
+            assert numpy.linalg.norm(Phi[i:i+3, j] - D[i:i+3]) <= (
+                tol * numpy.linalg.norm(D[i:i+3]) + 1e-4
+            )
@@ -1,12 +1,17 @@
 # built-in libraries
+import ctypes
 import math
 
 # external libraries
 import numpy.ctypeslib
+import pytest
 
 # internal libraries
+from epicycle import libcore, libgee
 from epicycle import vec
 from epicycle import quat
+from epicycle import ode
+from epicycle import stdatm
 from epicycle.vehicle_model import *
 from epicycle.force_model import *
 
@@ -364,6 +369,7 @@ def test_solve_in():
             ),
         )
     )
+    in_ref = in_t.from_buffer_copy(in_)
     solve_in(1, cfg, st, in_, out)
     F_bar = numpy.ctypeslib.as_array(in_.sys.F_bar)
     M_bar = numpy.ctypeslib.as_array(in_.sys.M_bar)
@@ -381,6 +387,16 @@ def test_solve_in():
     assert om_dot[0] == 0.0
     assert om_dot[1] == 0.0
     assert om_dot[2] == 6.0
+    # a factor not flagged as current is ignored
+    out.sys.L_cm = numpy.ctypeslib.as_ctypes(numpy.eye(3))
+    in_ = in_t.from_buffer_copy(in_ref)
+    solve_in(1, cfg, st, in_, out)
+    assert numpy.ctypeslib.as_array(in_.sys.om_dot)[2] == 6.0
+    # not positive-definite, solved with the inverse
+    out.sys.I_cm[2][2] = - 1.0 / 12.0
+    in_ = in_t.from_buffer_copy(in_ref)
+    solve_in(1, cfg, st, in_, out)
+    assert math.isclose(numpy.ctypeslib.as_array(in_.sys.om_dot)[2], -6.0)
 
 
 def test_solve_out():
@@ -439,6 +455,139 @@ def test_solve_out():
     assert math.isclose(I_cm[2,2], 7.0 / 6.0)
 
 
+def test_solve_cfg():
+    cfg = cfg_t(
+        obj_lst=(
+            cfg_t.obj_t(
+                r_bar=numpy.ctypeslib.as_ctypes(
+                    numpy.array([1.0, 0.0, 0.0])
+                ),
+                q=numpy.ctypeslib.as_ctypes(quat.one()),
+            ),
+            cfg_t.obj_t(
+                r_bar=numpy.ctypeslib.as_ctypes(
+                    numpy.array([0.0, 1.0, 0.0])
+                ),
+                q=numpy.ctypeslib.as_ctypes(quat.one()),
+            ),
+        ),
+    )
+    st = st_t(
+        sys=st_t.sys_t(
+            q=numpy.ctypeslib.as_ctypes(quat.one()),
+        ),
+        obj_lst=(
+            st_t.obj_t(
+                m=1.0,
+                I_cm=numpy.ctypeslib.as_ctypes(
+                    numpy.array([1.0 / 12.0, 1.0 / 12.0, 1.0 / 12.0])
+                ),
+            ),
+            st_t.obj_t(
+                m=1.0,
+                I_cm=numpy.ctypeslib.as_ctypes(
+                    numpy.array([1.0 / 12.0, 1.0 / 12.0, 1.0 / 12.0])
+                ),
+            ),
+        ),
+    )
+    out = out_t()
+    assert solve_cfg(2, cfg)
+    assert not solve_cfg(2, cfg)
+    assert cfg.drv.size == 2
+    solve_out(2, cfg, st, out)
+    m = out.sys.m
+    c_bar = numpy.ctypeslib.as_array(out.sys.c_bar)
+    I_cm = numpy.ctypeslib.as_array(out.sys.I_cm)
+    assert m == 2.0
+    assert c_bar[0] == 0.5
+    assert c_bar[1] == 0.5
+    assert c_bar[2] == 0.0
+    assert math.isclose(I_cm[0,0], 2.0 / 3.0)
+    assert I_cm[0,1] == 0.5
+    assert I_cm[0,2] == 0.0
+    assert I_cm[1,0] == 0.5
+    assert math.isclose(I_cm[1,1], 2.0 / 3.0)
+    assert I_cm[1,2] == 0.0
+    assert I_cm[2,0] == 0.0
+    assert I_cm[2,1] == 0.0
+    assert math.isclose(I_cm[2,2], 7.0 / 6.0)
+    cfg.obj_lst[1].q = numpy.ctypeslib.as_ctypes(vec.exp(numpy.array([0.0, 0.0, 0.1])))
+    # stale derived configuration is not used
+    assert not match_cfg(2, cfg)
+    solve_out(2, cfg, st, out)
+    ref = out_t()
+    cfg_ref = cfg_t.from_buffer_copy(cfg)
+    cfg_ref.drv.size = 0
+    solve_out(2, cfg_ref, st, ref)
+    assert numpy.array_equal(out.sys.I_cm, ref.sys.I_cm)
+    assert solve_cfg(2, cfg)
+    assert match_cfg(2, cfg)
+    R = numpy.ctypeslib.as_array(cfg.drv.obj_lst[1].R)
+    assert numpy.allclose(R, quat.rot_mat(numpy.ctypeslib.as_array(cfg.obj_lst[1].q)))
+
+
+def test_solve_out_delta():
+    cfg = cfg_t(
+        obj_lst=(
+            cfg_t.obj_t(
+                r_bar=numpy.ctypeslib.as_ctypes(
+                    numpy.array([1.0, 0.0, 0.0])
+                ),
+                q=numpy.ctypeslib.as_ctypes(quat.one()),
+            ),
+            cfg_t.obj_t(
+                r_bar=numpy.ctypeslib.as_ctypes(
+                    numpy.array([0.0, 1.0, 0.0])
+                ),
+                q=numpy.ctypeslib.as_ctypes(quat.one()),
+            ),
+        ),
+    )
+    st = st_t(
+        sys=st_t.sys_t(
+            q=numpy.ctypeslib.as_ctypes(quat.one()),
+        ),
+        obj_lst=(
+            st_t.obj_t(
+                m=1.0,
+                I_cm=numpy.ctypeslib.as_ctypes(
+                    numpy.array([1.0 / 12.0, 1.0 / 12.0, 1.0 / 12.0])
+                ),
+            ),
+            st_t.obj_t(
+                m=1.0,
+                I_cm=numpy.ctypeslib.as_ctypes(
+                    numpy.array([1.0 / 12.0, 1.0 / 12.0, 1.0 / 12.0])
+                ),
+            ),
+        ),
+    )
+    out = out_t()
+    solve_cfg(2, cfg)
+    solve_out(2, cfg, st, out)
+    assert out.acc.n == 0
+    assert out.sys.chol
+    st.obj_lst[1].m = 0.5
+    st.obj_lst[1].I_cm = numpy.ctypeslib.as_ctypes(
+        numpy.array([1.0 / 24.0, 1.0 / 24.0, 1.0 / 24.0])
+    )
+    solve_out(2, cfg, st, out)
+    assert out.acc.n == 1
+    ref = out_t()
+    cfg.drv.size = 0
+    solve_out(2, cfg, st, ref)
+    assert math.isclose(out.sys.m, ref.sys.m)
+    assert numpy.allclose(
+        numpy.ctypeslib.as_array(out.sys.c_bar),
+        numpy.ctypeslib.as_array(ref.sys.c_bar),
+    )
+    assert numpy.allclose(
+        numpy.ctypeslib.as_array(out.sys.I_cm),
+        numpy.ctypeslib.as_array(ref.sys.I_cm),
+    )
+
+
 def test_solve_em():
     cfg = cfg_t(
         obj_lst=(
@@ -484,3 +633,91 @@ def test_solve_em():
     assert m_bar[1] == 0.0
     assert m_bar[2] == 1.0
 
+
+@pytest.mark.parametrize("fun_lst,jac_lst,r_bar,col_lst", (
+    ((libgee.gee_fast,), (libgee.gee_fast_jac,), [6578e3, 1e5, 3e5], range(12)),
+    ((libgee.stdatm,), (libgee.stdatm_jac,), [6500e3, 1e5, 3e5], range(12)),
+    # field gradients are neglected
+    ((libgee.geomag, libcore.em), (None, libcore.em_jac), [6578e3, 1e5, 3e5], range(3, 12)),
+))
+def test_jacobian_force_model(fun_lst, jac_lst, r_bar, col_lst):
+    size = 2
+    cfg = cfg_t(clk=cfg_t.clk_t(delta_t=1.0))
+    for idx in range(size):
+        cfg.obj_lst[idx].q = numpy.ctypeslib.as_ctypes(
+            quat.unit(numpy.array([1.0, 0.1 * idx, 0.2, -0.1]))
+        )
+        cfg.obj_lst[idx].r_bar = numpy.ctypeslib.as_ctypes(
+            numpy.array([0.5 + idx, -0.3, 0.2 * idx])
+        )
+        cfg.obj_lst[idx].bbox = numpy.ctypeslib.as_ctypes(
+            numpy.array([1.0, 2.0 + idx, 0.5])
+        )
+    solve_cfg(size, cfg)
+    prev = st_t(clk=st_t.clk_t(t=0.0))
+    next = st_t(clk=st_t.clk_t(t=1.0))
+    for st in (prev, next):
+        for idx in range(size):
+            st.obj_lst[idx].m = 10.0 + idx
+            st.obj_lst[idx].I_cm = numpy.ctypeslib.as_ctypes(
+                numpy.array([1.0, 2.0, 3.0]) * (1 + idx)
+            )
+    st = st_t()
+    in_ = in_t()
+    out = out_t()
+    em = em_t()
+    em.obj_lst[0].q = 1e-3
+    em.obj_lst[0].p_bar = numpy.ctypeslib.as_ctypes(numpy.array([1.0, 2.0, 3.0]))
+    em.obj_lst[1].m_bar = numpy.ctypeslib.as_ctypes(numpy.array([1e3, -2e3, 3e3]))
+    solve_em(size, cfg, em)
+    force_model = force_model_t(len(fun_lst))
+    for idx in range(len(fun_lst)):
+        force_model.fun_lst[idx] = ctypes.cast(fun_lst[idx], ctypes.c_void_p)
+        if jac_lst[idx] is not None:
+            force_model.jac_lst[idx] = ctypes.cast(jac_lst[idx], ctypes.c_void_p)
+    ivp = ode.ivp_t(
+        size, ctypes.pointer(cfg),
+        ctypes.pointer(prev), ctypes.pointer(next), ctypes.pointer(st),
+        ctypes.pointer(in_), ctypes.pointer(out), ctypes.pointer(em),
+        ctypes.cast(ctypes.pointer(force_model), ctypes.c_void_p),
+    )
+    y = st_t.sys_t(
+        r_bar=numpy.ctypeslib.as_ctypes(numpy.array(r_bar)),
+        q=numpy.ctypeslib.as_ctypes(quat.unit(numpy.array([0.9, 0.2, -0.3, 0.1]))),
+        v_bar=numpy.ctypeslib.as_ctypes(numpy.array([100.0, 7.5e3, -900.0])),
+        om_bar=numpy.ctypeslib.as_ctypes(numpy.array([0.1, -0.2, 0.3])),
+    )
+    J = (ctypes.c_double * 144)()
+    k = st_t.sys_t()
+    libcore.jacobian_force_model(
+        ctypes.c_double(0.5), ctypes.byref(y), ctypes.byref(k), J, ctypes.byref(ivp)
+    )
+    J = numpy.array(J).reshape((12, 12))
+
+    def apply(j, h):
+        # tangent space step (r_bar, th, v_bar, om_bar)
+        x = st_t.sys_t()
+        ctypes.memmove(ctypes.byref(x), ctypes.byref(y), ctypes.sizeof(y))
+        delta = numpy.zeros((3,))
+        delta[j % 3] = h
+        if j < 3:
+            x.r_bar = numpy.ctypeslib.as_ctypes(numpy.array(y.r_bar) + delta)
+        elif j < 6:
+            x.q = numpy.ctypeslib.as_ctypes(quat.mul(numpy.array(y.q), vec.exp(delta)))
+        elif j < 9:
+            x.v_bar = numpy.ctypeslib.as_ctypes(numpy.array(y.v_bar) + delta)
+        else:
+            x.om_bar = numpy.ctypeslib.as_ctypes(numpy.array(y.om_bar) + delta)
+        f = st_t.sys_t()
+        libcore.apply_force_model(
+            ctypes.c_double(0.5), ctypes.byref(x), ctypes.byref(f), ctypes.byref(ivp)
+        )
+        return numpy.concatenate((f.v_bar, f.om_bar))
+
+    # the derivative comes with the Jacobian
+    assert numpy.array_equal(numpy.concatenate((k.v_bar, k.om_bar)), apply(0, 0.0))
+    for j in col_lst:
+        h = (1.0, 1e-5, 1e-2, 1e-4)[j // 3]
+        D = (apply(j, h) - apply(j, -h)) / (2.0 * h)
+        print(j, J[6:, j], D)
+        assert numpy.allclose(J[6:, j], D, rtol=0.0, atol=1e-2 * numpy.abs(D).max() + 1e-15)
@@ -1,4 +1,5 @@
 # built-in libraries
+import ctypes
 import math
 
 # external libraries
@@ -11,6 +12,8 @@ import pytest
 from epicycle import vec
 from epicycle import quat
 from epicycle import gee
+from epicycle import geopot
+from epicycle import libgee
 from epicycle.vehicle_model import *
 
 
@@ -335,3 +338,102 @@ def test_geoall_pole():
     # assert math.isclose(H / 24377.2e-9, 1.0, rel_tol=1e-2)
     # assert math.isclose(F / 55348.7e-9, 1.0, rel_tol=1e-2)
 
+
+
+def test_geoall_env():
+    st = st_t(
+        clk=st_t.clk_t(t=1.0e9),
+        sys=st_t.sys_t(
+            r_bar=numpy.ctypeslib.as_ctypes(
+                numpy.array([4.0e6, -3.0e6, 5.0e6])
+            ),
+            q=numpy.ctypeslib.as_ctypes(quat.unit(numpy.array([0.9, 0.2, -0.3, 0.1]))),
+        ),
+    )
+    out = out_t(
+        sys=out_t.sys_t(
+            m=10.0,
+            c_bar=numpy.ctypeslib.as_ctypes(numpy.array([0.5, -0.2, 0.1])),
+        ),
+    )
+    in_, em = in_t(), em_t()
+    gee.geoall(st, in_, out, em)
+    assert in_.env.flags != 0
+    # the separate models share the environment
+    foo, bar = in_t(), em_t()
+    geopot.geopot(st, foo, out)
+    flags = foo.env.flags
+    libgee.geomag(0, None, ctypes.byref(st), ctypes.byref(foo), ctypes.byref(out), ctypes.byref(bar))
+    assert foo.env.flags == flags
+    assert numpy.allclose(foo.sys.F_bar, in_.sys.F_bar, rtol=1e-12, atol=0.0)
+    assert numpy.allclose(foo.sys.M_bar, in_.sys.M_bar, rtol=1e-12, atol=0.0)
+    assert numpy.allclose(bar.sys.B_bar, em.sys.B_bar, rtol=1e-12, atol=0.0)
+    # a new state is picked up without clearing the environment
+    for field, value in (
+        ("t", 1.0e9 + 60.0),
+        ("r_bar", numpy.array([4.0e6, -3.0e6, 5.1e6])),
+        ("c_bar", numpy.array([0.5, -0.2, 0.2])),
+    ):
+        if field == "t":
+            st.clk.t = value
+        elif field == "r_bar":
+            st.sys.r_bar = numpy.ctypeslib.as_ctypes(value)
+        else:
+            out.sys.c_bar = numpy.ctypeslib.as_ctypes(value)
+        foo, bar = in_t(), em_t()
+        gee.geoall(st, foo, out, bar)
+        F_bar = numpy.ctypeslib.as_array(in_.sys.F_bar).copy()
+        in_.sys.F_bar = numpy.ctypeslib.as_ctypes(numpy.zeros((3,)))
+        gee.geoall(st, in_, out, em)
+        assert not numpy.array_equal(in_.sys.F_bar, F_bar)
+        assert numpy.array_equal(in_.sys.F_bar, foo.sys.F_bar)
+
+
+@pytest.mark.parametrize("alt_lst", (
+    numpy.linspace(-6000e3, -1000e3, 6),
+    numpy.linspace(-100e3, 0.0, 11),
+    numpy.linspace(0.0, 40000e3, 41),
+))
+def test_gee_f2d(alt_lst):
+    f = 1.0 / gee.G_INVF
+    e__2 = (2.0 - f) * f
+    r_lst, ref_lst = [], []
+    for lat in numpy.radians(numpy.linspace(-90.0, 90.0, 37)):
+        lon = 0.3 + lat
+        N = gee.G_RMAX / math.sqrt(1.0 - e__2 * math.sin(lat) ** 2)
+        for alt in alt_lst:
+            r_lst.append([
+                (N + alt) * math.cos(lat) * math.cos(lon),
+                (N + alt) * math.cos(lat) * math.sin(lon),
+                (N * (1.0 - e__2) + alt) * math.sin(lat),
+            ])
+            ref_lst.append([lat, lon, alt])
+    r_lst = numpy.array(r_lst)
+    lat, lon, alt = gee.f2d_n(r_lst)
+    for idx, (foo, bar, fizz) in enumerate(ref_lst):
+        assert math.isclose(lat[idx], foo, abs_tol=1e-14)
+        if abs(foo) < math.radians(89.0):
+            assert math.isclose(lon[idx], bar, abs_tol=1e-14)
+        assert math.isclose(alt[idx], fizz, abs_tol=1e-6)
+        assert gee.f2d(r_lst[idx]) == (lat[idx], lon[idx], alt[idx])
+    with pytest.raises(ZeroDivisionError):
+        gee.f2d(numpy.zeros((3,)))
+
+
+def test_gee_quat_i2f():
+    # cached rotations, revisited in another order (and colliding)
+    libgee.gee_quat_i2f.argtypes = [p_st_t, ctypes.c_void_p]
+    t_lst = [86400.0 * k / 7.0 for k in range(64)]
+    q_lst = {}
+    for t in t_lst + t_lst[::-1] + t_lst[::3]:
+        q = numpy.zeros((4,))
+        libgee.gee_quat_i2f(ctypes.byref(st_t(clk=st_t.clk_t(t=t))), q.ctypes.data)
+        JD = t / 86400 + 2440587.5
+        J0 = math.floor(JD + 0.5) - 0.5
+        T0 = (J0 - 2451545) / 36525
+        th_G = (
+            100.4606184 + T0 * (36000.77004 + T0 * (0.000387933 - T0 * 2.583e-8))
+            + 360.98564724 * (JD - J0)
+        )
+        assert numpy.allclose(q, vec.exp(numpy.array([0.0, 0.0, 0.5 * math.radians(th_G)])))
+        assert (q == q_lst.setdefault(t, q)).all()
@@ -5,6 +5,7 @@ import math
 import numpy
 import numpy.ctypeslib
 import scipy.linalg
+import pytest
 
 # internal libraries
 from epicycle import quat
@@ -145,3 +146,117 @@ def test_geopot_pole():
     # assert math.isclose(F_bar[1], G_bar[1], rel_tol=1.22e-4)
     # assert math.isclose(F_bar[2], G_bar[2], rel_tol=1.22e-4)
 
+
+def test_geopot_grad():
+    r_bar = numpy.array([
+        math.cos(math.radians(30.0)) ** 2,
+        math.sin(math.radians(60.0)) / 2,
+        math.sin(math.radians(30.0))
+    ]) * 7.0e6
+    G = geopot.grad(1.0, r_bar)
+    print(G)
+    # symmetric and traceless (the potential is harmonic)
+    assert numpy.allclose(G, G.T, rtol=0.0, atol=1e-12 * scipy.linalg.norm(G))
+    assert math.isclose(numpy.trace(G), 0.0, abs_tol=1e-9 * scipy.linalg.norm(G))
+    D = numpy.empty((3, 3))
+    for j in range(3):
+        delta = numpy.zeros((3,))
+        delta[j] = 10.0
+        D[:, j] = (geopot.eval(1.0, r_bar + delta) - geopot.eval(1.0, r_bar - delta)) / 20.0
+    print(D)
+    assert math.isclose(scipy.linalg.norm(G - D) / scipy.linalg.norm(G), 0.0, abs_tol=5e-2)
+
+
+def __egm_potential(CS, deg, r_bar, mu=gee.G_MU, R=gee.G_RMAX):
+    # reference potential, forward column recursion of the normalized
+    # functions (explicit cos(phi)^m and trigonometric functions)
+    x, y, z = r_bar
+    r = scipy.linalg.norm(r_bar)
+    t, u, la = z / r, math.hypot(x, y) / r, math.atan2(y, x)
+    P = numpy.zeros((deg + 1, deg + 1))
+    P[0, 0] = 1.0
+    for m in range(1, deg + 1):
+        P[m, m] = P[m-1, m-1] * u * math.sqrt((2 * m + 1) / (2 * m if m > 1 else 1))
+    for m in range(deg + 1):
+        for n in range(m + 1, deg + 1):
+            P[n, m] = math.sqrt((2 * n - 1) * (2 * n + 1) / ((n - m) * (n + m))) * t * P[n-1, m]
+            if n > m + 1:
+                P[n, m] -= math.sqrt(
+                    (2 * n + 1) * (n + m - 1) * (n - m - 1)
+                    / ((n - m) * (n + m) * (2 * n - 3))
+                ) * P[n-2, m]
+    return mu / r * sum(
+        (R / r) ** n * P[n, m] * (C * math.cos(m * la) + S * math.sin(m * la))
+        for (n, m), (C, S) in CS.items() if 2 <= n <= deg
+    )
+
+
+def test_geopot_egm(tmp_path):
+    # random coefficients (Kaula's rule), ICGEM rows with Fortran exponents
+    rng = numpy.random.default_rng(0)
+    CS = {}
+    with open(tmp_path / "egm.gfc", "w") as f:
+        f.write("earth_gravity_constant %.9e\nradius %.1f\nend_of_head\n" % (gee.G_MU, gee.G_RMAX))
+        for n in range(61):
+            for m in range(n + 1):
+                C, S = rng.normal(0.0, 1e-5 / max(n, 1) ** 2, 2)
+                CS[n, m] = (C, S if m > 0 else 0.0)
+                f.write("gfc %d %d %s %s 0.0 0.0\n" % (
+                    n, m, ("%.15e" % C).replace("e", "D"), "%.15e" % CS[n, m][1]
+                ))
+    geopot.load(tmp_path / "egm.gfc", 60, 60)
+    for r_bar in ([3e6, 4e6, 5e6], [1.0, 200.0, 6.9e6], [2e4, -1e4, -6.8e6]):
+        r_bar = numpy.array(r_bar)
+        D = numpy.empty((3,))
+        for j in range(3):
+            delta = numpy.zeros((3,))
+            delta[j] = 1.0
+            D[j] = (__egm_potential(CS, 60, r_bar + delta) - __egm_potential(CS, 60, r_bar - delta)) / 2.0
+        F_bar = geopot.egm_eval(1.0, r_bar)
+        print(F_bar, D)
+        assert scipy.linalg.norm(F_bar - D) < 1e-6 * scipy.linalg.norm(D)
+    # regular at the poles
+    for z in (7e6, -7e6):
+        F_bar = geopot.egm_eval(1.0, numpy.array([0.0, 0.0, z]))
+        G_bar = geopot.egm_eval(1.0, numpy.array([1e-3, 0.0, z]))
+        assert scipy.linalg.norm(F_bar - G_bar) < 1e-9 * scipy.linalg.norm(F_bar)
+    # truncation
+    r_bar = numpy.array([3e6, 4e6, 5e6])
+    geopot.trunc(20, 10)
+    F_bar = geopot.egm_eval(1.0, r_bar)
+    geopot.load(tmp_path / "egm.gfc", 20, 10)
+    assert numpy.array_equal(F_bar, geopot.egm_eval(1.0, r_bar))
+    with pytest.raises(ValueError):
+        geopot.trunc(30, 10)
+    with pytest.raises(OSError):
+        geopot.load(tmp_path / "egm.gfc", geopot.G_NMAX + 1, 0)
+
+
+def test_geopot_egm_head(tmp_path):
+    # ICGEM header with a non-default radius and gravity constant, both with
+    # Fortran exponents
+    mu, R = 1.1 * gee.G_MU, 1.05 * gee.G_RMAX
+    CS = {(2, 0): (-0.484e-3, 0.0), (2, 2): (2.4e-6, -1.4e-6), (3, 1): (2.0e-6, 2.5e-7)}
+    with open(tmp_path / "egm.gfc", "w") as f:
+        f.write("modelname test\n")
+        f.write("earth_gravity_constant %s\n" % ("%.15e" % mu).replace("e", "D"))
+        f.write("radius  %s\n" % ("%.15e" % R).replace("e", "d"))
+        f.write("end_of_head\n")
+        for (n, m), (C, S) in CS.items():
+            f.write("gfc %d %d %s %s\n" % (n, m, ("%.15e" % C).replace("e", "D"), "%.15e" % S))
+    geopot.load(tmp_path / "egm.gfc", 3, 3)
+    r_bar = numpy.array([3e6, 4e6, 5e6])
+    D = numpy.empty((3,))
+    for j in range(3):
+        delta = numpy.zeros((3,))
+        delta[j] = 1.0
+        D[j] = (
+            __egm_potential(CS, 3, r_bar + delta, mu, R)
+            - __egm_potential(CS, 3, r_bar - delta, mu, R)
+        ) / 2.0
+    F_bar = geopot.egm_eval(1.0, r_bar)
+    assert scipy.linalg.norm(F_bar - D) < 1e-6 * scipy.linalg.norm(D)
+    # gradient, symmetric and traceless
+    G = geopot.egm_grad(1.0, r_bar)
+    assert numpy.allclose(G, G.T, rtol=0.0, atol=1e-6 * scipy.linalg.norm(G))
+    assert math.isclose(numpy.trace(G), 0.0, abs_tol=1e-6 * scipy.linalg.norm(G))
@@ -119,6 +119,107 @@ def test_solve_ivp():
     assert math.isclose(om_bar[2], math.pi / 1.5 / math.sqrt(3.0))
 
 
+def test_solve_ivp_ctx():
+    cfg = cfg_t(
+        clk=cfg_t.clk_t(delta_t=1.0),
+        obj_lst=(
+            cfg_t.obj_t(
+                q=numpy.ctypeslib.as_ctypes(quat.one()),
+            ),
+        ),
+    )
+    prev = st_t(
+        clk=st_t.clk_t(t=0.0),
+        sys=st_t.sys_t(
+            r_bar=numpy.ctypeslib.as_ctypes(
+                numpy.array([7000.0e3, 0.0, 0.0])
+            ),
+            q=numpy.ctypeslib.as_ctypes(quat.one()),
+            v_bar=numpy.ctypeslib.as_ctypes(
+                numpy.array([0.0, 7.0e3, 0.0])
+            ),
+            om_bar=numpy.ctypeslib.as_ctypes(numpy.zeros((3))),
+        ),
+        obj_lst=(
+            st_t.obj_t(
+                m=1.0,
+                I_cm=numpy.ctypeslib.as_ctypes(
+                    numpy.array([1.0 / 12.0, 1.0 / 12.0, 1.0 / 12.0])
+                ),
+            ),
+        ),
+    )
+    next = st_t(
+        clk=st_t.clk_t(t=1.0),
+        sys=st_t.sys_t(
+            r_bar=numpy.ctypeslib.as_ctypes(
+                numpy.array([7000.0e3, 7.0e3, 0.0])
+            ),
+            q=numpy.ctypeslib.as_ctypes(quat.one()),
+            v_bar=numpy.ctypeslib.as_ctypes(
+                numpy.array([0.0, 7.0e3, 0.0])
+            ),
+            om_bar=numpy.ctypeslib.as_ctypes(numpy.zeros((3))),
+        ),
+        obj_lst=(
+            st_t.obj_t(
+                m=1.0,
+                I_cm=numpy.ctypeslib.as_ctypes(
+                    numpy.array([1.0 / 12.0, 1.0 / 12.0, 1.0 / 12.0])
+                ),
+            ),
+        ),
+    )
+    st = st_t()
+    in_ = in_t(
+        obj_lst=(
+            in_t.obj_t(
+                M_bar=numpy.ctypeslib.as_ctypes(
+                    numpy.array([1.0, 1.0, 1.0]) * math.pi / 18.0 / math.sqrt(3.0)
+                ),
+            ),
+        )
+    )
+    out = out_t()
+    em = em_t()
+    force_model = force_model_t(1, fun_lst=(
+        ctypes.cast(libgee.gee_fast, ctypes.c_void_p),
+    ))
+    ivp = ode.ivp_t(
+        1, ctypes.pointer(cfg),
+        ctypes.pointer(prev), ctypes.pointer(next), ctypes.pointer(st),
+        ctypes.pointer(in_), ctypes.pointer(out), ctypes.pointer(em),
+        ctypes.cast(ctypes.pointer(force_model), ctypes.c_void_p),
+    )
+    ode.solve_ivp_ctx(
+        prev.clk.t, numpy.frombuffer(prev.sys),
+        next.clk.t, numpy.frombuffer(next.sys),
+        None, libcore.apply_force_model, None,
+        ivp,
+    )
+    r_bar = numpy.ctypeslib.as_array(next.sys.r_bar)
+    q = numpy.ctypeslib.as_array(next.sys.q)
+    v_bar = numpy.ctypeslib.as_array(next.sys.v_bar)
+    om_bar = numpy.ctypeslib.as_array(next.sys.om_bar)
+    print(r_bar)
+    print(q)
+    print(v_bar)
+    print(om_bar)
+    assert math.isclose(r_bar[0], 7000.0e3 - 0.5 * G_MU / 7000.0e3 ** 2, rel_tol=1.22e-4)
+    assert math.isclose(r_bar[1], 7.0e3, rel_tol=1.22e-4)
+    assert math.isclose(r_bar[2], 0.0, abs_tol=1.48e-8)
+    assert math.isclose(q[0], 0.5 * math.sqrt(3.0), rel_tol=1.22e-4)
+    assert math.isclose(q[1], 0.5 / math.sqrt(3.0), rel_tol=1.22e-4)
+    assert math.isclose(q[2], 0.5 / math.sqrt(3.0), rel_tol=1.22e-4)
+    assert math.isclose(q[3], 0.5 / math.sqrt(3.0), rel_tol=1.22e-4)
+    assert math.isclose(v_bar[0], - G_MU / 7000.0e3 ** 2, rel_tol=1.22e-4)
+    assert math.isclose(v_bar[1], 7.0e3, rel_tol=1.22e-4)
+    assert math.isclose(v_bar[2], 0.0, abs_tol=1.48e-8)
+    assert math.isclose(om_bar[0], math.pi / 1.5 / math.sqrt(3.0))
+    assert math.isclose(om_bar[1], math.pi / 1.5 / math.sqrt(3.0))
+    assert math.isclose(om_bar[2], math.pi / 1.5 / math.sqrt(3.0))
+
+
 @pytest.mark.parametrize("method", (
     pytest.param(ode.solve_ivp_with_euler, marks=mark_ode_euler),
     # ode.solve_ivp_with_verlet,
@@ -234,10 +335,12 @@ def test_solve_ivp_with_bad(method):
     # ode.solve_ivp_with_rk4,
     # ode.solve_ivp_with_heuler,
     ode.solve_ivp_with_dopri,
+    ode.solve_ivp_with_dop853,
     # ode.solve_ivp_with_beuler,
     ode.solve_ivp_with_midp,
     ode.solve_ivp_with_vgl4,
     ode.solve_ivp_with_vgl6,
+    ode.solve_ivp_with_abm,
 ))
 def test_solve_ivp_with_good(method):
     cfg = cfg_t(
@@ -305,15 +408,37 @@ def test_solve_ivp_with_good(method):
     force_model = force_model_t(1, fun_lst=(
         ctypes.cast(libgee.gee_fast, ctypes.c_void_p),
     ))
-    method(
-        prev.clk.t, numpy.frombuffer(prev.sys),
-        next.clk.t, numpy.frombuffer(next.sys),
-        libcore.apply_force_model,
-        9, ctypes.c_size_t(1), ctypes.byref(cfg),
-        ctypes.byref(prev), ctypes.byref(next), ctypes.byref(st),
-        ctypes.byref(in_), ctypes.byref(out), ctypes.byref(em),
-        ctypes.byref(force_model),
-    )
+    if method is ode.solve_ivp_with_abm:
+        # needs a history (`solve_ivp_ctx`)
+        fsal, stats, multi = ode.ode_fsal_t(), ode.ode_stats_t(), ode.ode_multi_t()
+        ivp = ode.ivp_t(
+            1, ctypes.pointer(cfg),
+            ctypes.pointer(prev), ctypes.pointer(next), ctypes.pointer(st),
+            ctypes.pointer(in_), ctypes.pointer(out), ctypes.pointer(em),
+            ctypes.cast(ctypes.pointer(force_model), ctypes.c_void_p),
+            fsal=ctypes.pointer(fsal),
+            stats=ctypes.pointer(stats),
+            multi=ctypes.pointer(multi),
+        )
+        N = 2 * ode.ODE_MULTI_SIZE
+        assert method(
+            prev.clk.t, numpy.frombuffer(prev.sys),
+            next.clk.t, numpy.frombuffer(next.sys),
+            libcore.apply_force_model, ivp, N,
+        )
+        # start up with `rk4`, then Adams-Bashforth-Moulton steps
+        assert multi.size == ode.ODE_MULTI_SIZE
+        assert stats.n_fun == 4 * (ode.ODE_MULTI_SIZE - 1) + 2 * (N - ode.ODE_MULTI_SIZE + 1)
+    else:
+        method(
+            prev.clk.t, numpy.frombuffer(prev.sys),
+            next.clk.t, numpy.frombuffer(next.sys),
+            libcore.apply_force_model,
+            9, ctypes.c_size_t(1), ctypes.byref(cfg),
+            ctypes.byref(prev), ctypes.byref(next), ctypes.byref(st),
+            ctypes.byref(in_), ctypes.byref(out), ctypes.byref(em),
+            ctypes.byref(force_model),
+        )
     r_bar = numpy.ctypeslib.as_array(next.sys.r_bar)
     q = numpy.ctypeslib.as_array(next.sys.q)
     v_bar = numpy.ctypeslib.as_array(next.sys.v_bar)
@@ -336,3 +461,211 @@ def test_solve_ivp_with_good(method):
     assert math.isclose(om_bar[1], math.pi / 1.5 / math.sqrt(3.0))
     assert math.isclose(om_bar[2], math.pi / 1.5 / math.sqrt(3.0))
 
+
+@pytest.mark.parametrize("method", ("_ode_dopri", "_ode_vgl6"))
+def test_solve_ivp_dense(method):
+    def state(t):
+        return st_t(
+            clk=st_t.clk_t(t=t),
+            sys=st_t.sys_t(
+                r_bar=numpy.ctypeslib.as_ctypes(
+                    numpy.array([7000.0e3, 0.0, 0.0])
+                ),
+                q=numpy.ctypeslib.as_ctypes(quat.one()),
+                v_bar=numpy.ctypeslib.as_ctypes(
+                    numpy.array([0.0, 7.5e3, 0.0])
+                ),
+                om_bar=numpy.ctypeslib.as_ctypes(
+                    numpy.array([0.0, 0.0, 1.0e-3])
+                ),
+            ),
+            obj_lst=(
+                st_t.obj_t(
+                    m=1.0,
+                    I_cm=numpy.ctypeslib.as_ctypes(
+                        numpy.array([1.0 / 12.0, 1.0 / 12.0, 1.0 / 12.0])
+                    ),
+                ),
+            ),
+        )
+    cfg = cfg_t(
+        clk=cfg_t.clk_t(delta_t=60.0),
+        obj_lst=(cfg_t.obj_t(q=numpy.ctypeslib.as_ctypes(quat.one())),),
+    )
+    prev, next, st = state(0.0), state(60.0), st_t()
+    in_, out, em = in_t(), out_t(), em_t()
+    dense = ode.ode_dense_t()
+    force_model = force_model_t(1, fun_lst=(
+        ctypes.cast(libgee.gee_fast, ctypes.c_void_p),
+    ))
+    ivp = ode.ivp_t(
+        1, ctypes.pointer(cfg),
+        ctypes.pointer(prev), ctypes.pointer(next), ctypes.pointer(st),
+        ctypes.pointer(in_), ctypes.pointer(out), ctypes.pointer(em),
+        ctypes.cast(ctypes.pointer(force_model), ctypes.c_void_p),
+        dense=ctypes.pointer(dense),
+    )
+    meth = ctypes.cast(getattr(libcore, method), ctypes.c_void_p)
+    step = ctypes.cast(libcore.adjust_time_step, ctypes.c_void_p)
+    y1 = numpy.frombuffer(next.sys).copy()
+    assert ode.solve_ivp_ctx(
+        0.0, numpy.frombuffer(prev.sys), 60.0, y1,
+        meth, libcore.apply_force_model, step, ivp,
+    )
+    assert dense.valid
+    with pytest.raises(ValueError):
+        ode.dense_eval(dense, 61.0)
+    # end points
+    y = numpy.frombuffer(ode.dense_eval(dense, 60.0))
+    assert numpy.allclose(y, y1, rtol=1e-12, atol=1e-9)
+    y = numpy.frombuffer(ode.dense_eval(dense, 0.0))
+    assert numpy.allclose(y, numpy.frombuffer(prev.sys), rtol=0.0, atol=0.0)
+    # interior point against a separate (shorter) step
+    dense_60 = ode.ode_dense_t.from_buffer_copy(dense)
+    y_mid = numpy.frombuffer(next.sys).copy()
+    assert ode.solve_ivp_ctx(
+        0.0, numpy.frombuffer(prev.sys), 20.0, y_mid,
+        meth, libcore.apply_force_model, step, ivp,
+    )
+    y = numpy.frombuffer(ode.dense_eval(dense_60, 20.0))
+    assert numpy.allclose(y[0:3], y_mid[0:3], rtol=0.0, atol=1e-1)
+    assert numpy.allclose(y[7:10], y_mid[7:10], rtol=0.0, atol=1e-2)
+
+
+def test_solve_ivp_abm():
+    def state(t):
+        return st_t(
+            clk=st_t.clk_t(t=t),
+            sys=st_t.sys_t(
+                r_bar=numpy.ctypeslib.as_ctypes(
+                    numpy.array([7000.0e3, 0.0, 0.0])
+                ),
+                q=numpy.ctypeslib.as_ctypes(quat.one()),
+                v_bar=numpy.ctypeslib.as_ctypes(
+                    numpy.array([0.0, 7.5e3, 0.0])
+                ),
+                om_bar=numpy.ctypeslib.as_ctypes(
+                    numpy.array([0.0, 0.0, 1.0e-3])
+                ),
+            ),
+            obj_lst=(
+                st_t.obj_t(
+                    m=1.0,
+                    I_cm=numpy.ctypeslib.as_ctypes(
+                        numpy.array([1.0 / 12.0, 1.0 / 12.0, 1.0 / 12.0])
+                    ),
+                ),
+            ),
+        )
+    cfg = cfg_t(
+        clk=cfg_t.clk_t(delta_t=10.0),
+        obj_lst=(cfg_t.obj_t(q=numpy.ctypeslib.as_ctypes(quat.one())),),
+    )
+    prev, next, st = state(0.0), state(300.0), st_t()
+    in_, out, em = in_t(), out_t(), em_t()
+    fsal, stats, multi = ode.ode_fsal_t(), ode.ode_stats_t(), ode.ode_multi_t()
+    force_model = force_model_t(1, fun_lst=(
+        ctypes.cast(libgee.gee_fast, ctypes.c_void_p),
+    ))
+    ivp = ode.ivp_t(
+        1, ctypes.pointer(cfg),
+        ctypes.pointer(prev), ctypes.pointer(next), ctypes.pointer(st),
+        ctypes.pointer(in_), ctypes.pointer(out), ctypes.pointer(em),
+        ctypes.cast(ctypes.pointer(force_model), ctypes.c_void_p),
+        fsal=ctypes.pointer(fsal),
+        stats=ctypes.pointer(stats),
+        multi=ctypes.pointer(multi),
+    )
+    def solve(meth, N, delta_x):
+        y0 = numpy.frombuffer(prev.sys).copy()
+        for n in range(N):
+            y1 = y0.copy()
+            assert ode.solve_ivp_ctx(
+                n * delta_x, y0, (n + 1) * delta_x, y1,
+                ctypes.cast(getattr(libcore, meth), ctypes.c_void_p),
+                libcore.apply_force_model, None, ivp,
+            )
+            y1[3:7] /= numpy.linalg.norm(y1[3:7])  # as `solve_vehicle_model`
+            y0 = y1
+        return y0
+    y_ref = solve("_ode_rk4", 300, 1.0)
+    fsal.valid, multi.size = False, 0
+    stats.n_fun = 0
+    y = solve("_ode_abm", 30, 10.0)
+    # start up with `rk4` (four evaluations), then two per step
+    assert multi.size == ode.ODE_MULTI_SIZE
+    assert stats.n_fun == 4 * (ode.ODE_MULTI_SIZE - 1) + 2 * (30 - ode.ODE_MULTI_SIZE + 1)
+    assert numpy.allclose(y[0:3], y_ref[0:3], rtol=0.0, atol=1e-2)
+    assert numpy.allclose(y[3:7], y_ref[3:7], rtol=0.0, atol=1e-9)
+    assert numpy.allclose(y[7:10], y_ref[7:10], rtol=0.0, atol=1e-4)
+
+
+def test_solve_ivp_newton_singular():
+    def state(t):
+        return st_t(
+            clk=st_t.clk_t(t=t),
+            sys=st_t.sys_t(
+                r_bar=numpy.ctypeslib.as_ctypes(
+                    numpy.array([7000.0e3, 0.0, 0.0])
+                ),
+                q=numpy.ctypeslib.as_ctypes(quat.one()),
+                v_bar=numpy.ctypeslib.as_ctypes(
+                    numpy.array([0.0, 7.5e3, 0.0])
+                ),
+                om_bar=numpy.ctypeslib.as_ctypes(numpy.zeros((3,))),
+            ),
+            obj_lst=(
+                st_t.obj_t(
+                    m=1.0,
+                    I_cm=numpy.ctypeslib.as_ctypes(
+                        numpy.array([1.0 / 12.0, 1.0 / 12.0, 1.0 / 12.0])
+                    ),
+                ),
+            ),
+        )
+    delta_x = 1.0
+    cfg = cfg_t(
+        clk=cfg_t.clk_t(delta_t=delta_x),
+        obj_lst=(cfg_t.obj_t(q=numpy.ctypeslib.as_ctypes(quat.one())),),
+    )
+    prev, next, st = state(0.0), state(delta_x), st_t()
+    in_, out, em = in_t(), out_t(), em_t()
+    stats = ode.ode_stats_t()
+    force_model = force_model_t(1, fun_lst=(
+        ctypes.cast(libgee.gee_fast, ctypes.c_void_p),
+    ))
+    # J = (2 / h) I makes the `midp` iteration matrix I - h / 2 J vanish
+    @ctypes.CFUNCTYPE(
+        None, ctypes.c_double, ctypes.c_void_p, ctypes.c_void_p,
+        ctypes.POINTER(ctypes.c_double), ctypes.c_void_p
+    )
+    def jac(x, y, k, J, ivp):
+        for i in range(ode.ODE_JAC_SIZE):
+            for j in range(ode.ODE_JAC_SIZE):
+                J[i * ode.ODE_JAC_SIZE + j] = 2.0 / delta_x if i == j else 0.0
+    ivp = ode.ivp_t(
+        1, ctypes.pointer(cfg),
+        ctypes.pointer(prev), ctypes.pointer(next), ctypes.pointer(st),
+        ctypes.pointer(in_), ctypes.pointer(out), ctypes.pointer(em),
+        ctypes.cast(ctypes.pointer(force_model), ctypes.c_void_p),
+        stats=ctypes.pointer(stats),
+        jac=ctypes.cast(jac, ctypes.c_void_p),
+    )
+    meth = ctypes.cast(libcore._ode_midp, ctypes.c_void_p)
+    y1 = numpy.frombuffer(next.sys).copy()
+    assert ode.solve_ivp_ctx(
+        0.0, numpy.frombuffer(prev.sys), delta_x, y1,
+        meth, libcore.apply_force_model, None, ivp,
+    )
+    assert stats.n_jac == 1
+    assert stats.n_fallback == 1
+    # as the fixed point iteration
+    ivp.jac = None
+    y_ref = numpy.frombuffer(next.sys).copy()
+    assert ode.solve_ivp_ctx(
+        0.0, numpy.frombuffer(prev.sys), delta_x, y_ref,
+        meth, libcore.apply_force_model, None, ivp,
+    )
+    assert stats.n_fallback == 1
+    assert not numpy.array_equal(y1[0:3], numpy.frombuffer(prev.sys)[0:3])
+    assert numpy.array_equal(y1, y_ref)
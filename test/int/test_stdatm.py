@@ -11,6 +11,7 @@ from epicycle import quat
 from epicycle import gee
 from epicycle import stdatm
 from epicycle.vehicle_model import *
+from epicycle.force_model import solve_cfg
 
 
 def test_stdatm():
@@ -43,3 +44,85 @@ def test_stdatm():
     assert math.isclose(F_bar[1], 0.0)
     assert math.isclose(F_bar[2], 0.0)
 
+
+
+def test_stdatm_drag():
+    size = 3
+    cfg = cfg_t()
+    for idx in range(size):
+        cfg.obj_lst[idx].q = numpy.ctypeslib.as_ctypes(
+            quat.unit(numpy.array([1.0, 0.3 * idx, -0.2, 0.1 * idx]))
+        )
+        cfg.obj_lst[idx].r_bar = numpy.ctypeslib.as_ctypes(
+            numpy.array([1.0 + idx, -0.5 * idx, 0.2])
+        )
+        cfg.obj_lst[idx].bbox = numpy.ctypeslib.as_ctypes(
+            numpy.array([1.0, 2.0 + idx, 0.5])
+        )
+    st = st_t(
+        sys=st_t.sys_t(
+            r_bar=numpy.ctypeslib.as_ctypes(
+                numpy.array([0.0, 0.0, gee.G_RMIN + 250e3])
+            ),
+            q=numpy.ctypeslib.as_ctypes(quat.unit(numpy.array([0.9, 0.2, -0.3, 0.1]))),
+            v_bar=numpy.ctypeslib.as_ctypes(
+                numpy.array([7.5e3, 100.0, -300.0])
+            ),
+        ),
+    )
+    # per-face reference (body frame)
+    atm = stdatm.eval(250e3)
+    q = numpy.ctypeslib.as_array(st.sys.q)
+    v_bar = numpy.ctypeslib.as_array(st.sys.v_bar)
+    u_bar = quat.rot_mat(q).T @ v_bar
+    F_ref, M_ref = numpy.zeros((3,)), numpy.zeros((3,))
+    for idx in range(size):
+        R = quat.rot_mat(numpy.ctypeslib.as_array(cfg.obj_lst[idx].q))
+        bbox = numpy.ctypeslib.as_array(cfg.obj_lst[idx].bbox)
+        for i in range(3):
+            A = bbox[(i+1)%3] * bbox[(i+2)%3]
+            F = - atm.rho * numpy.linalg.norm(v_bar) * (u_bar @ R[:,i]) * A * R[:,i]
+            F_ref += F
+            M_ref += numpy.cross(numpy.ctypeslib.as_array(cfg.obj_lst[idx].r_bar), F)
+    F_ref = quat.rot_mat(q) @ F_ref
+    # without and with the derived configuration
+    for drv in (False, True):
+        if drv:
+            assert solve_cfg(size, cfg)
+        in_ = in_t()
+        stdatm.stdatm(size, cfg, st, in_)
+        assert numpy.allclose(in_.sys.F_bar, F_ref, rtol=1e-12, atol=0.0)
+        assert numpy.allclose(in_.sys.M_bar, M_ref, rtol=1e-12, atol=0.0)
+    # bounding box changes are picked up, with or without `solve_cfg`
+    cfg.obj_lst[0].bbox[1] = 0.0
+    in_ = in_t()
+    stdatm.stdatm(size, cfg, st, in_)
+    assert not numpy.allclose(in_.sys.F_bar, F_ref, rtol=1e-6, atol=0.0)
+    F_bar = numpy.ctypeslib.as_array(in_.sys.F_bar).copy()
+    assert solve_cfg(size, cfg)
+    in_ = in_t()
+    stdatm.stdatm(size, cfg, st, in_)
+    assert numpy.allclose(in_.sys.F_bar, F_bar, rtol=1e-12, atol=0.0)
+
+
+def test_stdatm_eval():
+    z_lst = numpy.linspace(-1e3, 1000e3, 10001)
+    for z in z_lst:
+        foo, bar = stdatm.model(z), stdatm.eval(z)
+        assert math.isclose(bar.th, foo.th, rel_tol=1e-4)
+        assert math.isclose(bar.p, foo.p, rel_tol=1e-7)
+        assert math.isclose(bar.rho, foo.rho, rel_tol=1e-7)
+        assert math.isclose(
+            bar.rho_z / bar.rho, foo.rho_z / foo.rho, abs_tol=1e-9
+        )
+    # batch (SIMD pairs and scalar), identical to single evaluations
+    for atm, z in zip(stdatm.eval_n(z_lst), z_lst):
+        foo = stdatm.eval(z)
+        assert (atm.th, atm.p, atm.rho, atm.rho_z) \
+            == (foo.th, foo.p, foo.rho, foo.rho_z)
+    try:
+        stdatm.eval_n([100e3, 1001e3, 0.0])
+    except OverflowError:
+        pass
+    else:
+        assert False
@@ -68,6 +68,27 @@ def test_mat_inv_bad():
         mat.inv(A)
 
 
+def test_mat_chol_good():
+    A = numpy.array([[4.0, 2.0, -2.0], [2.0, 10.0, 2.0], [-2.0, 2.0, 5.0]])
+    L = mat.chol(A)
+    assert L[0][0] == 4.0
+    assert L[1][0] == 0.5
+    assert L[2][0] == -0.5
+    assert L[1][1] == 9.0
+    assert L[2][1] == 1.0 / 3.0
+    assert L[2][2] == 3.0
+    assert L[0][1] == 0.0
+    u_bar = numpy.array([1.0, -2.0, 3.0])
+    v_bar = mat.chol_solve(L, u_bar)
+    assert v_bar == pytest.approx(numpy.linalg.solve(A, u_bar))
+
+
+def test_mat_chol_bad():
+    A = numpy.array([[1.0, 2.0, 0.0], [2.0, 1.0, 0.0], [0.0, 0.0, 1.0]])
+    with pytest.raises(ValueError):
+        mat.chol(A)
+
+
 def test_mat___T():
     A = numpy.array([[1.0, -2.0, 3.0], [-4.0, 5.0, -6.0], [7.0, -8.0, 9.0]])
     A__T = mat.T(A)
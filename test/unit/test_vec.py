@@ -6,7 +6,7 @@ import numpy
 import pytest
 
 # internal libraries
-from epicycle import vec
+from epicycle import vec, quat
 
 
 def test_vec_neg():
@@ -134,3 +134,22 @@ def test_vec_irot():
     assert v_bar[1] == 4.0
     assert v_bar[2] == 2.0
 
+
+def test_vec_rot_sandwich():
+    q = vec.exp(numpy.array([0.3, -0.2, 0.6]))
+    u_bar = numpy.array([2.0, -3.0, 4.0])
+    v_bar = vec.rot(q, u_bar)
+    p = quat.mul(q, quat.vmul(u_bar, quat.conj(q)))
+    assert numpy.allclose(v_bar, p[1:], rtol=0.0, atol=1e-14)
+    w_bar = vec.irot(q, v_bar)
+    assert numpy.allclose(w_bar, u_bar, rtol=0.0, atol=1e-14)
+
+
+def test_vec_rot_n():
+    q = vec.exp(numpy.array([0.3, -0.2, 0.6]))
+    u_bar = numpy.array([[2.0, -3.0, 4.0], [1.0, 0.0, 0.0], [-5.0, 6.0, 7.0]])
+    v_bar = vec.rot_n(q, u_bar)
+    w_bar = vec.irot_n(q, v_bar)
+    for i in range(len(u_bar)):
+        assert numpy.allclose(v_bar[i], vec.rot(q, u_bar[i]), rtol=0.0, atol=1e-14)
+        assert numpy.allclose(w_bar[i], u_bar[i], rtol=0.0, atol=1e-14)